@@ -0,0 +1,71 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// each thread counts its own allocations, so the audio, decoder, speech and
+// tracing threads allocating never shows up in a main-thread frame; it's
+// constant-initialized, so counting never allocates it
+thread_local size_t allocation_count = 0;
+
+/**
+ * Allocates memory the same way the default operator new does, counting the
+ * allocation.
+ * @param size the number of bytes to allocate.
+ * @return the allocated memory.
+ */
+void* CountedAllocate(size_t size) {
+  allocation_count++;
+  if (size == 0) {
+    size = 1;
+  }
+  while (true) {
+    void* memory = std::malloc(size);
+    if (memory != nullptr) {
+      return memory;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+}  // namespace
+
+namespace screamyball_app {
+
+size_t AllocationCount() {
+  return allocation_count;
+}
+
+}  // namespace screamyball_app
+
+void* operator new(size_t size) {
+  return CountedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+  return CountedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+  std::free(memory);
+}
@@ -0,0 +1,22 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_ALLOCATION_COUNTER_H_
+#define FINALPROJECT_APPS_ALLOCATION_COUNTER_H_
+
+#include <cstddef>
+
+namespace screamyball_app {
+
+/**
+ * Counts the calls to the global operator new made by the calling thread
+ * since it started. The app replaces operator new to keep this count, so a
+ * frame's allocations are the difference between the main thread's counts
+ * at its start and at its end, whatever the other threads allocate
+ * meanwhile.
+ * @return the number of allocations the thread has made so far.
+ */
+size_t AllocationCount();
+
+}  // namespace screamyball_app
+
+#endif  // FINALPROJECT_APPS_ALLOCATION_COUNTER_H_
@@ -0,0 +1,122 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include "frame_benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+namespace screamyball_app {
+
+/**
+ * Calculates a percentile of some sorted times, using the nearest-rank
+ * method.
+ * @param sorted the times, in ascending order.
+ * @param fraction the percentile, between 0 and 1.
+ * @return the time, in milliseconds.
+ */
+double PercentileMs(const std::vector<float>& sorted, double fraction) {
+  const double rank = std::ceil(fraction * static_cast<double>(sorted.size()));
+  const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(
+      std::max(1.0, rank)) - 1);
+  return sorted[index] * 1000.0;
+}
+
+/**
+ * Quotes a string for JSON, escaping the quotes, backslashes and control
+ * characters that can't appear in a JSON string as they are, such as in a
+ * driver's name.
+ * @param text the string.
+ * @return the quoted string.
+ */
+std::string JsonString(const std::string& text) {
+  std::string quoted = "\"";
+  for (char character : text) {
+    if (character == '"' || character == '\\') {
+      quoted += '\\';
+      quoted += character;
+    } else if (static_cast<unsigned char>(character) < 0x20) {
+      char escaped[7];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                    static_cast<unsigned>(character));
+      quoted += escaped;
+    } else {
+      quoted += character;
+    }
+  }
+  return quoted + "\"";
+}
+
+/**
+ * Creates a benchmark, reserving room for the frames so that recording them
+ * doesn't allocate.
+ * @param state_names the names of the game states, in order.
+ * @param expected_frames how many frames each state is expected to have.
+ */
+FrameBenchmark::FrameBenchmark(std::vector<std::string> state_names,
+                               size_t expected_frames) :
+    kStateNames(std::move(state_names)),
+    frame_secs_(kStateNames.size()) {
+  for (auto& frames : frame_secs_) {
+    frames.reserve(expected_frames);
+  }
+}
+
+/**
+ * Records a frame's time.
+ * @param state the index of the state the frame was in.
+ * @param frame_secs how long the frame took, in seconds.
+ */
+void FrameBenchmark::Record(size_t state, double frame_secs) {
+  if (state < frame_secs_.size()) {
+    frame_secs_[state].push_back(static_cast<float>(frame_secs));
+  }
+}
+
+/**
+ * Writes the number of frames, and the mean, median, 90th and 99th
+ * percentile and longest frame time of every state that had any frames.
+ * @param path the path of the JSON file, which is overwritten.
+ * @param renderer the name of the GL renderer the frames were drawn with.
+ * @return true if the file was written, false otherwise.
+ */
+bool FrameBenchmark::WriteJson(const std::string& path,
+                               const std::string& renderer) const {
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+
+  file << "{\n  \"renderer\": " << JsonString(renderer)
+       << ",\n  \"states\": {";
+  bool is_first = true;
+  for (size_t state = 0; state < kStateNames.size(); state++) {
+    std::vector<float> sorted = frame_secs_[state];
+    if (sorted.empty()) {
+      continue;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    double total_secs = 0;
+    for (float secs : sorted) {
+      total_secs += secs;
+    }
+
+    file << (is_first ? "\n" : ",\n")
+         << "    \"" << kStateNames[state] << "\": {"
+         << "\"frames\": " << sorted.size()
+         << ", \"mean_ms\": "
+         << total_secs * 1000.0 / static_cast<double>(sorted.size())
+         << ", \"p50_ms\": " << PercentileMs(sorted, 0.5)
+         << ", \"p90_ms\": " << PercentileMs(sorted, 0.9)
+         << ", \"p99_ms\": " << PercentileMs(sorted, 0.99)
+         << ", \"max_ms\": " << sorted.back() * 1000.0 << "}";
+    is_first = false;
+  }
+  file << "\n  }\n}\n";
+  return static_cast<bool>(file);
+}
+
+}  // namespace screamyball_app
@@ -0,0 +1,30 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_FRAME_BENCHMARK_H_
+#define FINALPROJECT_APPS_FRAME_BENCHMARK_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace screamyball_app {
+
+/**
+ * Records how long every frame takes, grouped by the game state the frame
+ * was in, and writes their percentiles to a JSON file so that builds can be
+ * compared.
+ */
+class FrameBenchmark {
+ public:
+  FrameBenchmark(std::vector<std::string> state_names, size_t expected_frames);
+  void Record(size_t state, double frame_secs);
+  bool WriteJson(const std::string& path, const std::string& renderer) const;
+
+ private:
+  const std::vector<std::string> kStateNames;
+  std::vector<std::vector<float>> frame_secs_;
+};
+
+}  // namespace screamyball_app
+
+#endif  // FINALPROJECT_APPS_FRAME_BENCHMARK_H_
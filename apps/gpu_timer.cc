@@ -0,0 +1,59 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include "gpu_timer.h"
+
+namespace screamyball_app {
+
+/**
+ * Creates the queries, in the current GL context.
+ */
+GpuTimer::GpuTimer() : queries_(), current_(0), is_pending_() {
+  glGenQueries(2, queries_);
+}
+
+GpuTimer::~GpuTimer() {
+  glDeleteQueries(2, queries_);
+}
+
+/**
+ * Starts timing the GPU's work, from the commands given after this.
+ */
+void GpuTimer::Begin() {
+  glBeginQuery(GL_TIME_ELAPSED, queries_[current_]);
+}
+
+/**
+ * Stops timing the GPU's work, and times the next frame with the other
+ * query.
+ */
+void GpuTimer::End() {
+  glEndQuery(GL_TIME_ELAPSED);
+  is_pending_[current_] = true;
+  current_ = 1 - current_;
+}
+
+/**
+ * Reads the time of the frame before the last one timed, if the GPU has
+ * finished it. Never waits for the GPU.
+ * @param secs set to how long the GPU took to draw the frame, if it's done.
+ * @return true if the time was read, or false if it isn't ready yet, or was
+ * already read.
+ */
+bool GpuTimer::TakeSecs(double* secs) {
+  if (!is_pending_[current_]) {
+    return false;
+  }
+  GLint is_available = 0;
+  glGetQueryObjectiv(queries_[current_], GL_QUERY_RESULT_AVAILABLE,
+                     &is_available);
+  if (!is_available) {
+    return false;
+  }
+  GLuint64 nanoseconds = 0;
+  glGetQueryObjectui64v(queries_[current_], GL_QUERY_RESULT, &nanoseconds);
+  is_pending_[current_] = false;
+  *secs = static_cast<double>(nanoseconds) / 1e9;
+  return true;
+}
+
+}  // namespace screamyball_app
@@ -0,0 +1,39 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_GPU_TIMER_H_
+#define FINALPROJECT_APPS_GPU_TIMER_H_
+
+#include <cinder/gl/gl.h>
+
+#include <cstddef>
+
+namespace screamyball_app {
+
+/**
+ * Times the GPU's work in each frame with GL_TIME_ELAPSED queries. A
+ * frame's time is only ready once the GPU has drawn it, a frame or so
+ * later, so there are two queries that take turns, and a result is only
+ * read once it's available, so the CPU never waits for the GPU.
+ */
+class GpuTimer {
+ public:
+  GpuTimer();
+  ~GpuTimer();
+  GpuTimer(const GpuTimer&) = delete;
+  GpuTimer& operator=(const GpuTimer&) = delete;
+
+  void Begin();
+  void End();
+  bool TakeSecs(double* secs);
+
+ private:
+  GLuint queries_[2];
+  // the query the next frame is timed with, and which queries have a
+  // result that hasn't been read
+  size_t current_;
+  bool is_pending_[2];
+};
+
+}  // namespace screamyball_app
+
+#endif  // FINALPROJECT_APPS_GPU_TIMER_H_
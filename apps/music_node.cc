@@ -0,0 +1,107 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include "music_node.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace screamyball_app {
+
+// how many frames Cinder decodes at a time
+const size_t kDecodeFrames = 4096;
+
+/**
+ * Wraps a track.
+ * @param source the track, opened at the audio context's sample rate.
+ */
+CinderMusicSource::CinderMusicSource(cinder::audio::SourceFileRef source) :
+    source_(std::move(source)),
+    decoded_(kDecodeFrames, source_->getNumChannels()),
+    decoded_frames_(0),
+    next_frame_(0) {}
+
+/**
+ * Gets the number of channels in the track.
+ * @return the number of channels.
+ */
+size_t CinderMusicSource::Channels() const {
+  return source_->getNumChannels();
+}
+
+/**
+ * Gets the length of the track, at the context's sample rate.
+ * @return the number of frames.
+ */
+size_t CinderMusicSource::Frames() const {
+  return source_->getNumFrames();
+}
+
+/**
+ * Decodes the next frames, interleaving Cinder's channels.
+ * @param samples where the frames are decoded to.
+ * @param frames the most frames to decode.
+ * @return the number of frames decoded.
+ */
+size_t CinderMusicSource::Read(float* samples, size_t frames) {
+  const size_t channels = decoded_.getNumChannels();
+  size_t done = 0;
+  while (done < frames) {
+    if (next_frame_ == decoded_frames_) {
+      decoded_frames_ = source_->read(&decoded_);
+      next_frame_ = 0;
+      if (decoded_frames_ == 0) {
+        break;
+      }
+    }
+    const size_t count = std::min(frames - done,
+                                  decoded_frames_ - next_frame_);
+    for (size_t channel = 0; channel < channels; channel++) {
+      const float* source = decoded_.getChannel(channel) + next_frame_;
+      for (size_t frame = 0; frame < count; frame++) {
+        samples[(done + frame) * channels + channel] = source[frame];
+      }
+    }
+    next_frame_ += count;
+    done += count;
+  }
+  return done;
+}
+
+/**
+ * Moves to a frame, dropping whatever was decoded past the last Read().
+ * @param frame the frame.
+ */
+void CinderMusicSource::Seek(size_t frame) {
+  source_->seek(frame);
+  decoded_frames_ = 0;
+  next_frame_ = 0;
+}
+
+/**
+ * Creates the node with the streamer it plays from.
+ * @param streamer the streamer, whose worker is started separately.
+ * @param format the node's format.
+ */
+MusicNode::MusicNode(std::unique_ptr<screamy_ball::MusicStreamer> streamer,
+                     const Format& format) :
+    InputNode(format),
+    streamer_(std::move(streamer)) {}
+
+/**
+ * Gets the streamer.
+ * @return the streamer.
+ */
+screamy_ball::MusicStreamer& MusicNode::Streamer() {
+  return *streamer_;
+}
+
+/**
+ * Plays the next frames of the music, on the audio thread.
+ * @param buffer the node's buffer.
+ */
+void MusicNode::process(cinder::audio::Buffer* buffer) {
+  streamer_->Mix(buffer->getData(), buffer->getNumChannels(),
+                 buffer->getNumFrames());
+}
+
+}  // namespace screamyball_app
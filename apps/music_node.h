@@ -0,0 +1,56 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_MUSIC_NODE_H_
+#define FINALPROJECT_APPS_MUSIC_NODE_H_
+
+#include <cinder/audio/Buffer.h>
+#include <cinder/audio/InputNode.h>
+#include <cinder/audio/Source.h>
+#include <screamy-ball/music_stream.h>
+
+#include <memory>
+
+namespace screamyball_app {
+
+/**
+ * Decodes a track with Cinder, for a MusicStreamer. Cinder decodes a whole
+ * buffer at a time, so the frames past what's asked for are kept for the
+ * next Read().
+ */
+class CinderMusicSource : public screamy_ball::MusicSource {
+ public:
+  explicit CinderMusicSource(cinder::audio::SourceFileRef source);
+  size_t Channels() const override;
+  size_t Frames() const override;
+  size_t Read(float* samples, size_t frames) override;
+  void Seek(size_t frame) override;
+
+ private:
+  cinder::audio::SourceFileRef source_;
+  cinder::audio::Buffer decoded_;
+  size_t decoded_frames_;
+  size_t next_frame_;
+};
+
+/**
+ * An audio node that plays the music from a MusicStreamer, whose worker
+ * decodes it ahead of the audio thread.
+ */
+class MusicNode : public cinder::audio::InputNode {
+ public:
+  MusicNode(std::unique_ptr<screamy_ball::MusicStreamer> streamer,
+            const Format& format = Format());
+  screamy_ball::MusicStreamer& Streamer();
+
+ protected:
+  void process(cinder::audio::Buffer* buffer) override;
+
+ private:
+  std::unique_ptr<screamy_ball::MusicStreamer> streamer_;
+};
+
+using MusicNodeRef = std::shared_ptr<MusicNode>;
+
+}  // namespace screamyball_app
+
+#endif  // FINALPROJECT_APPS_MUSIC_NODE_H_
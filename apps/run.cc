@@ -20,8 +20,40 @@ DEFINE_uint32(height, 16, "the number of tiles in each column");
 DEFINE_uint32(tilesize, 50, "the size of each tile");
 DEFINE_double(delay_secs, 0.1, "the delay (in seconds) of the game");
 DEFINE_string(player_name, "J o m p", "The name of the player to display");
+DEFINE_bool(autoplay, false, "let a bot play the game instead of the player");
+DEFINE_bool(count_allocations, false,
+            "exit with an error if a frame allocates while playing");
+DEFINE_bool(profile, false, "show how long each phase of a frame takes");
+DEFINE_string(trace_file, "",
+              "record a Chrome trace of the game to this file, if it's set");
+DEFINE_string(replay, "", "play the inputs in this replay file");
+DEFINE_string(benchmark_json, "",
+              "write the frame times of the replay to this file, uncapped");
+DEFINE_string(speech_mode, "grammar",
+              "how spoken commands are recognized: grammar or kws");
+DEFINE_int32(speech_cpu, -1,
+             "pin the speech recognizer to this CPU, or -1 not to pin it");
+DEFINE_bool(voice_control, false,
+            "jump by screaming, louder for higher, and duck by humming low");
+DEFINE_string(asset_pack, "",
+              "map the assets from this pack, made by the asset_pack target, "
+              "instead of reading each of them from its own file");
+DEFINE_string(level, "",
+              "play this level, made by level_builder, falling back to random "
+              "obstacles once it runs out");
+DEFINE_double(target_fps, 60,
+              "the frame rate the game runs at, which the quality level is "
+              "lowered to hold");
+DEFINE_int32(quality, -1,
+             "draw the game at this quality level, from 0 (8x MSAA) to 5 "
+             "(half resolution), or -1 to pick it from the frame times");
+DEFINE_double(idle_fps, 10,
+              "the frame rate in the menus and while paused, or 0 to keep "
+              "the full frame rate there");
 
-const int kSamples = 8;
+// the game is multisampled in its own framebuffer, at the quality level's
+// samples, so the window isn't
+const int kSamples = 0;
 const int kWidth = 800;
 const int kHeight = 800;
 
@@ -0,0 +1,39 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include "scream_node.h"
+
+#include <utility>
+
+namespace screamyball_app {
+
+/**
+ * Creates the node with the decoded scream.
+ * @param clip the scream, decoded at the audio context's sample rate, with
+ * every channel's frames one after another.
+ * @param channels the number of channels in the clip.
+ * @param voices how many screams can overlap.
+ * @param format the node's format.
+ */
+ScreamNode::ScreamNode(std::vector<float> clip, size_t channels,
+                       size_t voices, const Format& format) :
+    InputNode(format),
+    player_(std::move(clip), channels, voices) {}
+
+/**
+ * Gets the sample player, to trigger the scream.
+ * @return the sample player.
+ */
+screamy_ball::SamplePlayer& ScreamNode::Player() {
+  return player_;
+}
+
+/**
+ * Mixes the playing screams into the node's buffer, on the audio thread.
+ * @param buffer the node's buffer.
+ */
+void ScreamNode::process(cinder::audio::Buffer* buffer) {
+  player_.Mix(buffer->getData(), buffer->getNumChannels(),
+              buffer->getNumFrames());
+}
+
+}  // namespace screamyball_app
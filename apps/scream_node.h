@@ -0,0 +1,36 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_SCREAM_NODE_H_
+#define FINALPROJECT_APPS_SCREAM_NODE_H_
+
+#include <cinder/audio/Buffer.h>
+#include <cinder/audio/InputNode.h>
+#include <screamy-ball/sample_player.h>
+
+#include <memory>
+#include <vector>
+
+namespace screamyball_app {
+
+/**
+ * An audio node that plays the scream with a SamplePlayer, mixing its voices
+ * in the audio callback.
+ */
+class ScreamNode : public cinder::audio::InputNode {
+ public:
+  ScreamNode(std::vector<float> clip, size_t channels, size_t voices,
+             const Format& format = Format());
+  screamy_ball::SamplePlayer& Player();
+
+ protected:
+  void process(cinder::audio::Buffer* buffer) override;
+
+ private:
+  screamy_ball::SamplePlayer player_;
+};
+
+using ScreamNodeRef = std::shared_ptr<ScreamNode>;
+
+}  // namespace screamyball_app
+
+#endif  // FINALPROJECT_APPS_SCREAM_NODE_H_
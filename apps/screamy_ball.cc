@@ -1,13 +1,41 @@
 // Copyright (c) 2020 Ishita Rao. All rights reserved.
 
 #include "screamy_ball.h"
+#include "allocation_counter.h"
+#include <cinder/Buffer.h>
+#include <cinder/DataSource.h>
 #include <cinder/Font.h>
 #include <cinder/Text.h>
 #include <cinder/Vector.h>
 #include <cinder/app/App.h>
+#include <cinder/audio/Context.h>
+#include <cinder/audio/Source.h>
+#include <cinder/GeomIo.h>
+#include <cinder/gl/GlslProg.h>
+#include <cinder/gl/Vbo.h>
+#include <cinder/gl/VboMesh.h>
 #include <cinder/gl/draw.h>
 #include <cinder/gl/gl.h>
 #include <gflags/gflags.h>
+#include <screamy-ball/wav.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace screamyball_app {
 
@@ -19,8 +47,13 @@ using cinder::app::toPixels;
 using cinder::params::InterfaceGl;
 using ci::fs::path;
 using ci::app::getAssetPath;
+using screamy_ball::Action;
 using screamy_ball::BallState;
+using screamy_ball::Burst;
 using screamy_ball::Location;
+using screamy_ball::SpeechCommand;
+using screamy_ball::TraceScope;
+using screamy_ball::Tracer;
 
 
 #if defined(CINDER_COCOA_TOUCH)
@@ -42,6 +75,88 @@ DECLARE_uint32(height);
 DECLARE_uint32(tilesize);
 DECLARE_double(delay_secs);
 DECLARE_string(player_name);
+DECLARE_bool(autoplay);
+DECLARE_bool(count_allocations);
+DECLARE_bool(profile);
+DECLARE_string(trace_file);
+DECLARE_string(replay);
+DECLARE_string(benchmark_json);
+DECLARE_bool(voice_control);
+DECLARE_string(speech_mode);
+DECLARE_int32(speech_cpu);
+DECLARE_string(asset_pack);
+DECLARE_string(level);
+DECLARE_double(idle_fps);
+DECLARE_double(target_fps);
+DECLARE_int32(quality);
+
+// the names of the profiled phases, in the order of the Phase enum
+const char* const kPhaseNames[] = {
+    "update", "engine", "leaderboard", "draw", "panels", "text", "gpu"
+};
+
+// the quality levels, from the best looking to the cheapest to draw
+const QualityLevel kQualityLevels[] = {
+    { 8, 1.0f, -1 },
+    { 4, 1.0f, -1 },
+    { 2, 1.0f, -1 },
+    { 0, 1.0f, -1 },
+    { 0, 0.75f, 24 },
+    { 0, 0.5f, 12 }
+};
+
+// the looks the particle shader gives each kind of particle
+enum ParticleKind : unsigned { kSpark, kDust, kShockwave };
+
+// each particle is a square, scaled and colored by its instance's fields:
+// x and y in tiles, the fraction of its life it has left, and its kind
+const char kParticleVertexShader[] = R"(
+#version 150
+uniform mat4 ciModelViewProjection;
+uniform float uTileSize;
+in vec4 ciPosition;
+in vec4 iParticle;
+out vec4 vColor;
+
+const vec3 kColors[3] = vec3[](vec3(1.0, 0.8, 0.2), vec3(0.6, 0.6, 0.6),
+                               vec3(1.0, 0.3, 0.3));
+
+void main() {
+  float size = mix(0.04, 0.12, iParticle.z) * uTileSize;
+  vec2 center = iParticle.xy * uTileSize;
+  gl_Position = ciModelViewProjection
+      * vec4(center + ciPosition.xy * size, 0.0, 1.0);
+  vColor = vec4(kColors[int(iParticle.w)], iParticle.z);
+}
+)";
+
+const char kParticleFragmentShader[] = R"(
+#version 150
+in vec4 vColor;
+out vec4 oColor;
+
+void main() {
+  oColor = vColor;
+}
+)";
+
+// the names of the game states, in the order of the GameState enum
+const std::vector<string> kStateNames = {
+    "menu", "help", "playing", "game_over", "confirming_reset", "leaderboard"
+};
+
+/**
+ * Gets this process's id, which tells apart the files that instances of the
+ * game running side by side write.
+ * @return the id.
+ */
+int ProcessId() {
+#if defined(_WIN32)
+  return _getpid();
+#else
+  return static_cast<int>(getpid());
+#endif
+}
 
 ScreamyBall::ScreamyBall()
     : kTileSize(FLAGS_tilesize),
@@ -52,63 +167,323 @@ ScreamyBall::ScreamyBall()
       kLeaderboardLimit(3),
       kLocMultiplier(0.5),
       kDefaultVolume(0.25), // music might mess with the speech recognition
+      kMusicCrossfadeSecs(0.25), // hides the silence MP3s are padded with
       kUiDimensions({ FLAGS_tilesize * 4, FLAGS_tilesize * 3}),
       kPlayerName(FLAGS_player_name),
+      kAutoplay(FLAGS_autoplay),
+      kCountAllocations(FLAGS_count_allocations),
+      kWarmupFrames(60), // the first frames fill the GL and text caches
+      kTextCacheLimit(64),
+      kProfileGraphSecs(1.0f / 30), // the graph's height is two 60Hz frames
+      kReplayPath(FLAGS_replay),
+      kBenchmarkPath(FLAGS_benchmark_json),
+      kVoiceControl(FLAGS_voice_control),
+      kFrameRate(static_cast<float>(FLAGS_target_fps)),
+      // replays count frames, and benchmarks time them uncapped, so neither
+      // is throttled
+      kIdleFrameRate(FLAGS_replay.empty() && FLAGS_benchmark_json.empty()
+          ? static_cast<float>(FLAGS_idle_fps) : 0),
+      // benchmarks and allocation checks need every frame drawn the same
+      // way, so they only use a fixed level
+      kAdaptQuality(FLAGS_quality < 0 && FLAGS_benchmark_json.empty()
+          && !FLAGS_count_allocations),
+      kMaxParticles(10000),
       engine_({2, static_cast<int>(FLAGS_height - 2)},
         FLAGS_width, FLAGS_height),
-      leaderboard_(getAssetPath("screamy_ball.db").string()),
+      autoplayer_(12), // a little more than one full jump
+      camera_(FLAGS_width, FLAGS_height),
+      // chunks as wide as the board: one behind it, the two it can span, and
+      // one ahead
+      obstacle_chunks_(static_cast<int>(FLAGS_width), 4, 16),
+      tracked_obstacle_x_(-1),
+      is_obstacle_untracked_(false),
       elapsed_time_("00:00:00"),
       state_(GameState::kMenu),
       last_state_(GameState::kMenu),
+      shown_state_(GameState::kMenu),
+      playing_frames_(0),
+      frame_start_allocations_(0),
+      show_profile_(FLAGS_profile),
+      frame_(0),
+      frame_state_(GameState::kMenu),
+      next_replay_event_(0),
+      jump_strength_(100),
+      voice_ducking_(false),
+      is_muted_(false),
+      is_idling_(false),
+      screen_revision_(0),
+      cached_screen_(),
+      is_screen_cached_(false),
+      live_frames_(0),
+      leaderboard_task_(0),
+      help_task_(0),
+      has_started_up_(false),
+      startup_frame_(0),
+      benchmark_(kStateNames, 1 << 16),
       paused_(false),
       confirmed_reset_(false),
+      score_saved_(false),
       delay_secs_(FLAGS_delay_secs),
       last_update_secs_(0.00),
       timer_(false),
+      kScreamVoices(8),
       bg_music_("pokemon_battle_music.mp3"), // same mood
-      scream_audio_("scream_audio.mp3") {}
+      scream_channels_(0),
+      profile_advance_(0),
+      screen_samples_(0),
+      scene_samples_(0),
+      gpu_secs_(0),
+      quality_(sizeof(kQualityLevels) / sizeof(kQualityLevels[0]),
+               1 / FLAGS_target_fps),
+      particles_(kMaxParticles, std::random_device()()),
+      particle_instances_(kMaxParticles
+          * screamy_ball::ParticleSystem::kInstanceFloats),
+      startup_(std::thread::hardware_concurrency()) {}
 
 /* ------------------------------Set Up-------------------------------------- */
 
 /**
  * Cinder's standard setup function to set up the initial state of the game.
+ * Only what the menu needs is set up here. Everything else is loaded by the
+ * startup tasks while the menu is already showing.
  */
 void ScreamyBall::setup() {
+  SetupTracing();
   cinder::gl::enableDepthWrite();
   cinder::gl::enableDepthRead();
-  SetupRecognizer();
 
   SetupMainMenuUi();
   SetupInGameUi();
   SetupGeneralUi();
+  ShowPanels();
+  SetupProfileGlyphs();
+  SetupReplay();
+  SetupParticles();
+  SetupGpuTimer();
+  SetupLevel();
+  TrackWorld();
+  SetupVoiceControl();
+  SetupStartup();
+}
 
-  SetupInitialLeaderboards();
+/**
+ * Starts loading the leaderboard, the help page, the music, the scream and
+ * the speech models on a pool of threads. Whatever touches the audio graph
+ * is connected on the main thread once it's loaded, so each part comes
+ * online as soon as its own files are ready.
+ */
+void ScreamyBall::SetupStartup() {
+  // the asset paths and the sample rate are looked up on the main thread
+  const string db_path = getAssetPath("screamy_ball.db").string();
+  const path help_path = getAssetPath("help.txt");
+  const path music_path = getAssetPath(bg_music_.asset_name_);
+  const path scream_path = getAssetPath("scream_audio.mp3");
+  const path acoustic_model_path = getAssetPath("en-us");
+  const path dict_path = getAssetPath("6247.dic");
+  const size_t sample_rate = cinder::audio::master()->getSampleRate();
+
+  const Player current_player = { kPlayerName, elapsed_time_ };
+  const string pack_path = FLAGS_asset_pack;
+
+  const auto map_pack = startup_.Add("map asset pack",
+      [this, pack_path]() { MapAssetPack(pack_path); });
+  const auto open_leaderboard = startup_.Add("open leaderboard",
+      [this, db_path, current_player]() {
+        LoadInitialLeaderboards(db_path, current_player); });
+  help_task_ = startup_.Add("read help",
+      [this, help_path]() { SetupHelp(help_path); }, { map_pack });
+  const auto decode_music = startup_.Add("decode music",
+      [this, music_path, sample_rate]() {
+        LoadMusic(bg_music_, music_path, sample_rate); },
+      { map_pack });
+  const auto decode_scream = startup_.Add("decode scream",
+      [this, scream_path, sample_rate]() {
+        LoadScream(scream_path, sample_rate); }, { map_pack });
+  const auto load_speech = startup_.Add("load speech models",
+      [this, acoustic_model_path, dict_path, sample_rate]() {
+        LoadRecognizer(acoustic_model_path, dict_path,
+                       static_cast<unsigned>(sample_rate)); });
+
+  leaderboard_task_ = startup_.AddOnMainThread("show leaderboard",
+      [this]() { SetupInitialLeaderboards(); }, { open_leaderboard });
+  startup_.AddOnMainThread("start music",
+      [this]() { SetupMusic(bg_music_); }, { decode_music });
+  startup_.AddOnMainThread("connect scream",
+      [this]() { SetupScream(); }, { decode_scream });
+  startup_.AddOnMainThread("start speech",
+      [this]() { SetupRecognizer(); }, { load_speech });
+  startup_.Start();
+}
 
-  SetupMusic(bg_music_);
-  SetupMusic(scream_audio_);
-  bg_music_.audio_obj_->start();
+/**
+ * Starts recording a trace of the game, if a trace file was given.
+ */
+void ScreamyBall::SetupTracing() {
+  if (FLAGS_trace_file.empty()) {
+    return;
+  }
+  if (!Tracer::Get().Start(FLAGS_trace_file)) {
+    std::cerr << "Couldn't open the trace file " << FLAGS_trace_file
+              << std::endl;
+    return;
+  }
+  Tracer::Get().NameThread("main");
 }
 
 /**
- * Initialises ciSpeech's speech recognizer to 'keyword' mode.
+ * Loads the replay, if one was given. When benchmarking, the frame rate is
+ * uncapped so that the frame times are the time it takes to make a frame.
+ * The quality level starts at the one that was asked for, or the best one.
  */
-void ScreamyBall::SetupRecognizer() {
-  path acoustic_model_path  = getAssetPath("en-us");
-  path dict_path = getAssetPath("6247.dic");
-  path lang_model_path = getAssetPath("6247.lm");
+void ScreamyBall::SetupReplay() {
+  quality_.SetLevel(FLAGS_quality < 0 ? 0
+                                      : static_cast<size_t>(FLAGS_quality));
+  if (!kBenchmarkPath.empty()) {
+    disableFrameRate();
+    cinder::gl::enableVerticalSync(false);
+  } else {
+    setFrameRate(kFrameRate);
+  }
+  if (kReplayPath.empty()) {
+    return;
+  }
 
-  //set up the language and the dictionary
-  recognizer_ = sphinx::Recognizer::create(acoustic_model_path.string(),
-      dict_path.string());
+  std::ifstream input(kReplayPath);
+  if (!input) {
+    std::cerr << "Couldn't open the replay " << kReplayPath << std::endl;
+    quit();
+    return;
+  }
+  try {
+    replay_ = screamy_ball::ParseReplay(input);
+  } catch (const std::invalid_argument& error) {
+    std::cerr << error.what() << std::endl;
+    quit();
+  }
+}
+
+/**
+ * Creates the particles' instanced batch: one square, drawn once for every
+ * live particle, with the particles' fields streamed into a buffer that's
+ * made big enough for the most particles there can be.
+ */
+void ScreamyBall::SetupParticles() {
+  particle_vbo_ = cinder::gl::Vbo::create(GL_ARRAY_BUFFER,
+      particle_instances_.size() * sizeof(float), nullptr, GL_STREAM_DRAW);
+  cinder::geom::BufferLayout layout;
+  layout.append(cinder::geom::Attrib::CUSTOM_0,
+                screamy_ball::ParticleSystem::kInstanceFloats, 0, 0, 1);
+
+  const auto mesh = cinder::gl::VboMesh::create(cinder::geom::Rect(
+      cinder::Rectf(-0.5f, -0.5f, 0.5f, 0.5f)));
+  mesh->appendVbo(layout, particle_vbo_);
+  const auto shader = cinder::gl::GlslProg::create(kParticleVertexShader,
+                                                   kParticleFragmentShader);
+  shader->uniform("uTileSize", static_cast<float>(kTileSize));
+  particle_batch_ = cinder::gl::Batch::create(mesh, shader,
+      { { cinder::geom::Attrib::CUSTOM_0, "iParticle" } });
+}
 
-  //event handler for whenever speech is detected
-  recognizer_->connectEventHandler(std::bind(
-      &ScreamyBall::RecognizeCommands, this, std::placeholders::_1));
+/**
+ * Creates the queries that time the GPU's work in each frame, which the
+ * quality level is judged by alongside the CPU's.
+ */
+void ScreamyBall::SetupGpuTimer() {
+  gpu_timer_ = std::make_unique<GpuTimer>();
+}
 
-  //create and add a model based on the text file
-  recognizer_->addModelJsgf("default", lang_model_path.string(),
-      true);
-  recognizer_->start();
+/**
+ * Cinder's standard cleanup function, called before the app quits. It writes
+ * the rest of the trace.
+ */
+void ScreamyBall::cleanup() {
+  Tracer::Get().Stop();
+}
+
+/**
+ * Loads the speech recognizer's acoustic model and dictionary, and a grammar
+ * or keyword list generated from the same table the commands are parsed
+ * with, so it doesn't decode free speech. The grammar is written to a file
+ * of this process's own, since PocketSphinx only reads it from one, and
+ * removed once the decoder has read it. This runs on the startup pool.
+ * @param acoustic_model_path the acoustic model's directory.
+ * @param dict_path the pronunciation dictionary.
+ * @param sample_rate the microphone's sample rate.
+ * @throws std::invalid_argument if the speech mode isn't grammar or kws.
+ * @throws std::runtime_error if the grammar can't be written, or the models
+ * can't be loaded.
+ */
+void ScreamyBall::LoadRecognizer(const path& acoustic_model_path,
+                                 const path& dict_path,
+                                 unsigned sample_rate) {
+  const bool is_keyword_spotting = FLAGS_speech_mode == "kws";
+  if (!is_keyword_spotting && FLAGS_speech_mode != "grammar") {
+    throw std::invalid_argument("The speech mode must be grammar or kws, not "
+                                + FLAGS_speech_mode);
+  }
+  const path model_path = ci::fs::temp_directory_path()
+      / ("screamy_ball_commands_" + std::to_string(ProcessId())
+         + (is_keyword_spotting ? ".kws" : ".gram"));
+  {
+    std::ofstream model(model_path.string());
+    model << (is_keyword_spotting ? screamy_ball::KeywordList()
+                                  : screamy_ball::CommandGrammar());
+    model.close();
+    if (!model) {
+      std::remove(model_path.string().c_str());
+      throw std::runtime_error("Couldn't write the speech commands to "
+                               + model_path.string());
+    }
+  }
+
+  const std::vector<string> args = {
+      "-hmm", acoustic_model_path.string(),
+      "-dict", dict_path.string(),
+      is_keyword_spotting ? "-kws" : "-jsgf", model_path.string(),
+      "-logfn", "/dev/null"
+  };
+  // the decoder has read the grammar by the time it's made, whether or not
+  // it loaded
+  try {
+    loaded_recognizer_ = std::make_shared<SpeechRecognizer>(args,
+                                                            sample_rate);
+  } catch (...) {
+    std::remove(model_path.string().c_str());
+    throw;
+  }
+  std::remove(model_path.string().c_str());
+}
+
+/**
+ * Starts the loaded recognizer on its own thread, and feeds it the speech
+ * the microphone's gate lets through. It listens in every screen, since the
+ * menus have spoken commands too; the gate is what keeps it asleep while
+ * nobody's talking.
+ */
+void ScreamyBall::SetupRecognizer() {
+  const auto context = cinder::audio::master();
+  recognizer_ = std::move(loaded_recognizer_);
+  recognizer_->Start(FLAGS_speech_cpu);
+  recognizer_->SetListening(true);
+
+  SetupMicrophone();
+  speech_node_ = context->makeNode(new SpeechNode(recognizer_));
+  microphone_ >> speech_node_;
+  // nothing is played from the node, so it's pulled by the context itself
+  context->addAutoPulledNode(speech_node_);
+  speech_node_->enable();
+  context->enable();
+}
+
+/**
+ * Opens the microphone, which speech recognition and voice control share.
+ */
+void ScreamyBall::SetupMicrophone() {
+  if (microphone_) {
+    return;
+  }
+  microphone_ = cinder::audio::master()->createInputDeviceNode();
+  microphone_->enable();
 }
 
 /**
@@ -154,18 +529,14 @@ void ScreamyBall::SetupMainMenuUi() {
                                  toPixels(kUiDimensions));
 
   //Start button: fires a lambda that starts the timer and the game when pressed
-  menu_ui_->addButton("Start",[&]() {
-    ResetGame();
-    last_state_ = state_;
-    state_ = GameState::kPlaying; });
+  menu_ui_->addButton("Start",
+                      std::bind(&ScreamyBall::StartGame, this));
 
   menu_ui_->addButton("Help",[&]() {
     ParseUserInteraction(KeyEvent::KEY_h); });
 
-  menu_ui_->addButton("Leaderboard", [&]() {
-    last_state_ = state_;
-    state_ = GameState::kLeaderboard;
-  });
+  menu_ui_->addButton("Leaderboard",
+                      std::bind(&ScreamyBall::ShowLeaderboard, this));
 
   menu_ui_->addButton("Mute",
                       std::bind(&ScreamyBall::Mute,this));
@@ -193,26 +564,241 @@ void ScreamyBall::SetupGeneralUi() {
 }
 
 /**
- * Sets up the leaderboard at the start of the game.
+ * Opens the leaderboard and reads its scores at the start of the game. This
+ * runs on the startup pool, so it isn't timed by the profiler.
+ * @param db_path the leaderboard's database.
+ * @param current_player the player whose own scores are shown.
+ */
+void ScreamyBall::LoadInitialLeaderboards(const string& db_path,
+                                          const Player& current_player) {
+  leaderboard_ = std::make_unique<screamy_ball::Leaderboard>(db_path);
+  loaded_top_players_ = leaderboard_->RetrieveHighScores(kLeaderboardLimit);
+
+  loaded_current_player_top_scores_ = leaderboard_->RetrieveHighScores
+      (current_player, kLeaderboardLimit);
+}
+
+/**
+ * Shows the leaderboard's scores, once they've been read.
  */
 void ScreamyBall::SetupInitialLeaderboards() {
-  top_players_ = leaderboard_.RetrieveHighScores(kLeaderboardLimit);
+  top_players_ = std::move(loaded_top_players_);
+  current_player_top_scores_ = std::move(loaded_current_player_top_scores_);
+  FormatTopPlayerRows();
+}
 
-  current_player_top_scores_ = leaderboard_.RetrieveHighScores
-      ({ kPlayerName, elapsed_time_ }, kLeaderboardLimit);
+/**
+ * Renders every printable ASCII character of the profile's font to its own
+ * texture, and spaces them all as far apart as the widest one.
+ */
+void ScreamyBall::SetupProfileGlyphs() {
+  profile_advance_ = 0;
+  // the space is never drawn, only skipped over
+  for (size_t glyph = 1; glyph < profile_glyphs_.size(); glyph++) {
+    auto box = TextBox()
+        .font(cinder::Font(kNormalFont, 14))
+        .color(Color::white())
+        .backgroundColor(ColorA::zero())
+        .text(string(1, static_cast<char>(' ' + glyph)));
+    profile_glyphs_[glyph] = cinder::gl::Texture::create(box.render());
+    profile_advance_ = std::max(profile_advance_, static_cast<float>(
+        profile_glyphs_[glyph]->getWidth()));
+  }
 }
 
 /**
- * Initialises the music.
- * @param audio Audio object that contains the asset path and the VoiceRef
- * object.
+ * Maps the level into memory, if one was given, and has the engine take its
+ * obstacles from it. Only its index is read here; its chunks are streamed
+ * in as the camera reaches them. If it can't be opened, or it has obstacles
+ * longer than the board, the obstacles are random instead.
+ */
+void ScreamyBall::SetupLevel() {
+  if (FLAGS_level.empty()) {
+    return;
+  }
+  try {
+    auto level = std::make_unique<screamy_ball::Level>(FLAGS_level);
+    // the obstacles are tracked in chunks as wide as the board
+    if (level->LongestObstacle() > static_cast<int>(FLAGS_width)) {
+      throw std::invalid_argument("The level has obstacles longer than the "
+                                  "board");
+    }
+    level_ = std::move(level);
+    engine_.SetObstacleSource(level_.get());
+  } catch (const std::exception& error) {
+    std::cerr << FLAGS_level << ": " << error.what()
+              << ", so the obstacles are random" << std::endl;
+  }
+}
+
+/**
+ * Maps the asset pack into memory, if one was given. If it can't be opened,
+ * the loose assets are read instead.
+ * @param pack_path the pack's file.
+ */
+void ScreamyBall::MapAssetPack(const string& pack_path) {
+  if (pack_path.empty()) {
+    return;
+  }
+  try {
+    asset_pack_ = std::make_unique<screamy_ball::AssetPack>(pack_path);
+  } catch (const std::exception& error) {
+    std::cerr << pack_path << ": " << error.what()
+              << ", so the loose assets are used" << std::endl;
+  }
+}
+
+/**
+ * Finds an asset in the asset pack.
+ * @param asset_path the asset's loose file, whose name it's packed under.
+ * @return the packed asset, or nullptr if there's no pack or it isn't in it.
+ */
+const screamy_ball::PackedAsset* ScreamyBall::FindPacked(
+    const path& asset_path) const {
+  if (!asset_pack_) {
+    return nullptr;
+  }
+  return asset_pack_->Find(asset_path.filename().string());
+}
+
+/**
+ * Opens an asset, from the asset pack if it's there, without copying it out
+ * of the pack, or from its loose file otherwise. Compressed audio is always
+ * opened from its loose file, since some of Cinder's decoders (CoreAudio's,
+ * on macOS) can only decode a file by its path, not from memory.
+ * @param asset_path the asset's loose file.
+ * @return the asset's data.
+ */
+cinder::DataSourceRef ScreamyBall::OpenAsset(const path& asset_path) const {
+  const screamy_ball::PackedAsset* packed = FindPacked(asset_path);
+  if (packed == nullptr || packed->is_pcm
+      || asset_path.extension() == ".mp3") {
+    return cinder::loadFile(asset_path);
+  }
+  // the buffer only wraps the mapping, which is never written to
+  const auto buffer = std::make_shared<cinder::Buffer>(
+      const_cast<char*>(packed->data), packed->size);
+  return cinder::DataSourceBuffer::create(buffer, asset_path.filename());
+}
+
+/**
+ * Reads the help page once, so that it isn't loaded on every frame.
+ * @param help_path the help page.
+ */
+void ScreamyBall::SetupHelp(const path& help_path) {
+  auto input_stream = OpenAsset(help_path)->createStream();
+
+  help_lines_.push_back(input_stream->readLine());
+  while (!input_stream->isEof()) {
+    help_lines_.push_back(input_stream->readLine());
+  }
+}
+
+/**
+ * Opens the music, and decodes its start into the streamer's ring buffer, so
+ * it's ready to play. This runs on the startup pool.
+ * @param audio Audio object that contains the asset path and the music's
+ * nodes.
+ * @param asset_path the music's file.
+ * @param sample_rate the audio context's sample rate.
+ */
+void ScreamyBall::LoadMusic(Audio& audio, const path& asset_path,
+                            size_t sample_rate) {
+  std::unique_ptr<screamy_ball::MusicSource> source(new CinderMusicSource(
+      cinder::audio::load(OpenAsset(asset_path), sample_rate)));
+  screamy_ball::LoopPoints loop;
+  loop.crossfade = static_cast<size_t>(kMusicCrossfadeSecs
+                                       * static_cast<float>(sample_rate));
+  audio.streamer_ = std::make_unique<screamy_ball::MusicStreamer>(
+      std::move(source), static_cast<unsigned>(sample_rate), loop);
+  audio.streamer_->Fill();
+}
+
+/**
+ * Starts playing the music, once its start has been decoded. From then on,
+ * the streamer's worker decodes it and loops it, without the frame loop.
+ * @param audio Audio object that contains the asset path and the music's
+ * nodes.
  */
 void ScreamyBall::SetupMusic(Audio& audio) {
-  cinder::audio::SourceFileRef music_source = cinder::audio::load(
-      cinder::app::loadAsset(audio.asset_name_));
+  auto context = cinder::audio::master();
+  const size_t channels = audio.streamer_->Channels();
+  audio.node_ = context->makeNode(new MusicNode(std::move(audio.streamer_),
+      cinder::audio::Node::Format().channels(channels)));
+  audio.gain_ = context->makeNode(new cinder::audio::GainNode(
+      is_muted_ ? 0.0f : kDefaultVolume));
+  audio.node_ >> audio.gain_ >> context->getOutput();
+  audio.node_->Streamer().Start();
+  audio.node_->enable();
+  context->enable();
+}
 
-  audio.audio_obj_ = cinder::audio::Voice::create(music_source);
-  audio.audio_obj_->setVolume(kDefaultVolume);
+/**
+ * Decodes the scream once, so that screaming starts without reading the
+ * file. If the asset pack has it decoded already, its samples are only
+ * resampled if the pack was made for another sample rate. This runs on the
+ * startup pool.
+ * @param asset_path the scream's file.
+ * @param sample_rate the audio context's sample rate.
+ */
+void ScreamyBall::LoadScream(const path& asset_path, size_t sample_rate) {
+  const screamy_ball::PackedAsset* packed = FindPacked(asset_path);
+  if (packed != nullptr && packed->is_pcm) {
+    const float* samples = packed->Samples(0);
+    scream_channels_ = packed->channels;
+    // copied straight out of the mapping when the rates match, since the
+    // scream node owns its samples
+    scream_samples_.assign(samples,
+                           samples + packed->Frames() * packed->channels);
+    if (packed->sample_rate != sample_rate) {
+      scream_samples_ = screamy_ball::ResamplePlanar(
+          scream_samples_, packed->channels, packed->sample_rate,
+          static_cast<unsigned>(sample_rate));
+    }
+    return;
+  }
+
+  cinder::audio::SourceFileRef source = cinder::audio::load(
+      OpenAsset(asset_path), sample_rate);
+  const cinder::audio::BufferRef clip = source->loadBuffer();
+  // Cinder already stores every channel's frames one after another
+  scream_channels_ = clip->getNumChannels();
+  scream_samples_.assign(clip->getData(), clip->getData() + clip->getSize());
+}
+
+/**
+ * Plays the decoded scream from a pool of voices that's mixed in the audio
+ * callback, so that rapid jumps don't cut each other off.
+ */
+void ScreamyBall::SetupScream() {
+  auto context = cinder::audio::master();
+  scream_node_ = context->makeNode(new ScreamNode(std::move(scream_samples_),
+      scream_channels_, kScreamVoices,
+      cinder::audio::Node::Format().channels(scream_channels_)));
+  scream_gain_ = context->makeNode(new cinder::audio::GainNode(
+      is_muted_ ? 0.0f : kDefaultVolume));
+  scream_node_ >> scream_gain_ >> context->getOutput();
+  scream_node_->enable();
+  context->enable();
+}
+
+/**
+ * Listens to the microphone for screams and low hums, if voice control is on.
+ * The analysis runs in the audio callback, so the ball reacts within a block
+ * of samples rather than waiting for the speech recognizer.
+ */
+void ScreamyBall::SetupVoiceControl() {
+  if (!kVoiceControl) {
+    return;
+  }
+  auto context = cinder::audio::master();
+  SetupMicrophone();
+  voice_node_ = context->makeNode(new VoiceNode());
+  microphone_ >> voice_node_;
+  // nothing is played from the node, so it's pulled by the context itself
+  context->addAutoPulledNode(voice_node_);
+  voice_node_->enable();
+  context->enable();
 }
 
 /* --------------------------------Update------------------------------------ */
@@ -221,10 +807,23 @@ void ScreamyBall::SetupMusic(Audio& audio) {
  * Cinder's standard update function.
  */
 void ScreamyBall::update() {
-  // loop audio
-  if (!bg_music_.audio_obj_->isPlaying()) {
-    bg_music_.audio_obj_->start();
-  }
+  frame_start_allocations_ = AllocationCount();
+  profiler_.BeginFrame();
+  AdaptQuality();
+  startup_.RunMainThreadTasks();
+  LogStartup();
+  RecordFrame();
+  PlayReplay();
+  ListenForCommands();
+  ApplyVoiceCommands();
+  ThrottleIdle();
+  frame_state_ = state_;
+  frame_++;
+  screamy_ball::ScopedTimer timer(&profiler_, PhaseIndex(Phase::kUpdate));
+  TraceScope trace("update", "frame");
+  // timed with the update, so the quality level is judged with them, and
+  // before the state's update, since the particles move even while paused
+  MoveParticles();
 
   switch (state_) {
     case GameState::kPlaying: {
@@ -242,16 +841,22 @@ void ScreamyBall::update() {
 
     case GameState::kGameOver: {
       timer_.stop();
-      elapsed_time_ = PrettyPrintElapsedTime(timer_.getSeconds());
+      const string elapsed_time = PrettyPrintElapsedTime(timer_.getSeconds());
+      if (elapsed_time != elapsed_time_) {
+        elapsed_time_ = elapsed_time;
+        InvalidateScreen();
+      }
       PopulateLeaderboards();
       break;
     }
 
     case GameState::kConfirmingReset: {
       timer_.stop();
-      if (confirmed_reset_) {
+      if (confirmed_reset_ && IsLeaderboardReady()) {
+        screamy_ball::ScopedTimer leaderboard_timer(&profiler_,
+            PhaseIndex(Phase::kLeaderboard));
         ResetGame();
-        leaderboard_.Reset();
+        leaderboard_->Reset();
       }
       break;
     }
@@ -265,6 +870,128 @@ void ScreamyBall::update() {
   }
 }
 
+/**
+ * Shows what's still loading on the menu, and logs how long each startup
+ * task took once they've all finished.
+ */
+void ScreamyBall::LogStartup() {
+  if (has_started_up_) {
+    return;
+  }
+  if (!startup_.IsFinished()) {
+    const string loading_text = "Loading " + startup_.Pending() + "...";
+    if (loading_text != loading_text_) {
+      loading_text_ = loading_text;
+      InvalidateScreen();
+    }
+    return;
+  }
+  has_started_up_ = true;
+  startup_frame_ = frame_;
+  loading_text_.clear();
+  InvalidateScreen();
+
+  std::printf("Startup:\n");
+  for (const auto& timing : startup_.Timings()) {
+    std::printf("  %-20s %-6s at %7.1fms took %7.1fms%s%s\n", timing.name,
+                timing.on_main_thread ? "main" : "pool",
+                timing.start_secs * 1000, timing.secs * 1000,
+                timing.failed ? ": " : "", timing.error.c_str());
+  }
+  std::fflush(stdout);
+}
+
+/**
+ * Checks whether the leaderboard has been opened and its scores shown.
+ * @return true if the leaderboard can be used.
+ */
+bool ScreamyBall::IsLeaderboardReady() const {
+  return startup_.IsDone(leaderboard_task_);
+}
+
+/**
+ * Records the last frame's time under the state it was in, if benchmarking.
+ */
+void ScreamyBall::RecordFrame() {
+  if (kBenchmarkPath.empty() || profiler_.Frames() == 0 || !has_started_up_) {
+    return;
+  }
+  benchmark_.Record(static_cast<size_t>(frame_state_),
+      profiler_.Secs(screamy_ball::FrameProfiler::kFrame, 0));
+}
+
+/**
+ * Gives the game the replay's inputs for this frame, the same way the
+ * player's inputs are given. The replay's frames are counted from the end of
+ * startup, so that every run replays the same game.
+ */
+void ScreamyBall::PlayReplay() {
+  if (!has_started_up_) {
+    return;
+  }
+  while (next_replay_event_ < replay_.size()
+         && replay_[next_replay_event_].frame <= frame_ - startup_frame_) {
+    const string& action = replay_[next_replay_event_++].action;
+
+    if (action == "start") {
+      StartGame();
+    } else if (action == "leaderboard") {
+      ShowLeaderboard();
+    } else if (action == "menu") {
+      ParseUserInteraction(KeyEvent::KEY_m);
+    } else if (action == "help") {
+      ParseUserInteraction(KeyEvent::KEY_h);
+    } else if (action == "jump") {
+      ParseUserInteraction(KeyEvent::KEY_UP);
+    } else if (action == "duck") {
+      ParseUserInteraction(KeyEvent::KEY_DOWN);
+    } else if (action == "roll") {
+      engine_.state_ = BallState::kRolling;
+    } else if (action == "pause") {
+      ParseUserInteraction(KeyEvent::KEY_p);
+    } else if (action == "profile") {
+      ParseUserInteraction(KeyEvent::KEY_f);
+    } else if (action == "quit") {
+      FinishReplay();
+    } else {
+      std::cerr << "Unknown replay action " << action << std::endl;
+    }
+  }
+}
+
+/**
+ * Writes the benchmark's results, if benchmarking, and quits.
+ */
+void ScreamyBall::FinishReplay() {
+  if (!kBenchmarkPath.empty()) {
+    const auto renderer = reinterpret_cast<const char*>(
+        glGetString(GL_RENDERER));
+    if (!benchmark_.WriteJson(kBenchmarkPath,
+                              renderer == nullptr ? "" : renderer)) {
+      std::cerr << "Couldn't write the benchmark to " << kBenchmarkPath
+                << std::endl;
+    }
+  }
+  quit();
+}
+
+/**
+ * Starts a new game from the main menu.
+ */
+void ScreamyBall::StartGame() {
+  ResetGame();
+  last_state_ = state_;
+  state_ = GameState::kPlaying;
+}
+
+/**
+ * Shows the leaderboard.
+ */
+void ScreamyBall::ShowLeaderboard() {
+  last_state_ = state_;
+  state_ = GameState::kLeaderboard;
+}
+
 /**
  * Calls the engine's Run function after the specified
  * number of delay seconds have passed (to control game speed)
@@ -273,7 +1000,15 @@ void ScreamyBall::RunEngine() {
   const double current_time = timer_.getSeconds();
   // manage game speed
   if (current_time - last_update_secs_ >= delay_secs_) {
+    screamy_ball::ScopedTimer timer(&profiler_, PhaseIndex(Phase::kEngine));
+    TraceScope trace("tick", "engine");
+    if (kAutoplay) {
+      Autoplay();
+    }
+    const BallState last_state = engine_.state_;
     engine_.Run();
+    TrackWorld();
+    EmitParticles(last_state);
     last_update_secs_ = current_time;
 
     if (engine_.state_ == BallState::kCollided) {
@@ -285,71 +1020,250 @@ void ScreamyBall::RunEngine() {
 }
 
 /**
- * Updates the leaderborads with the latest times.
+ * Lets the autoplayer pick an action, and submits it the same way a player's
+ * key presses are submitted.
+ */
+void ScreamyBall::Autoplay() {
+  switch (autoplayer_.Decide(engine_)) {
+    case Action::kJump: {
+      if (engine_.state_ != BallState::kJumping) {
+        ParseUserInteraction(KeyEvent::KEY_UP);
+      }
+      break;
+    }
+
+    case Action::kDuck: {
+      if (engine_.state_ == BallState::kRolling) {
+        ParseUserInteraction(KeyEvent::KEY_DOWN);
+      }
+      break;
+    }
+
+    // rolling is the same as releasing the duck key
+    case Action::kRoll: {
+      if (engine_.state_ == BallState::kDucking) {
+        engine_.state_ = BallState::kRolling;
+      }
+      break;
+    }
+  }
+}
+
+/**
+ * Saves the game's time to the leaderboard once, as soon as the leaderboard
+ * is ready, and updates the scores shown with it.
  */
 void ScreamyBall::PopulateLeaderboards() {
-  if (top_players_.empty()) {
+  if (!score_saved_ && IsLeaderboardReady()) {
+    score_saved_ = true;
+    screamy_ball::ScopedTimer timer(&profiler_,
+                                    PhaseIndex(Phase::kLeaderboard));
     Player current_player = { kPlayerName, elapsed_time_ };
-    leaderboard_.AddScoreToLeaderboard(current_player);
-    top_players_ = leaderboard_.RetrieveHighScores(kLeaderboardLimit);
+    leaderboard_->AddScoreToLeaderboard(current_player);
+    top_players_ = leaderboard_->RetrieveHighScores(kLeaderboardLimit);
 
-    current_player_top_scores_ = leaderboard_.RetrieveHighScores
+    current_player_top_scores_ = leaderboard_->RetrieveHighScores
         (current_player, kLeaderboardLimit);
 
     // It is crucial that these vectors be populated, given that the limit > 0.
     assert(!top_players_.empty());
     assert(!current_player_top_scores_.empty());
+    FormatTopPlayerRows();
   }
 }
 
+/**
+ * Formats the top players' rows of the leaderboard once, whenever the top
+ * players change, so they aren't formatted on every frame.
+ */
+void ScreamyBall::FormatTopPlayerRows() {
+  top_player_rows_.clear();
+  for (const Player& player : top_players_) {
+    top_player_rows_.push_back(player.name + " - " + player.elapsed_time);
+  }
+  InvalidateScreen();
+}
+
 /**
  * Mutes audio if unmuted, unmutes audio otherwise.
  */
 void ScreamyBall::Mute() {
-  if (bg_music_.audio_obj_->getVolume() == 0.00) {
-    bg_music_.audio_obj_->setVolume(kDefaultVolume);
-    scream_audio_.audio_obj_->setVolume(kDefaultVolume);
-  } else {
-    bg_music_.audio_obj_->setVolume(0.00);
-    scream_audio_.audio_obj_->setVolume(0.00);
+  is_muted_ = !is_muted_;
+  ApplyVolume();
+}
+
+/**
+ * Sets the volume of whichever sounds have been loaded so far.
+ */
+void ScreamyBall::ApplyVolume() {
+  const float volume = is_muted_ ? 0.0f : kDefaultVolume;
+  if (bg_music_.gain_) {
+    bg_music_.gain_->setValue(volume);
+  }
+  if (scream_gain_) {
+    scream_gain_->setValue(volume);
   }
 }
 
 /**
- * Pretty Prints the input time in seconds in the format hh:mm:ss.
- * @param time_secs the time in seconds to pretty print
- * @return the elapsed time in the above format
+ * Plays the scream that goes with every jump and duck, once it's loaded.
  */
-string PrettyPrintElapsedTime(double time_secs) {
-  int seconds = (int) time_secs;
-  int double_digits = 10;
+void ScreamyBall::Scream() {
+  if (!scream_node_) {
+    return;
+  }
+  screamy_ball::TraceInstant("scream", "audio");
+  scream_node_->Player().Trigger();
+
+  // a ring around the ball, which spreads out evenly in every direction
+  const float center_x = static_cast<float>(engine_.ball_.location.Row())
+      + kLocMultiplier;
+  const float center_y = static_cast<float>(engine_.ball_.y)
+      / screamy_ball::kSubTiles - kLocMultiplier;
+  particles_.Emit({ center_x, center_y, 96, 5, 5, 0, 3.1416f, 0.35f, 0,
+                    kShockwave });
+}
 
-  int hours = seconds / (kNumSeconds * kNumSeconds);
-  seconds -= hours * (kNumSeconds * kNumSeconds);
+/**
+ * Checks whether the game is idle: in a menu, or paused, where nothing moves
+ * unless the player does something. The game over screen only idles once
+ * the collision's sparks have died out.
+ * @return true if the game is idle.
+ */
+bool ScreamyBall::IsIdle() const {
+  if (state_ == GameState::kGameOver) {
+    return particles_.Size() == 0;
+  }
+  return state_ != GameState::kPlaying || paused_;
+}
 
-  int minutes = seconds / kNumSeconds;
-  seconds -= minutes * kNumSeconds;
+/**
+ * Moves the particles on by the last frame's time, unless the game is idle,
+ * where they're frozen along with everything else.
+ */
+void ScreamyBall::MoveParticles() {
+  if (IsIdle()) {
+    return;
+  }
+  // a long frame, such as the first one after a pause, only moves them on
+  // by a little
+  const auto secs = static_cast<float>(std::min(0.1,
+      profiler_.Secs(screamy_ball::FrameProfiler::kFrame, 0)));
+  particles_.Update(secs);
+}
 
-  std::stringstream sstream;
-  if (hours < double_digits) {
-    sstream << '0' << hours << ':';
-  } else {
-    sstream << hours << ':';
+/**
+ * Moves the camera to where the engine has scrolled to, adds the engine's
+ * obstacle to its chunk once it's spawned, and releases the chunks the
+ * camera has passed, both here and in the level.
+ */
+void ScreamyBall::TrackWorld() {
+  const long long scroll = engine_.Scroll();
+  camera_.MoveTo(static_cast<double>(scroll) / screamy_ball::kSubTiles);
+  if (level_) {
+    level_->Stream(scroll);
   }
+  obstacle_chunks_.Release(obstacle_chunks_.ChunkOf(scroll) - 1);
 
-  if (minutes < double_digits) {
-    sstream << '0' << minutes << ':';
-  } else {
-    sstream << minutes << ':';
+  // a level's obstacle can be further ahead than the resident chunks, so
+  // it's only tracked once its chunk has come in
+  const long long obstacle_x = engine_.ObstacleWorldX();
+  if (obstacle_x == tracked_obstacle_x_) {
+    return;
+  }
+  is_obstacle_untracked_ = false;
+  if (obstacle_chunks_.Add({ obstacle_x, engine_.obstacle_.type,
+                             engine_.obstacle_.length })) {
+    tracked_obstacle_x_ = obstacle_x;
+  } else if (obstacle_chunks_.ChunkOf(obstacle_x)
+             < obstacle_chunks_.EndChunk()) {
+    // its chunk is in, or already let go, and has no room for it, so adding
+    // it again would only fail every tick; it's drawn straight from the
+    // engine instead
+    screamy_ball::TraceInstant("untracked obstacle", "world");
+    tracked_obstacle_x_ = obstacle_x;
+    is_obstacle_untracked_ = true;
   }
+}
 
-  if (seconds < double_digits) {
-    sstream << '0' << seconds;
-  } else {
-    sstream << seconds;
+/**
+ * Resets the engine, and moves the camera back to the start of the world.
+ */
+void ScreamyBall::ResetWorld() {
+  engine_.Reset();
+  obstacle_chunks_.Clear();
+  tracked_obstacle_x_ = -1;
+  is_obstacle_untracked_ = false;
+  TrackWorld();
+}
+
+/**
+ * Throws out sparks when the ball hits a spike, and dust when it lands from
+ * a jump, from where the ball is.
+ * @param last_state the ball's state before the engine's last tick.
+ */
+void ScreamyBall::EmitParticles(BallState last_state) {
+  const float center_x = static_cast<float>(engine_.ball_.location.Row())
+      + kLocMultiplier;
+  const float bottom = static_cast<float>(engine_.ball_.y)
+      / screamy_ball::kSubTiles;
+
+  if (engine_.state_ == BallState::kCollided) {
+    screamy_ball::TraceInstant("sparks", "particles");
+    particles_.Emit({ center_x, bottom - kLocMultiplier, 400, 2, 8, 1.57f,
+                      3.14f, 0.6f, 12, kSpark });
+  } else if (last_state == BallState::kJumping
+             && engine_.state_ == BallState::kRolling) {
+    particles_.Emit({ center_x, bottom, 60, 0.5f, 2, 1.57f, 1.2f, 0.4f, 3,
+                      kDust });
   }
+}
 
-  return sstream.str();
+/**
+ * Drops the frame rate while the game is idle, and brings it back once the
+ * game is played again, so an idle game barely uses the CPU and GPU.
+ */
+void ScreamyBall::ThrottleIdle() {
+  const bool is_idle = IsIdle();
+  if (kIdleFrameRate <= 0 || is_idle == is_idling_) {
+    return;
+  }
+  is_idling_ = is_idle;
+  setFrameRate(is_idle ? kIdleFrameRate : kFrameRate);
+  screamy_ball::TraceInstant(is_idle ? "idle" : "active", "frame");
+}
+
+/**
+ * Judges the game's quality level by the last frame, if it was drawn live
+ * after another live frame. The frames of the menus and the first frame
+ * after them are skipped, since they're idle or waited at the idle frame
+ * rate.
+ */
+void ScreamyBall::AdaptQuality() {
+  if (!kAdaptQuality) {
+    return;
+  }
+  if (live_frames_ < 2 || !has_started_up_ || profiler_.Frames() == 0) {
+    quality_.Discard();
+    return;
+  }
+  // swapping the buffers isn't part of the work, since it waits for vsync;
+  // the GPU draws while the CPU works on the next frame, so whichever takes
+  // longer is what limits the frame
+  const double cpu_secs = profiler_.Secs(PhaseIndex(Phase::kUpdate), 0)
+      + profiler_.Secs(PhaseIndex(Phase::kDraw), 0);
+  const double work_secs = std::max(cpu_secs,
+      profiler_.Secs(PhaseIndex(Phase::kGpu), 0));
+  quality_.AddFrame(profiler_.Secs(screamy_ball::FrameProfiler::kFrame, 0),
+                    work_secs);
+}
+
+/**
+ * Gets how the game is drawn at the current quality level.
+ * @return the quality level.
+ */
+const QualityLevel& ScreamyBall::Quality() const {
+  return kQualityLevels[quality_.Level()];
 }
 
 /* ----------------------------------Draw------------------------------------ */
@@ -358,20 +1272,157 @@ string PrettyPrintElapsedTime(double time_secs) {
  * Cinder's standard draw function to generate graphics for the game.
  */
 void ScreamyBall::draw() {
+  screamy_ball::ScopedTimer timer(&profiler_, PhaseIndex(Phase::kDraw));
+  TraceScope trace("draw", "frame");
+  gpu_timer_->Begin();
   cinder::gl::enableAlphaBlending();
 
-  menu_ui_->hide();
-  in_game_ui_->hide();
-  general_ui_->show();
+  if (shown_state_ != state_) {
+    shown_state_ = state_;
+    ShowPanels();
+  }
+
+  if (IsIdle()) {
+    live_frames_ = 0;
+    DrawStaticScreen();
+  } else {
+    // the game moves every frame, so it's drawn again every frame, and the
+    // next static screen can't be the one that was cached
+    live_frames_++;
+    is_screen_cached_ = false;
+    DrawScene();
+  }
+
+  {
+    screamy_ball::ScopedTimer panels_timer(&profiler_,
+                                           PhaseIndex(Phase::kPanels));
+    // only one of the panels is shown at a time
+    if (menu_ui_->isVisible()) {
+      menu_ui_->draw();
+    } else if (in_game_ui_->isVisible()) {
+      in_game_ui_->draw();
+    } else {
+      general_ui_->draw();
+    }
+  }
+
+  if (show_profile_) {
+    DrawProfile();
+  }
+
+  gpu_timer_->End();
+  double gpu_secs;
+  if (gpu_timer_->TakeSecs(&gpu_secs)) {
+    gpu_secs_ = gpu_secs;
+  }
+  profiler_.AddTime(PhaseIndex(Phase::kGpu),
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(gpu_secs_)));
+  // the startup tasks allocate as they load
+  if (has_started_up_) {
+    CheckFrameAllocations();
+  }
+}
+
+/**
+ * Draws a screen that only changes when the game's state, the leaderboard,
+ * the loading text or the window does, such as the menus or the paused
+ * game. It's drawn into a framebuffer once, with the quality level's
+ * multisampling so its edges match the live game's, and copied from there
+ * on every frame after that until it changes.
+ */
+void ScreamyBall::DrawStaticScreen() {
+  const int samples = Quality().msaa_samples;
+  const ScreenKey screen = { state_, toPixels(getWindowSize()),
+                             getWindowPos(), screen_revision_ };
+  if (!is_screen_cached_ || !(screen == cached_screen_)
+      || screen_samples_ != samples) {
+    TraceScope trace("cache screen", "frame");
+    if (!screen_fbo_ || screen_fbo_->getSize() != screen.size_
+        || screen_samples_ != samples) {
+      screen_fbo_ = cinder::gl::Fbo::create(screen.size_.x, screen.size_.y,
+          cinder::gl::Fbo::Format().samples(samples));
+      screen_samples_ = samples;
+    }
+    cinder::gl::ScopedFramebuffer framebuffer(screen_fbo_);
+    cinder::gl::ScopedViewport viewport(ivec2(0), screen_fbo_->getSize());
+    cinder::gl::ScopedMatrices matrices;
+    cinder::gl::setMatricesWindow(getWindowSize());
+    DrawScreen();
+    cached_screen_ = screen;
+    is_screen_cached_ = true;
+  }
+
+  // the screen is already blended, so it's copied as it is
+  cinder::gl::ScopedBlend blend(false);
+  cinder::gl::ScopedColor color(Color::white());
+  cinder::gl::draw(screen_fbo_->getColorTexture(),
+                   cinder::Rectf(getWindowBounds()));
+}
+
+/**
+ * Draws the live game at the quality level's resolution and multisampling,
+ * and scales it up to the window. The framebuffer is only made again when
+ * the level or the window's size changes.
+ */
+void ScreamyBall::DrawScene() {
+  const QualityLevel& quality = Quality();
+  const cinder::vec2 window_size = toPixels(getWindowSize());
+  const ivec2 size = { std::max(1, static_cast<int>(
+                           window_size.x * quality.render_scale)),
+                       std::max(1, static_cast<int>(
+                           window_size.y * quality.render_scale)) };
+  if (!scene_fbo_ || scene_fbo_->getSize() != size
+      || scene_samples_ != quality.msaa_samples) {
+    TraceScope trace("resize scene", "frame");
+    scene_fbo_ = cinder::gl::Fbo::create(size.x, size.y,
+        cinder::gl::Fbo::Format().samples(quality.msaa_samples));
+    scene_samples_ = quality.msaa_samples;
+  }
+
+  {
+    cinder::gl::ScopedFramebuffer framebuffer(scene_fbo_);
+    cinder::gl::ScopedViewport viewport(ivec2(0), scene_fbo_->getSize());
+    cinder::gl::ScopedMatrices matrices;
+    cinder::gl::setMatricesWindow(getWindowSize());
+    DrawScreen();
+  }
 
+  cinder::gl::ScopedBlend blend(false);
+  cinder::gl::ScopedColor color(Color::white());
+  cinder::gl::draw(scene_fbo_->getColorTexture(),
+                   cinder::Rectf(getWindowBounds()));
+}
+
+/**
+ * Marks the static screens as out of date, so the next one is drawn again
+ * instead of being copied from the framebuffer.
+ */
+void ScreamyBall::InvalidateScreen() {
+  screen_revision_++;
+}
+
+/**
+ * Checks whether two static screens were drawn from the same things.
+ * @param other the other screen.
+ * @return true if they're the same screen.
+ */
+bool ScreamyBall::ScreenKey::operator==(const ScreenKey& other) const {
+  return state_ == other.state_ && size_ == other.size_
+      && position_ == other.position_ && revision_ == other.revision_;
+}
+
+/**
+ * Draws the screen for the current game state, without its panel.
+ */
+void ScreamyBall::DrawScreen() {
   switch (state_) {
     case GameState::kGameOver: {
       DrawGameOver();
+      DrawParticles();
       break;
     }
     case GameState::kMenu: {
-      menu_ui_->show();
-      general_ui_->hide();
       DrawMainMenu();
       break;
     }
@@ -389,20 +1440,166 @@ void ScreamyBall::draw() {
     }
 
     case GameState::kPlaying: {
-      in_game_ui_->show();
-      general_ui_->hide();
-      if (paused_) {
-        return;
-      }
       DrawBackground();
       DrawBall();
       DrawObstacles();
+      DrawParticles();
+      break;
+    }
+  }
+}
+
+/**
+ * Shows the panel for the current game state, and hides the others. Showing
+ * and hiding the panels is only done when the state changes.
+ */
+void ScreamyBall::ShowPanels() {
+  menu_ui_->hide();
+  in_game_ui_->hide();
+  general_ui_->hide();
+
+  switch (state_) {
+    case GameState::kMenu: {
+      menu_ui_->show();
+      break;
     }
+    case GameState::kPlaying: {
+      in_game_ui_->show();
+      break;
+    }
+    default: {
+      general_ui_->show();
+      break;
+    }
+  }
+}
+
+/**
+ * Exits with an error if a frame allocated memory while playing, when the
+ * allocations are being counted. The first few frames of a game are skipped,
+ * since they fill the caches that the rest of the game reuses.
+ */
+void ScreamyBall::CheckFrameAllocations() {
+  if (!kCountAllocations) {
+    return;
+  }
+  if (state_ != GameState::kPlaying || paused_) {
+    playing_frames_ = 0;
+    return;
+  }
+  if (++playing_frames_ <= kWarmupFrames) {
+    return;
+  }
+
+  const size_t allocations = AllocationCount() - frame_start_allocations_;
+  if (allocations > 0) {
+    std::cerr << "Frame " << playing_frames_ << " allocated " << allocations
+              << " times while playing" << std::endl;
+    std::exit(EXIT_FAILURE);
   }
+}
 
-  menu_ui_->draw();
-  in_game_ui_->draw();
-  general_ui_->draw();
+/**
+ * Converts a phase of the frame to the profiler's index for it.
+ * @param phase the phase.
+ * @return the phase's index.
+ */
+size_t ScreamyBall::PhaseIndex(Phase phase) const {
+  return static_cast<size_t>(phase);
+}
+
+/**
+ * Draws the profile of the recent frames over the game: the median and the
+ * 99th percentile time of each phase, and a graph of the frame times, newest
+ * on the right, with a line at a 60Hz frame.
+ */
+void ScreamyBall::DrawProfile() {
+  const float line_height = 16;
+  const float graph_height = 60;
+  const size_t num_phases = sizeof(kPhaseNames) / sizeof(kPhaseNames[0]);
+  const size_t frames = screamy_ball::FrameProfiler::kFrames;
+  const float bar_width = 1;
+  const float width = bar_width * frames;
+  // a line for every phase, the whole frame, the scream's latency, the
+  // speech recognizer's load and the quality level
+  const float text_height = line_height * (num_phases + 4);
+
+  cinder::gl::color(ColorA(0, 0, 0, 0.75f));
+  cinder::gl::drawSolidRect(cinder::Rectf(0, 0, width,
+                                          text_height + graph_height));
+
+  // the text is formatted into a fixed buffer, and drawn from the glyphs
+  char line[64];
+  cinder::gl::color(Color::white());
+  for (size_t phase = 0; phase <= num_phases; phase++) {
+    const size_t index = phase < num_phases ? phase
+        : screamy_ball::FrameProfiler::kFrame;
+    std::snprintf(line, sizeof(line), "%-12s p50 %6.2fms  p99 %6.2fms",
+                  phase < num_phases ? kPhaseNames[phase] : "frame",
+                  profiler_.Percentile(index, 0.5) * 1000,
+                  profiler_.Percentile(index, 0.99) * 1000);
+    DrawProfileLine(line, line_height * static_cast<float>(phase));
+  }
+
+  // a scream is heard one audio block after the callback that starts it
+  const auto context = cinder::audio::master();
+  const double block_secs = static_cast<double>(context->getFramesPerBlock())
+      / static_cast<double>(context->getSampleRate());
+  if (scream_node_) {
+    const screamy_ball::SamplePlayer& scream = scream_node_->Player();
+    std::snprintf(line, sizeof(line), "%-12s avg %6.2fms  max %6.2fms",
+                  "scream", (scream.MeanLatencySecs() + block_secs) * 1000,
+                  (scream.MaxLatencySecs() + block_secs) * 1000);
+    DrawProfileLine(line, text_height - line_height * 3);
+  }
+
+  if (recognizer_) {
+    std::snprintf(line, sizeof(line), "%-12s load %5.1f%%  dropped %zu",
+                  recognizer_->IsListening() ? "speech" : "speech (off)",
+                  recognizer_->Load() * 100, recognizer_->Dropped());
+    DrawProfileLine(line, text_height - line_height * 2);
+  }
+
+  const QualityLevel& quality = Quality();
+  std::snprintf(line, sizeof(line), "%-12s %zu/%zu  %dx msaa  %3.0f%%%s",
+                kAdaptQuality ? "quality" : "quality (set)",
+                quality_.Level() + 1, quality_.Levels(),
+                quality.msaa_samples, quality.render_scale * 100,
+                quality.ball_segments < 0 ? "" : "  low detail");
+  DrawProfileLine(line, text_height - line_height);
+
+  const float graph_bottom = text_height + graph_height;
+  cinder::gl::color(Color(0, 1, 0));
+  for (size_t ago = 0; ago < profiler_.Frames(); ago++) {
+    const float secs = static_cast<float>(
+        profiler_.Secs(screamy_ball::FrameProfiler::kFrame, ago));
+    const float height = std::min(1.0f, secs / kProfileGraphSecs)
+        * graph_height;
+    const float right = width - bar_width * static_cast<float>(ago);
+    cinder::gl::drawSolidRect(cinder::Rectf(right - bar_width,
+        graph_bottom - height, right, graph_bottom));
+  }
+
+  const float target = graph_bottom - graph_height / 2;
+  cinder::gl::color(Color(1, 1, 0));
+  cinder::gl::drawLine({ 0, target }, { width, target });
+}
+
+/**
+ * Draws a line of the profile's text from the pre-rendered glyphs, each
+ * the same width apart, so the formatted columns line up.
+ * @param line the text, in printable ASCII.
+ * @param top where the top of the line goes.
+ */
+void ScreamyBall::DrawProfileLine(const char* line, float top) {
+  float left = 4;
+  for (const char* c = line; *c != '\0'; c++) {
+    const int glyph = *c - ' ';
+    if (glyph > 0 && glyph < static_cast<int>(profile_glyphs_.size())) {
+      cinder::gl::draw(profile_glyphs_[glyph], cinder::vec2(left, top));
+    }
+    left += profile_advance_;
+  }
 }
 
 /**
@@ -417,21 +1614,35 @@ void ScreamyBall::draw() {
 template <typename C>
 void ScreamyBall::PrintText(const string& text, float font_size,
     const C& text_color, const ivec2& size, const cinder::vec2& loc) {
+  screamy_ball::ScopedTimer timer(&profiler_, PhaseIndex(Phase::kText));
   cinder::gl::color(text_color);
 
-  auto box = TextBox()
-      .alignment(TextBox::CENTER)
-      .font(cinder::Font(kDifferentFont, font_size))
-      .size(size)
-      .color(text_color)
-      .backgroundColor(ColorA::zero())
-      .text(text);
-
-  const auto box_size = box.getSize();
-  const cinder::vec2 locp = {loc.x - box_size.x * kLocMultiplier,
-                             loc.y - box_size.y * kLocMultiplier};
-  const auto surface = box.render();
-  const auto texture = cinder::gl::Texture::create(surface);
+  // the text is only rendered again if it's drawn differently
+  auto cached = text_cache_.find(text);
+  if (cached == text_cache_.end()
+      || cached->second.font_size_ != font_size
+      || cached->second.color_ != ColorA(text_color)
+      || cached->second.size_ != size) {
+    if (text_cache_.size() >= kTextCacheLimit) {
+      text_cache_.clear();
+    }
+
+    auto box = TextBox()
+        .alignment(TextBox::CENTER)
+        .font(cinder::Font(kDifferentFont, font_size))
+        .size(size)
+        .color(text_color)
+        .backgroundColor(ColorA::zero())
+        .text(text);
+
+    const auto texture = cinder::gl::Texture::create(box.render());
+    text_cache_[text] = { font_size, ColorA(text_color), size, texture };
+    cached = text_cache_.find(text);
+  }
+
+  const auto& texture = cached->second.texture_;
+  const cinder::vec2 locp = {loc.x - texture->getWidth() * kLocMultiplier,
+                             loc.y - texture->getHeight() * kLocMultiplier};
   cinder::gl::draw(texture, locp);
 }
 
@@ -444,6 +1655,11 @@ void ScreamyBall::DrawMainMenu() {
   const ivec2 size = { kTileSize * 4, kTileSize * 2 };
   const Color color = Color::white();
   PrintText("Screamy Ball", kDefaultFontSize, color, size, center);
+  if (!loading_text_.empty()) {
+    PrintText(loading_text_, (float)(kTileSize - kTextBoxBuffer) / 2, color,
+              { kWidth * kTileSize, kTileSize },
+              { center.x, center.y - kTileSize * 2 });
+  }
 
   menu_ui_->setPosition({ center.x - kTileSize * 2,
                          center.y + kTileSize });
@@ -459,24 +1675,32 @@ void ScreamyBall::DrawHelp() {
   const Color color = Color::white();
   size_t row = 0;
 
-  auto input_stream = cinder::loadFileStream(ci::app::getAssetPath(
-      "help.txt"));
-
-  PrintText(input_stream->readLine(), kDefaultFontSize, color, size, pos);
+  if (!startup_.IsDone(help_task_)) {
+    PrintText("Loading...", kDefaultFontSize, color, size, getWindowCenter());
+    return;
+  }
+  PrintText(help_lines_.front(), kDefaultFontSize, color, size, pos);
 
-  while (!input_stream->isEof()) {
+  for (auto line = help_lines_.begin() + 1; line != help_lines_.end();
+       ++line) {
     // The font is half the tile size
-    PrintText(input_stream->readLine(),
-        ((float)(kTileSize - kTextBoxBuffer) / 2), color, size,
+    PrintText(*line, ((float)(kTileSize - kTextBoxBuffer) / 2), color, size,
         { pos.x, pos.y + (++row) * kTileSize });
   }
 }
 
 /**
- * Draws the in-game background.
+ * Draws the in-game background: distant pillars that scroll past slowly
+ * behind the board, and the ground, whose markings scroll with it.
  */
 void ScreamyBall::DrawBackground() {
   cinder::gl::clear(Color::black());
+  const auto ground = static_cast<float>(engine_.kMinHeight);
+
+  cinder::gl::color(Color::gray(0.15f));
+  DrawParallaxLayer(5, 0.25f, 0.5f, ground / 2, ground);
+  cinder::gl::color(Color::gray(0.3f));
+  DrawParallaxLayer(3, 0.5f, 0.25f, ground * 3 / 4, ground);
 
   // draw the ground:
   int ground_height = engine_.kMinHeight;
@@ -484,6 +1708,35 @@ void ScreamyBall::DrawBackground() {
   const ivec2 upper_left = { 0, kTileSize * ground_height };
   const ivec2 bottom_right = { kWidth * kTileSize, kTileSize * kHeight };
   cinder::gl::drawSolidRect(cinder::Rectf(upper_left, bottom_right));
+
+  cinder::gl::color(Color::gray(0.7f));
+  DrawParallaxLayer(2, 1, 0.1f, ground + 0.25f, ground + 0.75f);
+}
+
+/**
+ * Draws a layer of the background as a row of evenly spaced bars. Only the
+ * bars in the camera's view are drawn, however far the world has scrolled.
+ * @param spacing the distance between the bars, in tiles.
+ * @param parallax how fast the layer scrolls, from 0 for one that never
+ * moves to 1 for one that moves with the board.
+ * @param width the width of each bar, in tiles.
+ * @param top the top of the bars, in tiles.
+ * @param bottom the bottom of the bars, in tiles.
+ */
+void ScreamyBall::DrawParallaxLayer(float spacing, float parallax,
+                                    float width, float top, float bottom) {
+  const auto tile = static_cast<float>(kTileSize);
+  const double view_width = camera_.Right() - camera_.Left();
+  for (long long bar = camera_.FirstVisible(spacing, parallax); ; bar++) {
+    const auto left = static_cast<float>(camera_.ToScreen(
+        static_cast<double>(bar) * spacing, parallax));
+    if (left >= view_width) {
+      break;
+    }
+    cinder::gl::drawSolidRect(cinder::Rectf(left * tile, top * tile,
+                                            (left + width) * tile,
+                                            bottom * tile));
+  }
 }
 
 /**
@@ -491,6 +1744,8 @@ void ScreamyBall::DrawBackground() {
  */
 void ScreamyBall::DrawBall() {
   const Location loc = engine_.ball_.location;
+  // the ball's height is drawn to a fraction of a tile
+  const float col = (float) engine_.ball_.y / screamy_ball::kSubTiles;
   const float loc_multiplier_cubed = pow(kLocMultiplier, 3);
   const float center_x = (loc.Row() + kLocMultiplier) * kTileSize;
   const float radius_x = (float)kTileSize * kLocMultiplier;
@@ -499,26 +1754,51 @@ void ScreamyBall::DrawBall() {
 
   if (engine_.state_ == BallState::kDucking) {
     const ivec2 ellipse_center = { center_x,
-                                   (loc.Col() - loc_multiplier_cubed)
+                                   (col - loc_multiplier_cubed)
                                     * kTileSize };
     cinder::gl::drawSolidEllipse(ellipse_center, radius_x,
-        ((float)kTileSize * loc_multiplier_cubed));
+        ((float)kTileSize * loc_multiplier_cubed), Quality().ball_segments);
   } else {
-    const ivec2 circle_center = { center_x, (loc.Col() - kLocMultiplier)
+    const ivec2 circle_center = { center_x, (col - kLocMultiplier)
                                          * kTileSize };
-    cinder::gl::drawSolidCircle(circle_center, radius_x);
+    cinder::gl::drawSolidCircle(circle_center, radius_x,
+                                Quality().ball_segments);
+  }
+}
+
+/**
+ * Draws the obstacles in the camera's view, from the chunks under it, so
+ * the obstacles elsewhere in the world are never looked at, and the current
+ * obstacle if the chunks had no room for it.
+ */
+void ScreamyBall::DrawObstacles() {
+  const auto left = static_cast<long long>(std::floor(
+      camera_.Left() * screamy_ball::kSubTiles));
+  const auto right = static_cast<long long>(std::ceil(
+      camera_.Right() * screamy_ball::kSubTiles));
+  obstacle_chunks_.ForEachIn(left, right,
+      [this](const screamy_ball::WorldObstacle& obstacle) {
+        DrawObstacle(obstacle); });
+  if (is_obstacle_untracked_) {
+    DrawObstacle({ engine_.ObstacleWorldX(), engine_.obstacle_.type,
+                   engine_.obstacle_.length });
   }
 }
 
 /**
- * Draws the obstacles, depending on type: 'high' obstacles are the ones
+ * Draws an obstacle, depending on type: 'high' obstacles are the ones
  * the ball is supposed to duck from, while 'low' obstacles are the ones
  * the ball is supposed to jump over.
+ * @param obstacle the obstacle, in the world.
  */
-void ScreamyBall::DrawObstacles() {
-  screamy_ball::Obstacle obstacle = engine_.obstacle_;
-  Location loc = obstacle.location;
-  const int obstacle_height = obstacle.kHeight;
+void ScreamyBall::DrawObstacle(const screamy_ball::WorldObstacle& obstacle) {
+  const int obstacle_height = engine_.obstacle_.kHeight;
+  // high obstacles hang from above the ground, like the engine's
+  const Location loc = { 0, obstacle.type == screamy_ball::ObstacleType::kHigh
+      ? engine_.kMinHeight - obstacle_height - 1 : engine_.kMinHeight };
+  // the obstacle's position is drawn to a fraction of a tile
+  auto row = static_cast<float>(camera_.ToScreen(
+      static_cast<double>(obstacle.x) / screamy_ball::kSubTiles));
   const float loc_incre = kTileSize * kLocMultiplier;
 
   cinder::gl::color(Color::gray(0.5)); // 0.5 is the % of grey
@@ -527,11 +1807,11 @@ void ScreamyBall::DrawObstacles() {
   for (int counter = 0; counter < obstacle.length; counter++) {
 
     // points of a triangle for a 'low' obstacle
-    ivec2 point_1 = {loc.Row() * kTileSize, loc.Col() * kTileSize};
-    ivec2 point_2 = {(loc.Row() - 1) * kTileSize,
+    ivec2 point_1 = {row * kTileSize, loc.Col() * kTileSize};
+    ivec2 point_2 = {(row - 1) * kTileSize,
                       loc.Col() * kTileSize};
 
-    ivec2 point_3 = {(loc.Row() - kLocMultiplier) * kTileSize,
+    ivec2 point_3 = {(row - kLocMultiplier) * kTileSize,
                               (loc.Col() - obstacle_height) * kTileSize};
 
     // increment location if it's a 'high' obstacle
@@ -546,8 +1826,26 @@ void ScreamyBall::DrawObstacles() {
     cinder::gl::drawSolidTriangle(point_1, point_2, point_3);
 
     // update location to draw another spike
-    loc = { loc.Row() + 1, loc.Col() };
+    row++;
+  }
+}
+
+/**
+ * Draws every live particle with one instanced draw call. The particles are
+ * see-through as they fade, so they don't write to the depth buffer.
+ */
+void ScreamyBall::DrawParticles() {
+  const size_t count = particles_.WriteInstances(particle_instances_.data());
+  if (count == 0) {
+    return;
   }
+  TraceScope trace("draw", "particles");
+  particle_vbo_->bufferSubData(0, count
+      * screamy_ball::ParticleSystem::kInstanceFloats * sizeof(float),
+      particle_instances_.data());
+  cinder::gl::ScopedDepth depth(false);
+  cinder::gl::ScopedBlendAlpha blend;
+  particle_batch_->drawInstanced(static_cast<GLsizei>(count));
 }
 
 /**
@@ -575,6 +1873,11 @@ void ScreamyBall::DrawLeaderboard() {
   const cinder::ivec2 size = { kTileSize * 10, kTileSize };
   const Color color = Color::white();
 
+  if (!IsLeaderboardReady()) {
+    PrintText("Loading...", kDefaultFontSize, color,
+              { kTileSize * 10, kTileSize * 2 }, getWindowCenter());
+    return;
+  }
   if (top_players_.empty()) {
     PrintText("Sorry, no leaderboard data is available yet. :(",
         kDefaultFontSize, color, { kTileSize * 10, kTileSize * 2 },
@@ -601,10 +1904,8 @@ void ScreamyBall::DrawTopPlayerScores(size_t& start_row, const Color& color,
   PrintText("Name - Time", kDefaultFontSize, color, size,
             { pos.x, pos.y + (++start_row) * kTileSize });
 
-  for (const Player& player : top_players_) {
-    std::stringstream ss;
-    ss << player.name << " - " << player.elapsed_time;
-    PrintText(ss.str(), kDefaultFontSize, color, size,
+  for (const string& row : top_player_rows_) {
+    PrintText(row, kDefaultFontSize, color, size,
               { pos.x, pos.y + (++start_row) * kTileSize });
   }
 }
@@ -661,24 +1962,85 @@ void ScreamyBall::DrawConfirmReset() {
 /* --------------------------User Interaction-------------------------------- */
 
 /**
- * Recognizes the user's spoken commands to perform the appropriate action.
+ * Performs the spoken commands the recognizer heard since the last frame.
  */
-void ScreamyBall::RecognizeCommands(const std::string& message) {
-  if (message == "HIGHER") {
+void ScreamyBall::ListenForCommands() {
+  if (!recognizer_) {
+    return;
+  }
+  recognizer_->TakeCommands(&spoken_commands_);
+  for (SpeechCommand command : spoken_commands_) {
+    RecognizeCommands(command);
+  }
+}
+
+/**
+ * Performs the appropriate action for the user's spoken command.
+ * @param command the command.
+ */
+void ScreamyBall::RecognizeCommands(SpeechCommand command) {
+  TraceScope trace("recognized", "speech");
+
+  switch (command) {
+    case SpeechCommand::kJump: {
+      ParseUserInteraction(KeyEvent::KEY_UP);
+      break;
+    }
+    case SpeechCommand::kDuck: {
+      ParseUserInteraction(KeyEvent::KEY_DOWN);
+      break;
+    }
+    case SpeechCommand::kPause: {
+      ParseUserInteraction(KeyEvent::KEY_p);
+      break;
+    }
+    case SpeechCommand::kReset: {
+      ParseUserInteraction(KeyEvent::KEY_r);
+      break;
+    }
+    case SpeechCommand::kMute: {
+      Mute();
+      break;
+    }
+    case SpeechCommand::kMenu: {
+      ParseUserInteraction(KeyEvent::KEY_m);
+      break;
+    }
+    case SpeechCommand::kHelp: {
+      ParseUserInteraction(KeyEvent::KEY_h);
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+/**
+ * Jumps and ducks for the screams and hums the voice node heard since the
+ * last frame. A louder scream jumps higher.
+ */
+void ScreamyBall::ApplyVoiceCommands() {
+  if (!voice_node_) {
+    return;
+  }
+  const int strength = voice_node_->TakeJump();
+  if (strength > 0) {
+    jump_strength_ = strength;
     ParseUserInteraction(KeyEvent::KEY_UP);
-  } else if (message == "LOWER") {
+    // the jump doesn't fire when paused or outside a game, and its strength
+    // mustn't carry over to the next key press
+    jump_strength_ = 100;
+  }
+
+  const bool is_ducking = voice_node_->IsDucking();
+  if (is_ducking && !voice_ducking_) {
     ParseUserInteraction(KeyEvent::KEY_DOWN);
-  } else if (message == "PAUSE GAME") { // just 'pause' is recognized randomly
-    ParseUserInteraction(KeyEvent::KEY_p);
-  } else if (message == "RESET GAME" || message == "RESET") {
-    ParseUserInteraction(KeyEvent::KEY_r);
-  } else if (message == "MUTE SOUNDS" || message == "SOUNDS") {
-    Mute(); //just 'mute' is recognized randomly, but 'sounds' isn't
-  } else if (message == "MAIN MENU" || message == "MENU") {
-    ParseUserInteraction(KeyEvent::KEY_m);
-  } else if (message == "INSTRUCTIONS") {
-    ParseUserInteraction(KeyEvent::KEY_h);
+  } else if (!is_ducking && voice_ducking_
+             && engine_.state_ == BallState::kDucking) {
+    engine_.state_ = BallState::kRolling;
   }
+  voice_ducking_ = is_ducking;
 }
 
 /**
@@ -752,7 +2114,7 @@ void ScreamyBall::ParseUserInteraction(int event_code) {
       last_state_ = state_;
       state_ = GameState::kMenu;
       timer_.stop();
-      engine_.Reset();
+      ResetWorld();
       break;
     }
     case KeyEvent::KEY_h: {
@@ -773,6 +2135,10 @@ void ScreamyBall::ParseUserInteraction(int event_code) {
       }
       break;
     }
+    case KeyEvent::KEY_f: {
+      show_profile_ = !show_profile_;
+      break;
+    }
     case KeyEvent::KEY_n: {
       if (state_ == GameState::kConfirmingReset) {
         state_ = last_state_;
@@ -797,7 +2163,9 @@ bool ScreamyBall::IsInGameInteraction(int event_code) {
       if (paused_) {
         return true;
       }
-      scream_audio_.audio_obj_->start();
+      Scream();
+      engine_.SetJumpStrength(jump_strength_);
+      jump_strength_ = 100;
       engine_.state_ = BallState::kJumping;
       return true;
     }
@@ -807,7 +2175,7 @@ bool ScreamyBall::IsInGameInteraction(int event_code) {
       if (paused_ || engine_.state_ == BallState::kJumping) {
         return true;
       }
-      scream_audio_.audio_obj_->start();
+      Scream();
       engine_.state_ = BallState::kDucking;
       return true;
     }
@@ -831,7 +2199,8 @@ bool ScreamyBall::IsInGameInteraction(int event_code) {
  * Resets the game state; sets all class variables to their initial values.
  */
 void ScreamyBall::ResetGame() {
-  engine_.Reset();
+  ResetWorld();
+  particles_.Clear();
   paused_ = false;
   confirmed_reset_ = false;
   last_state_ = state_;
@@ -839,8 +2208,8 @@ void ScreamyBall::ResetGame() {
   timer_.stop();
   last_update_secs_ = 0.00;
   elapsed_time_ = "00:00:00";
-  top_players_.clear();
-  current_player_top_scores_.clear();
+  score_saved_ = false;
+  InvalidateScreen();
 }
 
 }  // namespace screamyball_app
@@ -3,25 +3,52 @@
 #ifndef FINALPROJECT_APPS_SCREAMYBALL_H_
 #define FINALPROJECT_APPS_SCREAMYBALL_H_
 
+#include <cinder/DataSource.h>
 #include <cinder/Timer.h>
 #include <cinder/app/App.h>
-#include <cinder/audio/Voice.h>
+#include <cinder/audio/GainNode.h>
+#include <cinder/audio/InputNode.h>
+#include <cinder/gl/Batch.h>
+#include <cinder/gl/Fbo.h>
+#include <cinder/gl/Texture.h>
 #include <cinder/params/Params.h>
+#include <screamy-ball/asset_pack.h>
+#include <screamy-ball/autoplayer.h>
 #include <screamy-ball/engine.h>
 #include <screamy-ball/leaderboard.h>
+#include <screamy-ball/level.h>
+#include <screamy-ball/particles.h>
 #include <screamy-ball/player.h>
+#include <screamy-ball/profiler.h>
+#include <screamy-ball/quality.h>
+#include <screamy-ball/replay.h>
+#include <screamy-ball/speech_commands.h>
+#include <screamy-ball/task_graph.h>
+#include <screamy-ball/tracer.h>
+#include <screamy-ball/world.h>
 
-#include <sphinx/Recognizer.hpp>
+#include "frame_benchmark.h"
+#include "gpu_timer.h"
+#include "music_node.h"
+#include "scream_node.h"
+#include "speech_node.h"
+#include "speech_recognizer.h"
+#include "voice_node.h"
+
+#include <array>
+#include <map>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace screamyball_app {
 
 using cinder::ColorA;
 using cinder::ivec2;
-using cinder::audio::VoiceRef;
 
 using screamy_ball::Player;
+using screamy_ball::PrettyPrintElapsedTime;
 using std::string;
 
 /**
@@ -37,6 +64,32 @@ enum class GameState {
   kLeaderboard
 };
 
+/**
+ * The phases of a frame that are timed by the profiler.
+ */
+enum class Phase {
+  kUpdate,
+  kEngine,
+  kLeaderboard,
+  kDraw,
+  kPanels,
+  kText,
+  // the GPU's time for the last frame it finished, which overlaps the rest
+  kGpu
+};
+
+/**
+ * How the game is drawn at one of the quality controller's levels.
+ */
+struct QualityLevel {
+  // 0 doesn't multisample
+  int msaa_samples;
+  // the fraction of the window's resolution the game is drawn at
+  float render_scale;
+  // how many segments the ball is drawn with, or -1 to pick from its size
+  int ball_segments;
+};
+
 /**
  * The main class responsible for the graphics and parsing user interactions.
  */
@@ -50,34 +103,105 @@ class ScreamyBall : public cinder::app::App {
   void keyUp(cinder::app::KeyEvent) override;
   void mouseDown(cinder::app::MouseEvent) override;
   void mouseUp(cinder::app::MouseEvent) override;
+  void cleanup() override;
 
  private:
   struct Audio {
-    VoiceRef audio_obj_;
+    // decoded ahead on the startup pool, until the node takes it over
+    std::unique_ptr<screamy_ball::MusicStreamer> streamer_;
+    MusicNodeRef node_;
+    cinder::audio::GainNodeRef gain_;
     const string asset_name_;
     explicit Audio(string asset_name):
         asset_name_(std::move(asset_name)) {}
   };
 
+  // a rendered line of text, kept so it isn't rendered again every frame
+  struct CachedText {
+    float font_size_;
+    ColorA color_;
+    ivec2 size_;
+    cinder::gl::TextureRef texture_;
+  };
+
+  // what a static screen was drawn from, so it's only drawn again once one
+  // of these changes
+  struct ScreenKey {
+    GameState state_;
+    ivec2 size_;
+    ivec2 position_;
+    size_t revision_;
+    bool operator==(const ScreenKey& other) const;
+  };
+
+  void SetupStartup();
+  void LoadRecognizer(const cinder::fs::path& acoustic_model_path,
+                      const cinder::fs::path& dict_path, unsigned sample_rate);
   void SetupRecognizer();
   void SetupMainMenuUi();
   void SetupInGameUi();
   void SetupGeneralUi();
+  void LoadInitialLeaderboards(const string& db_path,
+                               const Player& current_player);
   void SetupInitialLeaderboards();
+  void LoadMusic(Audio& audio, const cinder::fs::path& asset_path,
+                 size_t sample_rate);
   void SetupMusic(Audio& audio);
+  void LoadScream(const cinder::fs::path& asset_path, size_t sample_rate);
+  void SetupScream();
+  void SetupVoiceControl();
+  void SetupMicrophone();
+  void SetupTracing();
+  void SetupReplay();
+  void SetupParticles();
+  void SetupGpuTimer();
+  void SetupLevel();
+  void SetupProfileGlyphs();
+  void MapAssetPack(const string& pack_path);
+  const screamy_ball::PackedAsset* FindPacked(
+      const cinder::fs::path& asset_path) const;
+  cinder::DataSourceRef OpenAsset(const cinder::fs::path& asset_path) const;
+  void SetupHelp(const cinder::fs::path& help_path);
+  void LogStartup();
 
+  void StartGame();
+  void ShowLeaderboard();
+  void PlayReplay();
+  void RecordFrame();
+  void FinishReplay();
   void PopulateLeaderboards();
+  void FormatTopPlayerRows();
   void RunEngine();
+  void Autoplay();
   void Mute();
+  void ApplyVolume();
+  void Scream();
+  void MoveParticles();
+  void EmitParticles(screamy_ball::BallState last_state);
+  void TrackWorld();
+  void ResetWorld();
+  bool IsIdle() const;
+  void ThrottleIdle();
+  void AdaptQuality();
+  const QualityLevel& Quality() const;
 
   template <typename C>
   void PrintText(const string& text, float font_size, const C& text_color,
                  const ivec2& size, const cinder::vec2& loc);
+  void ShowPanels();
+  void DrawStaticScreen();
+  void DrawScreen();
+  void DrawScene();
+  void InvalidateScreen();
   void DrawMainMenu();
   void DrawHelp();
   void DrawBackground();
   void DrawBall();
+  void DrawParallaxLayer(float spacing, float parallax, float width,
+                         float top, float bottom);
   void DrawObstacles();
+  void DrawObstacle(const screamy_ball::WorldObstacle& obstacle);
+  void DrawParticles();
   void DrawGameOver();
   void DrawLeaderboard();
   void DrawTopPlayerScores(size_t& start_row, const cinder::Color& color,
@@ -85,12 +209,19 @@ class ScreamyBall : public cinder::app::App {
   void DrawCurrentPlayerScores(size_t& start_row, const cinder::Color& color,
                                const ivec2& size, const ivec2& pos);
   void DrawConfirmReset();
+  void DrawProfile();
+  void DrawProfileLine(const char* line, float top);
 
-  void RecognizeCommands(const std::string& message);
+  void ListenForCommands();
+  void RecognizeCommands(screamy_ball::SpeechCommand command);
+  void ApplyVoiceCommands();
   void ParseUserInteraction(int event_code);
   bool IsInGameInteraction(int event_code);
 
   void ResetGame();
+  void CheckFrameAllocations();
+  bool IsLeaderboardReady() const;
+  size_t PhaseIndex(Phase phase) const;
 
  private:
   const size_t kTileSize;
@@ -101,35 +232,132 @@ class ScreamyBall : public cinder::app::App {
   const size_t kLeaderboardLimit;
   const float kLocMultiplier;
   const float kDefaultVolume;
+  const float kMusicCrossfadeSecs;
+  const size_t kScreamVoices;
   const ivec2 kUiDimensions;
   const string kPlayerName;
+  const bool kAutoplay;
+  const bool kCountAllocations;
+  const size_t kWarmupFrames;
+  const size_t kTextCacheLimit;
+  const float kProfileGraphSecs;
+  const string kReplayPath;
+  const string kBenchmarkPath;
+  const bool kVoiceControl;
+  const float kFrameRate;
+  // 0 keeps the full frame rate when idle
+  const float kIdleFrameRate;
+  const bool kAdaptQuality;
+  const size_t kMaxParticles;
 
   bool paused_;
   bool confirmed_reset_;
+  // whether this game's time has been saved to the leaderboard; the scores
+  // shown are read at startup, so they can't tell
+  bool score_saved_;
   double delay_secs_;
   double last_update_secs_;
   string elapsed_time_;
   GameState state_;
   GameState last_state_;
+  // the state whose panels are being shown
+  GameState shown_state_;
+  size_t playing_frames_;
+  size_t frame_start_allocations_;
+  bool show_profile_;
+  // the frame being updated, and the state it was in after the replay's input
+  size_t frame_;
+  GameState frame_state_;
+  size_t next_replay_event_;
+  // how high the next jump goes, which is only lowered by a quieter scream
+  int jump_strength_;
+  bool voice_ducking_;
+  bool is_muted_;
+  bool is_idling_;
+  // bumped whenever something a static screen shows changes
+  size_t screen_revision_;
+  ScreenKey cached_screen_;
+  bool is_screen_cached_;
+  // how many frames in a row the game has been drawn live
+  size_t live_frames_;
+  // the startup tasks whose results are drawn, and what's still loading
+  screamy_ball::TaskGraph::TaskId leaderboard_task_;
+  screamy_ball::TaskGraph::TaskId help_task_;
+  bool has_started_up_;
+  size_t startup_frame_;
+  string loading_text_;
 
   screamy_ball::Engine engine_;
-  screamy_ball::Leaderboard leaderboard_;
+  // the part of the world that's drawn, which follows the engine's scroll,
+  // and the obstacles around it
+  screamy_ball::Camera camera_;
+  screamy_ball::ObstacleChunks obstacle_chunks_;
+  long long tracked_obstacle_x_;
+  // whether the chunks had no room for the engine's obstacle
+  bool is_obstacle_untracked_;
+  // the engine, and the autoplayer's clones of it, take their obstacles
+  // from it, so it's only streamed from the main thread
+  std::unique_ptr<screamy_ball::Level> level_;
+  screamy_ball::Autoplayer autoplayer_;
+  // mapped on the startup pool, before the assets in it are loaded
+  std::unique_ptr<screamy_ball::AssetPack> asset_pack_;
+  // opened and first queried on the startup pool, so they're only used
+  // once the leaderboard is ready
+  std::unique_ptr<screamy_ball::Leaderboard> leaderboard_;
+  std::vector<Player> loaded_top_players_;
+  std::vector<Player> loaded_current_player_top_scores_;
   std::vector<Player> top_players_;
   std::vector<Player> current_player_top_scores_;
+  std::vector<string> top_player_rows_;
+  std::vector<string> help_lines_;
+  std::map<string, CachedText> text_cache_;
 
   cinder::Timer timer_;
+  screamy_ball::FrameProfiler profiler_;
+  // every printable ASCII character, rendered once, so the profile's text
+  // is drawn a glyph at a time without allocating
+  std::array<cinder::gl::TextureRef, 95> profile_glyphs_;
+  float profile_advance_;
+  // the last static screen, which is redrawn from here while it's the same,
+  // and the samples it was drawn with
+  cinder::gl::FboRef screen_fbo_;
+  int screen_samples_;
+  // the live game, drawn at the quality level's resolution and samples
+  cinder::gl::FboRef scene_fbo_;
+  int scene_samples_;
+  // created once there's a GL context; the GPU's last known frame time
+  // stands in while the newest isn't ready
+  std::unique_ptr<GpuTimer> gpu_timer_;
+  double gpu_secs_;
+  screamy_ball::QualityController quality_;
+  // the particles are written out for one instanced draw a frame
+  screamy_ball::ParticleSystem particles_;
+  std::vector<float> particle_instances_;
+  cinder::gl::VboRef particle_vbo_;
+  cinder::gl::BatchRef particle_batch_;
+  std::vector<screamy_ball::ReplayEvent> replay_;
+  FrameBenchmark benchmark_;
   cinder::params::InterfaceGlRef menu_ui_;
   cinder::params::InterfaceGlRef in_game_ui_;
   cinder::params::InterfaceGlRef general_ui_;
   Audio bg_music_;
-  Audio scream_audio_;
-  sphinx::RecognizerRef recognizer_;
+  // the decoded scream, with every channel's frames one after another
+  std::vector<float> scream_samples_;
+  size_t scream_channels_;
+  ScreamNodeRef scream_node_;
+  cinder::audio::GainNodeRef scream_gain_;
+  cinder::audio::InputDeviceNodeRef microphone_;
+  VoiceNodeRef voice_node_;
+  std::shared_ptr<SpeechRecognizer> loaded_recognizer_;
+  std::shared_ptr<SpeechRecognizer> recognizer_;
+  SpeechNodeRef speech_node_;
+  std::vector<screamy_ball::SpeechCommand> spoken_commands_;
+  // declared last, so its pool is joined before the members its tasks load
+  // are destroyed
+  screamy_ball::TaskGraph startup_;
 
 };
 
-const int kNumSeconds = 60;
-string PrettyPrintElapsedTime(double time_secs);
-
 }  // namespace screamyball_app
 
 #endif  // FINALPROJECT_APPS_SCREAMYBALL_H_
@@ -0,0 +1,47 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include "speech_node.h"
+
+#include <utility>
+
+namespace screamyball_app {
+
+/**
+ * Creates the node. Its input is mixed down to mono by Cinder.
+ * @param recognizer the recognizer the speech is passed on to.
+ * @param format the node's format.
+ */
+SpeechNode::SpeechNode(std::shared_ptr<SpeechRecognizer> recognizer,
+                       const Format& format) :
+    Node(Format(format).channels(1)),
+    recognizer_(std::move(recognizer)) {}
+
+/**
+ * Creates the gate once the node knows the context's sample rate and block
+ * size.
+ */
+void SpeechNode::initialize() {
+  gate_.reset(new screamy_ball::SpeechGate(getSampleRate(),
+                                           getFramesPerBlock()));
+}
+
+/**
+ * Passes the microphone's latest samples on to the recognizer if they're
+ * speech, on the audio thread.
+ * @param buffer the node's buffer, which holds the microphone's samples.
+ */
+void SpeechNode::process(cinder::audio::Buffer* buffer) {
+  if (!recognizer_->IsListening()) {
+    if (gate_->IsOpen()) {
+      gate_->Reset();
+    }
+    return;
+  }
+  const size_t count = gate_->Process(buffer->getChannel(0),
+                                      buffer->getNumFrames());
+  if (count > 0) {
+    recognizer_->Write(gate_->Output(), count);
+  }
+}
+
+}  // namespace screamyball_app
@@ -0,0 +1,39 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_SPEECH_NODE_H_
+#define FINALPROJECT_APPS_SPEECH_NODE_H_
+
+#include <cinder/audio/Buffer.h>
+#include <cinder/audio/Node.h>
+#include <screamy-ball/speech_gate.h>
+
+#include "speech_recognizer.h"
+
+#include <memory>
+
+namespace screamyball_app {
+
+/**
+ * An audio node that listens to the microphone, and only passes speech on
+ * to the speech recognizer, through a SpeechGate on the audio thread.
+ * Nothing is passed on while the recognizer isn't listening.
+ */
+class SpeechNode : public cinder::audio::Node {
+ public:
+  explicit SpeechNode(std::shared_ptr<SpeechRecognizer> recognizer,
+                      const Format& format = Format());
+
+ protected:
+  void initialize() override;
+  void process(cinder::audio::Buffer* buffer) override;
+
+ private:
+  std::shared_ptr<SpeechRecognizer> recognizer_;
+  std::unique_ptr<screamy_ball::SpeechGate> gate_;
+};
+
+using SpeechNodeRef = std::shared_ptr<SpeechNode>;
+
+}  // namespace screamyball_app
+
+#endif  // FINALPROJECT_APPS_SPEECH_NODE_H_
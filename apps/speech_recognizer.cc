@@ -0,0 +1,275 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include "speech_recognizer.h"
+
+#include <screamy-ball/tracer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace screamyball_app {
+
+using screamy_ball::SpeechCommand;
+using Clock = std::chrono::steady_clock;
+
+// the acoustic model's sample rate
+const unsigned kModelSampleRate = 16000;
+// how much audio the worker decodes at once, and the ring buffer holds
+const double kChunkSecs = 0.032;
+const double kRingSecs = 2.0;
+// how long the worker waits for more audio before checking again
+const std::chrono::milliseconds kIdleWait(10);
+
+/**
+ * Loads the models. Nothing is decoded until Start() is called.
+ * @param args the recognizer's arguments, as they'd be given on the command
+ * line.
+ * @param sample_rate the rate of the samples that will be written.
+ * @throws std::runtime_error if the models can't be loaded.
+ */
+SpeechRecognizer::SpeechRecognizer(const std::vector<std::string>& args,
+                                   unsigned sample_rate) :
+    kSampleRate(sample_rate),
+    config_(nullptr),
+    decoder_(nullptr),
+    ring_(static_cast<size_t>(kRingSecs * sample_rate)),
+    chunk_(static_cast<size_t>(kChunkSecs * sample_rate)),
+    resampler_(sample_rate, kModelSampleRate, chunk_.size()),
+    resampled_chunk_(resampler_.MaxOutput()),
+    decoded_chunk_(resampler_.MaxOutput()),
+    in_utterance_(false),
+    idle_secs_(0),
+    is_listening_(false),
+    is_running_(false),
+    load_(0) {
+  std::vector<std::string> arg_copies = args;
+  std::vector<char*> argv;
+  for (std::string& arg : arg_copies) {
+    argv.push_back(&arg[0]);
+  }
+  config_ = cmd_ln_parse_r(nullptr, ps_args(), static_cast<int32>(argv.size()),
+                           argv.data(), TRUE);
+  if (config_ != nullptr) {
+    decoder_ = ps_init(config_);
+  }
+  if (decoder_ == nullptr) {
+    cmd_ln_free_r(config_);
+    throw std::runtime_error("Couldn't load the speech recognizer's models");
+  }
+}
+
+SpeechRecognizer::~SpeechRecognizer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_running_ = false;
+  }
+  wake_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  ps_free(decoder_);
+  cmd_ln_free_r(config_);
+}
+
+/**
+ * Starts the worker thread, optionally pinned to a CPU so that it doesn't
+ * compete with the render thread. Pinning is only supported on Linux.
+ * @param cpu the CPU to pin the worker to, or -1 to let it run anywhere.
+ */
+void SpeechRecognizer::Start(int cpu) {
+  is_running_ = true;
+  worker_ = std::thread(&SpeechRecognizer::Run, this);
+
+  if (cpu < 0) {
+    return;
+  }
+#if defined(__linux__)
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  if (pthread_setaffinity_np(worker_.native_handle(), sizeof(cpus),
+                             &cpus) != 0) {
+    std::cerr << "Couldn't pin the speech recognizer to CPU " << cpu
+              << std::endl;
+  }
+#else
+  std::cerr << "Pinning the speech recognizer isn't supported here"
+            << std::endl;
+#endif
+}
+
+/**
+ * Adds speech to be decoded, from the audio thread. It never waits: if the
+ * worker has fallen behind, the samples are dropped.
+ * @param samples the samples.
+ * @param count the number of samples.
+ */
+void SpeechRecognizer::Write(const float* samples, size_t count) {
+  ring_.Write(samples, count);
+}
+
+/**
+ * Starts or stops listening. While it isn't listening, the worker sleeps.
+ * @param is_listening whether voice commands apply.
+ */
+void SpeechRecognizer::SetListening(bool is_listening) {
+  if (is_listening_.exchange(is_listening) == is_listening) {
+    return;
+  }
+  if (is_listening) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_.notify_all();
+  }
+}
+
+/**
+ * Checks if the recognizer is listening, from any thread.
+ * @return true if it's listening.
+ */
+bool SpeechRecognizer::IsListening() const {
+  return is_listening_.load(std::memory_order_relaxed);
+}
+
+/**
+ * Takes the commands recognized since the last call.
+ * @param commands is cleared, and filled with the commands in the order
+ * they were spoken.
+ */
+void SpeechRecognizer::TakeCommands(std::vector<SpeechCommand>* commands) {
+  commands->clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  commands->swap(commands_);
+}
+
+/**
+ * Gets how busy the worker is.
+ * @return the fraction of the last second it spent decoding.
+ */
+double SpeechRecognizer::Load() const {
+  return load_.load(std::memory_order_relaxed);
+}
+
+/**
+ * Gets how much speech was dropped because the worker fell behind.
+ * @return the number of samples.
+ */
+size_t SpeechRecognizer::Dropped() const {
+  return ring_.Dropped();
+}
+
+/**
+ * The worker's loop: it decodes whatever speech is in the ring buffer, and
+ * sleeps while there's none, or while it isn't listening.
+ */
+void SpeechRecognizer::Run() {
+  screamy_ball::Tracer::Get().NameThread("speech");
+  auto second_start = Clock::now();
+  Clock::duration busy(0);
+
+  ps_start_utt(decoder_);
+  while (is_running_) {
+    if (!is_listening_) {
+      EndUtterance();
+      // forget what was said while the game wasn't listening
+      while (ring_.Read(chunk_.data(), chunk_.size()) > 0) {}
+      resampler_.Reset();
+      load_ = 0;
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this]() { return is_listening_ || !is_running_; });
+      second_start = Clock::now();
+      busy = Clock::duration(0);
+      continue;
+    }
+
+    const size_t count = ring_.Read(chunk_.data(), chunk_.size());
+    if (count == 0) {
+      // the gate closed in the middle of an utterance
+      idle_secs_ += std::chrono::duration<double>(kIdleWait).count();
+      if (in_utterance_ && idle_secs_
+          >= screamy_ball::GateParameters().end_utterance_secs) {
+        EndUtterance();
+      }
+      std::this_thread::sleep_for(kIdleWait);
+    } else {
+      idle_secs_ = 0;
+      const auto decode_start = Clock::now();
+      Decode(chunk_.data(), count);
+      busy += Clock::now() - decode_start;
+    }
+
+    const auto now = Clock::now();
+    if (now - second_start >= std::chrono::seconds(1)) {
+      load_ = std::chrono::duration<double>(busy).count()
+          / std::chrono::duration<double>(now - second_start).count();
+      second_start = now;
+      busy = Clock::duration(0);
+    }
+  }
+  ps_end_utt(decoder_);
+}
+
+/**
+ * Decodes a chunk of speech, and triggers a command as soon as the partial
+ * hypothesis is certain, or when the utterance ends. The chunk is resampled
+ * into the worker's buffers, so nothing is allocated.
+ * @param samples the chunk's samples.
+ * @param count the number of samples.
+ */
+void SpeechRecognizer::Decode(const float* samples, size_t count) {
+  screamy_ball::TraceScope trace("decode", "speech");
+  const size_t resampled = resampler_.Process(samples, count,
+                                              resampled_chunk_.data());
+  for (size_t index = 0; index < resampled; index++) {
+    decoded_chunk_[index] = static_cast<int16_t>(
+        std::min(1.0f, std::max(-1.0f, resampled_chunk_[index])) * 32767);
+  }
+
+  ps_process_raw(decoder_, decoded_chunk_.data(), resampled, FALSE, FALSE);
+  const bool in_speech = ps_get_in_speech(decoder_) != 0;
+  if (in_utterance_ && !in_speech) {
+    EndUtterance();
+  } else if (in_speech) {
+    in_utterance_ = true;
+    int32 score;
+    const char* partial = ps_get_hyp(decoder_, &score);
+    Trigger(trigger_.OnPartial(partial != nullptr ? partial : ""));
+  }
+}
+
+/**
+ * Ends the current utterance, triggering its command if a partial
+ * hypothesis didn't already.
+ */
+void SpeechRecognizer::EndUtterance() {
+  if (!in_utterance_) {
+    return;
+  }
+  ps_end_utt(decoder_);
+  int32 score;
+  const char* hypothesis = ps_get_hyp(decoder_, &score);
+  Trigger(trigger_.OnFinal(hypothesis != nullptr ? hypothesis : ""));
+  ps_start_utt(decoder_);
+  in_utterance_ = false;
+}
+
+/**
+ * Hands a command to the main thread.
+ * @param command the command, which is ignored if it's kNone.
+ */
+void SpeechRecognizer::Trigger(SpeechCommand command) {
+  if (command == SpeechCommand::kNone) {
+    return;
+  }
+  screamy_ball::TraceInstant("recognized", "speech");
+  std::lock_guard<std::mutex> lock(mutex_);
+  commands_.push_back(command);
+}
+
+}  // namespace screamyball_app
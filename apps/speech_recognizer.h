@@ -0,0 +1,77 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_SPEECH_RECOGNIZER_H_
+#define FINALPROJECT_APPS_SPEECH_RECOGNIZER_H_
+
+#include <pocketsphinx.h>
+#include <screamy-ball/resampler.h>
+#include <screamy-ball/speech_commands.h>
+#include <screamy-ball/speech_gate.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace screamyball_app {
+
+/**
+ * Recognizes spoken commands on a dedicated worker thread with PocketSphinx.
+ * The audio thread writes speech into a lock-free ring buffer, which the
+ * worker decodes; while the game isn't listening, the worker sleeps instead
+ * of decoding. Commands trigger from partial hypotheses, as soon as they are
+ * certain, and are collected by the main thread every frame.
+ */
+class SpeechRecognizer {
+ public:
+  SpeechRecognizer(const std::vector<std::string>& args, unsigned sample_rate);
+  ~SpeechRecognizer();
+  SpeechRecognizer(const SpeechRecognizer&) = delete;
+  SpeechRecognizer& operator=(const SpeechRecognizer&) = delete;
+
+  void Start(int cpu);
+  void Write(const float* samples, size_t count);
+  void SetListening(bool is_listening);
+  bool IsListening() const;
+  void TakeCommands(std::vector<screamy_ball::SpeechCommand>* commands);
+  double Load() const;
+  size_t Dropped() const;
+
+ private:
+  void Run();
+  void Decode(const float* samples, size_t count);
+  void EndUtterance();
+  void Trigger(screamy_ball::SpeechCommand command);
+
+  const unsigned kSampleRate;
+  cmd_ln_t* config_;
+  ps_decoder_t* decoder_;
+  screamy_ball::AudioRing ring_;
+  screamy_ball::CommandTrigger trigger_;
+
+  // the worker's buffers, for a chunk of audio as it's read, resampled to
+  // the model's rate, and decoded
+  std::vector<float> chunk_;
+  screamy_ball::StreamResampler resampler_;
+  std::vector<float> resampled_chunk_;
+  std::vector<int16_t> decoded_chunk_;
+  bool in_utterance_;
+  double idle_secs_;
+
+  std::atomic<bool> is_listening_;
+  std::atomic<bool> is_running_;
+  // the fraction of the last second the worker spent decoding
+  std::atomic<double> load_;
+  // guards the commands and wakes the worker, but never the audio thread
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::vector<screamy_ball::SpeechCommand> commands_;
+  std::thread worker_;
+};
+
+}  // namespace screamyball_app
+
+#endif  // FINALPROJECT_APPS_SPEECH_RECOGNIZER_H_
@@ -0,0 +1,55 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include "voice_node.h"
+
+namespace screamyball_app {
+
+using screamy_ball::VoiceCommand;
+using screamy_ball::VoiceEvent;
+
+/**
+ * Creates the node. Its input is mixed down to mono by Cinder.
+ * @param format the node's format.
+ */
+VoiceNode::VoiceNode(const Format& format) :
+    Node(Format(format).channels(1)),
+    jump_strength_(0),
+    is_ducking_(false) {}
+
+/**
+ * Creates the analyzer once the node knows the context's sample rate.
+ */
+void VoiceNode::initialize() {
+  analyzer_.reset(new screamy_ball::VoiceAnalyzer(getSampleRate()));
+}
+
+/**
+ * Takes the last jump the player screamed, so it's only jumped once.
+ * @return the jump's strength, from 50 to 100, or 0 if there wasn't one.
+ */
+int VoiceNode::TakeJump() {
+  return jump_strength_.exchange(0, std::memory_order_acquire);
+}
+
+/**
+ * Checks if the player is humming the ball down.
+ * @return true if the ball should duck.
+ */
+bool VoiceNode::IsDucking() const {
+  return is_ducking_.load(std::memory_order_acquire);
+}
+
+/**
+ * Analyzes the microphone's latest samples, on the audio thread.
+ * @param buffer the node's buffer, which holds the microphone's samples.
+ */
+void VoiceNode::process(cinder::audio::Buffer* buffer) {
+  const VoiceEvent event = analyzer_->Process(buffer->getChannel(0),
+                                              buffer->getNumFrames());
+  if (event.command == VoiceCommand::kJump) {
+    jump_strength_.store(event.strength, std::memory_order_release);
+  }
+  is_ducking_.store(analyzer_->IsDucking(), std::memory_order_release);
+}
+
+}  // namespace screamyball_app
@@ -0,0 +1,42 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_VOICE_NODE_H_
+#define FINALPROJECT_APPS_VOICE_NODE_H_
+
+#include <cinder/audio/Buffer.h>
+#include <cinder/audio/Node.h>
+#include <screamy-ball/voice_control.h>
+
+#include <atomic>
+#include <memory>
+
+namespace screamyball_app {
+
+/**
+ * An audio node that listens to the microphone, and turns screams and low
+ * hums into jumps and ducks with a VoiceAnalyzer on the audio thread. The
+ * commands are handed to the main thread through atomics, so neither thread
+ * ever waits for the other.
+ */
+class VoiceNode : public cinder::audio::Node {
+ public:
+  explicit VoiceNode(const Format& format = Format());
+  int TakeJump();
+  bool IsDucking() const;
+
+ protected:
+  void initialize() override;
+  void process(cinder::audio::Buffer* buffer) override;
+
+ private:
+  std::unique_ptr<screamy_ball::VoiceAnalyzer> analyzer_;
+  // the strength of the last jump that hasn't been taken, or 0
+  std::atomic<int> jump_strength_;
+  std::atomic<bool> is_ducking_;
+};
+
+using VoiceNodeRef = std::shared_ptr<VoiceNode>;
+
+}  // namespace screamyball_app
+
+#endif  // FINALPROJECT_APPS_VOICE_NODE_H_
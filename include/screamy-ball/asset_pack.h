@@ -0,0 +1,86 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_ASSET_PACK_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_ASSET_PACK_H_
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace screamy_ball {
+
+// every asset in a pack starts on a page boundary, so its pages are only
+// read when it's used, and can be shared by every process that maps the pack
+const size_t kPackAlignment = 4096;
+
+/**
+ * An asset in a pack: either a file's bytes, or audio that was decoded ahead
+ * of time. Decoded audio is stored as float samples, with every channel's
+ * frames one after another, the way Cinder's audio buffers store them.
+ */
+struct PackedAsset {
+  const char* data;
+  size_t size;
+  bool is_pcm;
+  unsigned sample_rate;
+  unsigned channels;
+
+  size_t Frames() const;
+  const float* Samples(size_t channel) const;
+};
+
+/**
+ * Builds an asset pack: a header, every asset on its own pages, and an index
+ * of the assets' names at the end.
+ */
+class AssetPackWriter {
+ public:
+  void AddFile(const std::string& name, std::string bytes);
+  void AddPcm(const std::string& name, const std::vector<float>& samples,
+              unsigned sample_rate, unsigned channels);
+  void Write(std::ostream& output) const;
+
+ private:
+  struct Entry {
+    std::string name;
+    std::string bytes;
+    bool is_pcm;
+    unsigned sample_rate;
+    unsigned channels;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+/**
+ * A memory-mapped asset pack. Its assets are handed out as views into the
+ * mapping, so nothing is copied until it's used, and the pages are shared
+ * by every game that has the same pack open.
+ */
+class AssetPack {
+ public:
+  explicit AssetPack(const std::string& path);
+  ~AssetPack();
+  AssetPack(const AssetPack&) = delete;
+  AssetPack& operator=(const AssetPack&) = delete;
+
+  const PackedAsset* Find(const std::string& name) const;
+  std::vector<std::string> Names() const;
+  size_t Size() const;
+
+ private:
+  void ReadIndex();
+  void Unmap();
+
+  const char* data_;
+  size_t size_;
+  // only used where the pack can't be mapped, and is read into memory instead
+  std::vector<char> copy_;
+  std::map<std::string, PackedAsset> assets_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_ASSET_PACK_H_
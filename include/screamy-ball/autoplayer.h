@@ -0,0 +1,45 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_AUTOPLAYER_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_AUTOPLAYER_H_
+
+#include "engine.h"
+
+#include <cstddef>
+
+namespace screamy_ball {
+
+/**
+ * Represents the inputs a player can give the ball on any given tick.
+ */
+enum class Action { kRoll, kJump, kDuck };
+
+/**
+ * A bot that plays the game by searching over the possible actions. It clones
+ * the Engine and simulates every action for a bounded number of ticks, then
+ * picks the action that survives the longest. It can play both an Engine and
+ * a DefaultEngine.
+ */
+class Autoplayer {
+ public:
+  explicit Autoplayer(size_t lookahead);
+  template <typename E>
+  Action Decide(const E& engine);
+  template <typename E>
+  static bool Apply(E* engine, Action action);
+
+  size_t Decisions() const;
+
+ private:
+  template <typename E>
+  size_t Survive(const E& engine, size_t depth);
+
+  const size_t kLookahead;
+  const size_t kNodeBudget;
+  size_t nodes_left_;
+  size_t decisions_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_AUTOPLAYER_H_
@@ -5,6 +5,7 @@
 #ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_BALL_H_
 #define FINALPROJECT_INCLUDE_SCREAMY_BALL_BALL_H_
 
+#include "geometry.h"
 #include "location.h"
 
 namespace screamy_ball {
@@ -22,8 +23,16 @@ enum class BallState {
  * Represents the ball, which is controlled by the user.
  */
 struct Ball {
-  Ball(const Location& location) : location(location) {}
+  Ball(const Location& location) :
+      location(location),
+      y(location.Col() * kSubTiles),
+      velocity(0) {}
+  // the tile the ball is in, rounded towards the ground
   Location location;
+  // the height of the ball's bottom, in sub-tiles
+  int y;
+  // how fast the ball is rising, in sub-tiles per tick
+  int velocity;
   // theoretically, I could just convert this to a single Location object
   // instead of having a Ball struct, but that isn't expandable: what if I
   // wanted to add more properties to the ball?
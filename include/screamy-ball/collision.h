@@ -0,0 +1,60 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_COLLISION_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_COLLISION_H_
+
+#include <cstddef>
+
+namespace screamy_ball {
+
+/**
+ * An axis-aligned ellipse, in tiles. The ball is a circle when it rolls or
+ * jumps, and a flat ellipse when it ducks.
+ */
+struct Ellipse {
+  float center_x;
+  float center_y;
+  float radius_x;
+  float radius_y;
+};
+
+/**
+ * A triangle, in tiles. Each spike is one triangle.
+ */
+struct Triangle {
+  float ax, ay;
+  float bx, by;
+  float cx, cy;
+};
+
+/**
+ * A batch of triangles, stored as a structure of arrays so that several of
+ * them can be tested at once with SIMD instructions.
+ */
+class TriangleBatch {
+ public:
+  static const size_t kCapacity = 64;
+
+  TriangleBatch();
+  bool Add(const Triangle& triangle);
+  size_t Size() const;
+  void Clear();
+
+ private:
+  friend bool Intersects(const Ellipse& ellipse, const TriangleBatch& batch);
+
+  size_t size_;
+  alignas(16) float ax_[kCapacity];
+  alignas(16) float ay_[kCapacity];
+  alignas(16) float bx_[kCapacity];
+  alignas(16) float by_[kCapacity];
+  alignas(16) float cx_[kCapacity];
+  alignas(16) float cy_[kCapacity];
+};
+
+bool Intersects(const Ellipse& ellipse, const Triangle& triangle);
+bool Intersects(const Ellipse& ellipse, const TriangleBatch& batch);
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_COLLISION_H_
@@ -4,22 +4,38 @@
 #define FINALPROJECT_INCLUDE_SCREAMY_BALL_ENGINE_H_
 
 #include "ball.h"
+#include "collision.h"
+#include "geometry.h"
 #include "obstacle.h"
-
-#include <random>
+#include "obstacle_source.h"
 
 namespace screamy_ball {
-using std::mt19937;
 
 /**
  * Represents the Game's Engine, responsible for moving the ball and
- * tracking the ball's and the obstacle's locations.
+ * tracking the ball's and the obstacle's locations. Positions are kept in
+ * fixed-point sub-tiles, so the obstacles can speed up smoothly over a run
+ * while the tick rate stays the same, and the ball's jump follows gravity.
+ * Setting a Location from the outside moves the entity to that tile.
+ * The board is a window onto a longer world, which scrolls past the ball at
+ * the obstacles' speed, so the obstacle's board position is also a world
+ * position. Obstacles come from an ObstacleSource, such as a Level, and
+ * are generated randomly once it runs out, or if there isn't one.
+ * @tparam Geometry the board's geometry and the game's parameters: either a
+ * RuntimeGeometry, or a FixedGeometry whose values are compile-time constants.
+ * The library is built with RuntimeGeometry and DefaultGeometry.
  */
-class Engine {
+template <typename Geometry>
+class BasicEngine {
  public:
-  Engine(const Location& ball_loc, int  width, int height);
+  BasicEngine(const Location& ball_loc, const Geometry& geometry,
+              unsigned seed);
   void Run();
   void Reset();
+  void SetJumpStrength(int percent);
+  void SetObstacleSource(const ObstacleSource* source);
+  long long Scroll() const;
+  long long ObstacleWorldX() const;
 
   const int kMaxHeight;
   const int kMinHeight;
@@ -28,19 +44,48 @@ class Engine {
   Ball ball_;
 
  private:
+  void SyncPositions();
   void Jump();
   void CreateObstacle();
-  static ObstacleType GetObstacleType(mt19937 rng);
-  Location GetObstacleLocation();
-  int GetObstacleLength(mt19937 rng);
+  int ObstacleSpeed() const;
+  void NextObstacle();
+  Ellipse BallShape() const;
+  Triangle SpikeShape(int index) const;
   bool HasCollided();
 
-  const int kWindowWidth;
-  const int kWindowHeight;
-  bool reached_max_height_;
+  const Geometry kGeometry;
+  // the number of ticks since the start of the run, which sets the speed
+  int ticks_;
+  // the world position of the board's left edge, in sub-tiles
+  long long scroll_;
+  // how high the next jump goes, and how high the current one goes, as
+  // percentages of JumpHeight()
+  int jump_strength_;
+  int launch_strength_;
+  // the source isn't owned, and is shared with every copy of the Engine
+  const ObstacleSource* source_;
+  RandomObstacles random_obstacles_;
+  // kept as a member so that a seeded Engine, and any copy of it, always
+  // gets the same sequence of obstacles
+  ObstacleCursor cursor_;
+};
 
+/**
+ * The Engine used by the app, whose board size and parameters are read at
+ * runtime.
+ */
+class Engine : public BasicEngine<RuntimeGeometry> {
+ public:
+  Engine(const Location& ball_loc, int  width, int height);
+  Engine(const Location& ball_loc, int width, int height, unsigned seed,
+         const EngineParameters& parameters = EngineParameters());
 };
 
+/**
+ * An Engine for the default 16x16 board, specialized at compile time.
+ */
+using DefaultEngine = BasicEngine<DefaultGeometry>;
+
 }
 
 #endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_ENGINE_H_
@@ -0,0 +1,100 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_GEOMETRY_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_GEOMETRY_H_
+
+namespace screamy_ball {
+
+/**
+ * The number of fixed-point units in one tile. Positions and velocities are
+ * stored in these units, so things can move by a fraction of a tile per tick.
+ * 240 is divisible by 1, 3, 6, 10 and 15, so jumps that take up to 5 ticks
+ * to reach their apex land exactly on it.
+ */
+const int kSubTiles = 240;
+
+/**
+ * The tunable parameters of the game. The defaults are the values the game
+ * is normally played with.
+ */
+struct EngineParameters {
+  // the number of tiles the ball rises before it falls back down
+  int jump_height = 5;
+  // the number of ticks the ball takes to rise to the top of its jump
+  int jump_ticks = 5;
+  // the number of tiles a spike sticks out by
+  int obstacle_height = 2;
+  // the range of the number of spikes in an obstacle
+  int min_obstacle_length = 2;
+  int max_obstacle_length = 4;
+  // the number of ticks it takes obstacles to speed up by one tile per tick,
+  // or 0 if they should always move one tile per tick
+  int ramp_ticks = 1200;
+  // the fastest obstacles can move, in tiles per tick
+  int max_speed = 2;
+};
+
+/**
+ * The board's geometry and the game's parameters, read at runtime. This is
+ * what the app uses, since the board's size comes from the command line.
+ */
+class RuntimeGeometry {
+ public:
+  RuntimeGeometry(int width, int height, int ground,
+                  const EngineParameters& parameters) :
+      width_(width),
+      height_(height),
+      ground_(ground),
+      parameters_(parameters) {}
+
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+  int Ground() const { return ground_; }
+  int JumpHeight() const { return parameters_.jump_height; }
+  int JumpTicks() const { return parameters_.jump_ticks; }
+  int ObstacleHeight() const { return parameters_.obstacle_height; }
+  int MinObstacleLength() const { return parameters_.min_obstacle_length; }
+  int MaxObstacleLength() const { return parameters_.max_obstacle_length; }
+  int RampTicks() const { return parameters_.ramp_ticks; }
+  int MaxSpeed() const { return parameters_.max_speed; }
+
+ private:
+  int width_;
+  int height_;
+  int ground_;
+  EngineParameters parameters_;
+};
+
+/**
+ * The board's geometry and the game's parameters, fixed at compile time, so
+ * that the compiler can fold every range check in the Engine. The ground is
+ * two tiles above the bottom of the board, like in the app.
+ */
+template <int kWidth, int kHeight, int kJumpHeight = 5, int kObstacleHeight = 2,
+          int kMinObstacleLength = 2, int kMaxObstacleLength = 4,
+          int kJumpTicks = 5, int kRampTicks = 1200, int kMaxSpeed = 2>
+struct FixedGeometry {
+  static_assert(kMinObstacleLength <= kMaxObstacleLength,
+                "the obstacle lengths must form a range");
+  static_assert(kJumpHeight < kHeight - 2, "the ball can't jump off the board");
+
+  static constexpr int Width() { return kWidth; }
+  static constexpr int Height() { return kHeight; }
+  static constexpr int Ground() { return kHeight - 2; }
+  static constexpr int JumpHeight() { return kJumpHeight; }
+  static constexpr int JumpTicks() { return kJumpTicks; }
+  static constexpr int ObstacleHeight() { return kObstacleHeight; }
+  static constexpr int MinObstacleLength() { return kMinObstacleLength; }
+  static constexpr int MaxObstacleLength() { return kMaxObstacleLength; }
+  static constexpr int RampTicks() { return kRampTicks; }
+  static constexpr int MaxSpeed() { return kMaxSpeed; }
+};
+
+/**
+ * The default 16x16 board.
+ */
+using DefaultGeometry = FixedGeometry<16, 16>;
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_GEOMETRY_H_
@@ -20,6 +20,7 @@ class Leaderboard {
  public:
   explicit Leaderboard(const std::string& db_path);
   void AddScoreToLeaderboard(const Player& player);
+  void AddScoresToLeaderboard(const std::vector<Player>& players);
 
   std::vector<Player> RetrieveHighScores(const size_t limit);
   std::vector<Player> RetrieveHighScores(const Player&, const size_t limit);
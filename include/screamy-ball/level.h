@@ -0,0 +1,85 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_LEVEL_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_LEVEL_H_
+
+#include "obstacle_source.h"
+#include "world.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * Builds a level file: a header, every chunk's obstacles packed one after
+ * another, and an index with a fixed-size entry for every chunk at the end.
+ */
+class LevelWriter {
+ public:
+  explicit LevelWriter(int chunk_tiles);
+  void Add(const WorldObstacle& obstacle);
+  void Write(std::ostream& output) const;
+  size_t Size() const;
+
+ private:
+  const int kChunkTiles;
+  std::vector<WorldObstacle> obstacles_;
+};
+
+/**
+ * A designer-authored course, memory-mapped from a level file. Obstacles
+ * are read straight from the mapping, and only the chunks around the camera
+ * are kept in memory: Stream() reads the chunks ahead in before they're
+ * needed, and lets the ones behind go, so a level of any length takes the
+ * same memory. The index is a few bytes a chunk, and stays mapped.
+ */
+class Level : public ObstacleSource {
+ public:
+  // how many chunks ahead of the camera are read in, and how many behind it
+  // are kept, in case a clone of the Engine still needs them
+  static const long long kChunksAhead = 2;
+  static const long long kChunksBehind = 1;
+
+  explicit Level(const std::string& path);
+  ~Level() override;
+  Level(const Level&) = delete;
+  Level& operator=(const Level&) = delete;
+
+  bool Next(long long earliest_x, ObstacleCursor* cursor,
+            WorldObstacle* obstacle) const override;
+  WorldObstacle At(size_t index) const;
+  void Stream(long long camera_x);
+
+  int ChunkTiles() const;
+  long long Chunks() const;
+  size_t Size() const;
+  int LongestObstacle() const;
+  long long FirstResidentChunk() const;
+  long long EndResidentChunk() const;
+
+ private:
+  void ReadIndex();
+  void Unmap();
+  long long ChunkOfIndex(size_t index) const;
+  void Advise(long long first_chunk, long long end_chunk, bool will_need);
+
+  const char* data_;
+  size_t size_;
+  // only used where the level can't be mapped, and is read into memory
+  std::vector<char> copy_;
+  size_t page_size_;
+  int chunk_tiles_;
+  long long chunks_;
+  size_t obstacles_;
+  int longest_;
+  const char* index_;
+  long long first_resident_;
+  long long end_resident_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_LEVEL_H_
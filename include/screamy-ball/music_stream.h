@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_MUSIC_STREAM_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_MUSIC_STREAM_H_
+
+#include "speech_gate.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * A decoder for a MusicStreamer, which reads a track's frames in order and
+ * can jump back to any of them.
+ */
+class MusicSource {
+ public:
+  virtual ~MusicSource() = default;
+  virtual size_t Channels() const = 0;
+  virtual size_t Frames() const = 0;
+
+  /**
+   * Decodes the next frames, with their channels interleaved.
+   * @param samples where the frames are decoded to.
+   * @param frames the most frames to decode.
+   * @return the number of frames decoded, which is only 0 at the end.
+   */
+  virtual size_t Read(float* samples, size_t frames) = 0;
+
+  /**
+   * Moves to a frame, which the next Read() starts from.
+   * @param frame the frame.
+   */
+  virtual void Seek(size_t frame) = 0;
+};
+
+/**
+ * Where a track loops, in frames. The track plays from its start to `end`,
+ * and then from `start` to `end` forever. The last `crossfade` frames before
+ * `end` are faded into the first ones after `start`, so the loop is
+ * seamless even when the track isn't.
+ */
+struct LoopPoints {
+  size_t start = 0;
+  // 0 is the end of the track
+  size_t end = 0;
+  size_t crossfade = 0;
+};
+
+/**
+ * Streams a looping track: a worker thread decodes ahead into a lock-free
+ * ring buffer, and the audio callback plays from it. Memory stays the same
+ * however long the track is, and the loop is stitched by the decoder, so
+ * nothing has to restart the track.
+ */
+class MusicStreamer {
+ public:
+  MusicStreamer(std::unique_ptr<MusicSource> source, unsigned sample_rate,
+                const LoopPoints& loop = LoopPoints(),
+                float buffer_secs = 0.5f);
+  ~MusicStreamer();
+  MusicStreamer(const MusicStreamer&) = delete;
+  MusicStreamer& operator=(const MusicStreamer&) = delete;
+
+  void Start();
+  size_t Fill();
+  void Mix(float* output, size_t channels, size_t frames);
+
+  size_t Channels() const;
+  size_t Loops() const;
+  size_t Underruns() const;
+
+ private:
+  void RunWorker();
+  size_t Decode(float* samples, size_t frames);
+  void Crossfade(float* samples, size_t frames) const;
+
+  const std::unique_ptr<MusicSource> source_;
+  const size_t kChannels;
+  const size_t kLoopStart;
+  const size_t kLoopEnd;
+  const size_t kCrossfade;
+  const float kRefillSecs;
+
+  // only used by the thread that decodes
+  std::vector<float> head_;
+  std::vector<float> decoded_;
+  size_t position_;
+  bool is_primed_;
+
+  AudioRing ring_;
+  // only used by the thread that mixes
+  std::vector<float> mixed_;
+
+  std::atomic<size_t> loops_;
+  // the number of frames that were silent because the ring was empty
+  std::atomic<size_t> underruns_;
+
+  std::mutex mutex_;
+  std::condition_variable stopping_;
+  bool is_stopping_;
+  std::thread worker_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_MUSIC_STREAM_H_
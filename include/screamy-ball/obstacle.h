@@ -3,6 +3,7 @@
 #ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_OBSTACLE_H_
 #define FINALPROJECT_INCLUDE_SCREAMY_BALL_OBSTACLE_H_
 
+#include "geometry.h"
 #include "location.h"
 
 namespace screamy_ball {
@@ -22,15 +23,26 @@ struct Obstacle {
   const int kMaxLength;
   ObstacleType type;
   int length;
+  // the tile the obstacle is in, rounded towards the ball
   Location location;
+  // the obstacle's horizontal position, in sub-tiles
+  int x;
+  // how fast the obstacle moves towards the ball, in sub-tiles per tick
+  int velocity;
 
   Obstacle(ObstacleType type, const Location& location):
-      kMinLength(2),
-      kMaxLength(4),
-      kHeight(2),
+      Obstacle(type, location, 2, 2, 4) {}
+
+  Obstacle(ObstacleType type, const Location& location, int height,
+           int min_length, int max_length):
+      kHeight(height),
+      kMinLength(min_length),
+      kMaxLength(max_length),
       type(type),
+      length(1),
       location(location),
-      length(1) {}
+      x(location.Row() * kSubTiles),
+      velocity(kSubTiles) {}
 
 };
 
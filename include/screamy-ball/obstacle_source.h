@@ -0,0 +1,65 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_OBSTACLE_SOURCE_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_OBSTACLE_SOURCE_H_
+
+#include "world.h"
+
+#include <cstddef>
+#include <random>
+
+namespace screamy_ball {
+
+/**
+ * How far an Engine has got through its obstacles. It's kept by the Engine,
+ * rather than by the source, so that a cloned Engine carries on from the
+ * same place without touching the original's obstacles.
+ */
+struct ObstacleCursor {
+  // the number of obstacles taken from the source so far
+  size_t index;
+  // minstd_rand is used over mt19937 since it's much cheaper to copy when
+  // the Engine is cloned
+  std::minstd_rand rng;
+};
+
+/**
+ * Where an Engine's obstacles come from. Sources are only read, so one can
+ * be shared by every Engine and clone that plays it, from any thread.
+ */
+class ObstacleSource {
+ public:
+  virtual ~ObstacleSource() = default;
+
+  /**
+   * Gets the next obstacle.
+   * @param earliest_x the first world position the obstacle can be at, in
+   * sub-tiles, which is the right edge of the board, or further once
+   * obstacles are fast.
+   * @param cursor how far the Engine has got, which is moved past the
+   * obstacle.
+   * @param obstacle set to the obstacle.
+   * @return false if the source has run out of obstacles.
+   */
+  virtual bool Next(long long earliest_x, ObstacleCursor* cursor,
+                    WorldObstacle* obstacle) const = 0;
+};
+
+/**
+ * Obstacles of a random type and length, each as soon as there's room for
+ * it. A seeded cursor always gets the same obstacles.
+ */
+class RandomObstacles : public ObstacleSource {
+ public:
+  RandomObstacles(int min_length, int max_length);
+  bool Next(long long earliest_x, ObstacleCursor* cursor,
+            WorldObstacle* obstacle) const override;
+
+ private:
+  int min_length_;
+  int max_length_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_OBSTACLE_SOURCE_H_
@@ -0,0 +1,75 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_PARTICLES_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_PARTICLES_H_
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * A burst of particles, thrown out from one point. Positions are in tiles,
+ * with y growing downwards like the board's, and times are in seconds.
+ */
+struct Burst {
+  float x;
+  float y;
+  size_t count;
+  float min_speed;
+  float max_speed;
+  // the direction the particles are thrown in, in radians from the x axis,
+  // and how far either side of it they can go
+  float angle;
+  float spread;
+  float life_secs;
+  float gravity;
+  // which look the renderer gives the particles
+  unsigned kind;
+};
+
+/**
+ * A fixed pool of particles, stored as a structure of arrays so they're
+ * moved four at a time with SSE2 when it's available. Nothing is allocated
+ * after construction. When the pool fills up, bursts are thinned out instead
+ * of being cut off, so a busy screen still gets some of every burst.
+ */
+class ParticleSystem {
+ public:
+  // each particle is drawn from its x, y, the fraction of its life it has
+  // left, and its kind
+  static const size_t kInstanceFloats = 4;
+
+  ParticleSystem(size_t capacity, unsigned seed);
+  size_t Emit(const Burst& burst);
+  void Update(float secs);
+  void Clear();
+  size_t WriteInstances(float* instances) const;
+
+  size_t Size() const;
+  size_t Capacity() const;
+  size_t Dropped() const;
+
+ private:
+  const size_t kCapacity;
+  // the arrays are padded to a multiple of four, so SIMD never needs a
+  // remainder loop
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> velocity_x_;
+  std::vector<float> velocity_y_;
+  std::vector<float> gravity_;
+  // the seconds each particle has left, and 1 / the seconds it started with
+  std::vector<float> life_;
+  std::vector<float> inverse_life_;
+  std::vector<float> kind_;
+  size_t size_;
+  // the particles that were asked for, but weren't emitted
+  size_t dropped_;
+  std::minstd_rand rng_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_PARTICLES_H_
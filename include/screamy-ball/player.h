@@ -20,6 +20,8 @@ struct Player {
   std::string elapsed_time;
 };
 
+std::string PrettyPrintElapsedTime(double time_secs);
+
 }  // namespace screamy_ball
 
 #endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_PLAYER_H_
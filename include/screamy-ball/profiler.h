@@ -0,0 +1,64 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_PROFILER_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace screamy_ball {
+
+/**
+ * Records how long each phase of a frame takes, for the last kFrames frames.
+ * The samples are kept in a fixed ring buffer, so recording them never
+ * allocates or locks: one thread records, and the number of finished frames
+ * is published atomically so that the frames before it can be read.
+ * A phase can be timed several times in one frame, and its times add up.
+ */
+class FrameProfiler {
+ public:
+  static const size_t kMaxPhases = 8;
+  static const size_t kFrames = 256;
+  // the index of the whole frame's time, used in place of a phase
+  static const size_t kFrame = kMaxPhases;
+
+  FrameProfiler();
+  void BeginFrame();
+  void AddTime(size_t phase, std::chrono::steady_clock::duration time);
+
+  size_t Frames() const;
+  double Secs(size_t phase, size_t frames_ago) const;
+  double Percentile(size_t phase, double fraction) const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // the time of each phase, and of the whole frame, in seconds
+  float samples_[kFrames][kMaxPhases + 1];
+  Clock::time_point frame_start_;
+  bool has_started_;
+  // the number of frames that have finished
+  std::atomic<size_t> frames_;
+};
+
+/**
+ * Adds the time between its construction and its destruction to a phase of
+ * the current frame.
+ */
+class ScopedTimer {
+ public:
+  ScopedTimer(FrameProfiler* profiler, size_t phase);
+  ~ScopedTimer();
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  FrameProfiler* profiler_;
+  const size_t kPhase;
+  const std::chrono::steady_clock::time_point kStart;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_PROFILER_H_
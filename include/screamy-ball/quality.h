@@ -0,0 +1,71 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_QUALITY_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_QUALITY_H_
+
+#include <cstddef>
+
+namespace screamy_ball {
+
+/**
+ * Picks a rendering quality level that holds a target frame time. Level 0 is
+ * the best looking, and each level after it is cheaper to draw. The frames
+ * are judged a window at a time:
+ * - If the frames miss the target, the level steps down at once.
+ * - If the work in them takes well under the target, it steps back up, but
+ *   only after several windows in a row have had that much headroom.
+ * - If stepping up misses the target again straight away, the level
+ *   steps back down, and it waits twice as long before trying again.
+ *   This stops it from flickering between two levels.
+ * - Once no window has missed for a long while, that wait is halved again,
+ *   so a brief stall early on doesn't hold the level down for good.
+ *
+ * Whole frames are compared with the target, since a frame that misses
+ * vsync takes twice as long. The work in a frame is what has headroom, since
+ * a vsynced frame never takes less than the target; it's whichever of the
+ * CPU's and the GPU's time is longer, since they work side by side.
+ */
+class QualityController {
+ public:
+  static const size_t kWindowFrames = 60;
+  static const size_t kMaxHoldWindows = 32;
+  static const size_t kSettleWindows = 30;
+
+  QualityController(size_t levels, double target_secs);
+  bool AddFrame(double frame_secs, double work_secs);
+  void Discard();
+  void SetLevel(size_t level);
+
+  size_t Level() const;
+  size_t Levels() const;
+  double TargetSecs() const;
+  // the percentile frame time and work time of the last full window
+  double FrameSecs() const;
+  double WorkSecs() const;
+
+ private:
+  double Percentile(const float* samples) const;
+
+  const size_t kLevels;
+  const double kTargetSecs;
+
+  size_t level_;
+  // the current window's frames
+  float frame_secs_[kWindowFrames];
+  float work_secs_[kWindowFrames];
+  size_t frames_;
+  double last_frame_secs_;
+  double last_work_secs_;
+  // how many windows in a row have had headroom, and how many must have it
+  // before the level steps up
+  size_t headroom_windows_;
+  size_t hold_windows_;
+  // how many windows in a row haven't missed, since the hold last changed
+  size_t settled_windows_;
+  // whether the last step was up, and the window after it hasn't finished
+  bool is_trying_level_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_QUALITY_H_
@@ -0,0 +1,25 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_REPLAY_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_REPLAY_H_
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * An input to give the game on a certain frame of a replay.
+ */
+struct ReplayEvent {
+  size_t frame;
+  std::string action;
+};
+
+std::vector<ReplayEvent> ParseReplay(std::istream& input);
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_REPLAY_H_
@@ -0,0 +1,42 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_RESAMPLER_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_RESAMPLER_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * Changes the sample rate of a stream of mono audio, a chunk at a time, so
+ * the microphone can be resampled as it's heard. Going down in rate, the
+ * audio is low-pass filtered first, so that what's too high for the new
+ * rate doesn't alias down into the speech; then it's interpolated linearly.
+ * Everything is allocated up front, and the filter and the interpolation
+ * carry on across chunks, so the chunks can be any size up to the maximum.
+ */
+class StreamResampler {
+ public:
+  StreamResampler(unsigned from_rate, unsigned to_rate, size_t max_chunk);
+  size_t Process(const float* samples, size_t count, float* output);
+  size_t MaxOutput() const;
+  void Reset();
+
+ private:
+  const double kStep;
+  const size_t kMaxChunk;
+  // the low-pass filter's taps, which are just {1} going up in rate
+  std::vector<float> taps_;
+  // the last taps_.size() - 1 samples of the previous chunk, then the chunk
+  std::vector<float> input_;
+  std::vector<float> filtered_;
+  // where the next output sample is, in samples from the chunk's start, and
+  // the filtered sample just before the chunk
+  double position_;
+  float last_filtered_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_RESAMPLER_H_
@@ -0,0 +1,65 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_SAMPLE_PLAYER_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_SAMPLE_PLAYER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * Plays a short clip that's been decoded to PCM up front, from a fixed pool
+ * of voices so that the clip can overlap itself. Triggering the clip from any
+ * thread is lock-free and doesn't allocate; the voices start on the next
+ * call to Mix, which is meant to be made from the audio callback. When every
+ * voice is busy, the one that's been playing the longest is restarted.
+ * Audio is planar: every channel's frames are stored one after another.
+ */
+class SamplePlayer {
+ public:
+  static const size_t kMaxVoices = 16;
+
+  SamplePlayer(std::vector<float> clip, size_t channels, size_t voices);
+  void Trigger();
+  void Mix(float* output, size_t channels, size_t frames);
+
+  size_t ActiveVoices() const;
+  size_t Triggers() const;
+  double MeanLatencySecs() const;
+  double MaxLatencySecs() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Voice {
+    bool is_active;
+    // the next frame of the clip to play
+    size_t position;
+  };
+
+  void StartVoice();
+  static int64_t Now();
+
+  const std::vector<float> kClip;
+  const size_t kChannels;
+  const size_t kFrames;
+  const size_t kVoices;
+  Voice voices_[kMaxVoices];
+
+  // written by Trigger, read by Mix
+  std::atomic<size_t> pending_triggers_;
+  std::atomic<int64_t> last_trigger_ns_;
+
+  // written by Mix: the time from a trigger to its voice starting
+  std::atomic<size_t> started_;
+  std::atomic<int64_t> total_latency_ns_;
+  std::atomic<int64_t> max_latency_ns_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_SAMPLE_PLAYER_H_
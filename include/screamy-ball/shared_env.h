@@ -0,0 +1,174 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_SHARED_ENV_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_SHARED_ENV_H_
+
+#include "autoplayer.h"
+#include "engine.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace screamy_ball {
+
+// the action that restarts an environment's episode instead of stepping it
+const uint8_t kResetAction = 255;
+// why an episode ended, in EnvObservation::done: its ball collided, or it
+// ran out of ticks
+const uint8_t kEpisodeCollided = 1;
+const uint8_t kEpisodeTruncated = 2;
+
+/**
+ * What an environment looks like after a step. This is laid out for other
+ * languages to read straight from the shared file: every field has a fixed
+ * width, and there's no padding.
+ */
+struct EnvObservation {
+  // the batch that wrote the observation
+  uint32_t batch;
+  // the ticks the ball has survived this episode
+  uint32_t episode_ticks;
+  // the bottom of the ball, in sub-tiles from the top of the board
+  int32_t ball_y;
+  // how fast the ball is rising, in sub-tiles per tick
+  int32_t ball_velocity;
+  // the obstacle's first spike's right edge, in sub-tiles from the board's
+  // left edge
+  int32_t obstacle_x;
+  // how fast the obstacle is moving towards the ball, in sub-tiles per tick
+  int32_t obstacle_velocity;
+  // a BallState
+  uint8_t ball_state;
+  // an ObstacleType
+  uint8_t obstacle_type;
+  uint8_t obstacle_length;
+  // kEpisodeCollided if the ball collided on this step, or
+  // kEpisodeTruncated if the episode reached its tick limit, after either of
+  // which the environment was restarted, so the rest of the observation is
+  // the new episode's start; otherwise 0
+  uint8_t done;
+  // 1 for a tick survived, 0 for a collision or a reset
+  float reward;
+};
+
+static_assert(sizeof(EnvObservation) == 32,
+              "EnvObservation is read by other languages, so its layout "
+              "can't change");
+
+/**
+ * The start of the shared file. The file is this header, then a byte of
+ * action for every environment, then a ring of batches of observations,
+ * with every environment's observation in a batch one after another. Each
+ * side's counter is on its own cache line, so the two processes don't
+ * fight over it.
+ */
+struct SharedEnvHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t envs;
+  uint32_t ring;
+  uint32_t observation_size;
+  uint64_t actions_offset;
+  uint64_t observations_offset;
+  int32_t width;
+  int32_t height;
+  // the most ticks an episode lasts before it's truncated
+  uint32_t max_episode_ticks;
+
+  // the last batch the client asked for, and whether the server is asleep
+  // waiting for the next one
+  alignas(64) std::atomic<uint32_t> request;
+  std::atomic<uint32_t> server_waiting;
+  // the last batch the server finished, and whether the client is asleep
+  // waiting for it
+  alignas(64) std::atomic<uint32_t> response;
+  std::atomic<uint32_t> client_waiting;
+  // set once the server has gone
+  alignas(64) std::atomic<uint32_t> closed;
+};
+
+static_assert(offsetof(SharedEnvHeader, request) == 64
+              && offsetof(SharedEnvHeader, response) == 128
+              && offsetof(SharedEnvHeader, closed) == 192
+              && sizeof(std::atomic<uint32_t>) == 4,
+              "The shared counters are found by other languages at these "
+              "offsets");
+
+/**
+ * Serves many environments, each a headless Engine, to another process
+ * through a shared file. The client writes an action for every
+ * environment and asks for a batch; the server steps them all, writes
+ * their observations into the next slot of the ring, and answers. Each side
+ * spins briefly and then sleeps on a futex, so a busy client costs no
+ * system calls, and an idle one no CPU. An environment restarts itself
+ * when its ball collides, or when its episode reaches the tick limit.
+ */
+class SharedEnvServer {
+ public:
+  SharedEnvServer(const std::string& path, size_t envs, size_t ring,
+                  int width, int height, unsigned seed,
+                  uint32_t max_episode_ticks);
+  ~SharedEnvServer();
+  SharedEnvServer(const SharedEnvServer&) = delete;
+  SharedEnvServer& operator=(const SharedEnvServer&) = delete;
+
+  bool ServeBatch(int timeout_ms);
+  void Serve(const std::atomic<bool>& stop);
+  size_t Envs() const;
+  uint32_t Batches() const;
+
+ private:
+  void StepAll(uint32_t batch);
+
+  char* data_;
+  size_t size_;
+  SharedEnvHeader* header_;
+  const uint8_t* actions_;
+  EnvObservation* observations_;
+  std::vector<Engine> engines_;
+  std::vector<uint32_t> episode_ticks_;
+  uint32_t served_;
+};
+
+/**
+ * Drives the environments of a SharedEnvServer, from this or any other
+ * process. Step() is Submit() then Wait(), which can be split to do other
+ * work while the server steps, as long as the actions aren't touched.
+ */
+class SharedEnvClient {
+ public:
+  explicit SharedEnvClient(const std::string& path);
+  ~SharedEnvClient();
+  SharedEnvClient(const SharedEnvClient&) = delete;
+  SharedEnvClient& operator=(const SharedEnvClient&) = delete;
+
+  void SetAction(size_t env, Action action);
+  void SetAllActions(uint8_t action);
+  uint8_t* Actions();
+  void Submit();
+  bool Wait(int timeout_ms);
+  bool Step(int timeout_ms = -1);
+  bool ResetAll(int timeout_ms = -1);
+
+  const EnvObservation* Observations(size_t batches_ago = 0) const;
+  size_t Envs() const;
+  size_t Ring() const;
+  uint32_t Batch() const;
+
+ private:
+  char* data_;
+  size_t size_;
+  SharedEnvHeader* header_;
+  uint8_t* actions_;
+  const EnvObservation* observations_;
+  // the last batch that was finished, and the last that was submitted
+  uint32_t batch_;
+  uint32_t pending_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_SHARED_ENV_H_
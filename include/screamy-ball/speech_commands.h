@@ -0,0 +1,75 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_SPEECH_COMMANDS_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_SPEECH_COMMANDS_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * The commands that can be spoken to the game.
+ */
+enum class SpeechCommand {
+  kNone,
+  kJump,
+  kDuck,
+  kPause,
+  kReset,
+  kMute,
+  kMenu,
+  kHelp
+};
+
+/**
+ * A phrase the recognizer listens for. The threshold is how confident
+ * keyword spotting must be before the phrase is detected: longer phrases
+ * need larger (more negative exponent) thresholds, and lower thresholds
+ * trigger more easily.
+ */
+struct SpeechPhrase {
+  std::string phrase;
+  SpeechCommand command;
+  double threshold;
+};
+
+/**
+ * Turns the recognizer's hypotheses for an utterance into at most one
+ * command. A partial hypothesis triggers as soon as it's a whole phrase that
+ * no longer phrase could turn into a different command, so "HIGHER" jumps
+ * before the utterance has ended; the final hypothesis only triggers if the
+ * partial ones didn't.
+ */
+class CommandTrigger {
+ public:
+  CommandTrigger();
+  SpeechCommand OnPartial(const std::string& partial);
+  SpeechCommand OnFinal(const std::string& hypothesis);
+
+ private:
+  bool has_triggered_;
+};
+
+/**
+ * A recording of a spoken command, and the words that were spoken.
+ */
+struct CorpusEntry {
+  std::string wav_path;
+  std::string transcript;
+};
+
+const std::vector<SpeechPhrase>& SpeechPhrases();
+SpeechCommand ParseSpeechCommand(const std::string& hypothesis);
+SpeechCommand ParseEarlyCommand(const std::string& partial);
+std::string CommandGrammar();
+std::string KeywordList();
+std::string SpeechCommandName(SpeechCommand command);
+std::vector<CorpusEntry> ParseCorpus(std::istream& input);
+double UtteranceEndSecs(const std::vector<float>& samples,
+                        unsigned sample_rate);
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_SPEECH_COMMANDS_H_
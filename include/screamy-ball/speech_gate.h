@@ -0,0 +1,86 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_SPEECH_GATE_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_SPEECH_GATE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * A lock-free ring buffer of samples, with one thread writing and another
+ * reading. The writer never waits: a block that doesn't fit is dropped whole,
+ * and counted, so a slow reader costs recognition rather than audio glitches.
+ */
+class AudioRing {
+ public:
+  explicit AudioRing(size_t capacity);
+  bool Write(const float* samples, size_t count);
+  size_t Read(float* samples, size_t max_count);
+  size_t Available() const;
+  size_t Space() const;
+  size_t Dropped() const;
+
+ private:
+  std::vector<float> samples_;
+  const size_t kMask;
+  // the total number of samples ever written and read
+  std::atomic<size_t> written_;
+  std::atomic<size_t> read_;
+  std::atomic<size_t> dropped_;
+};
+
+/**
+ * The thresholds the SpeechGate uses. Levels are in dB relative to a
+ * full-scale signal.
+ */
+struct GateParameters {
+  // speech is at least this much louder than the noise floor, and this loud
+  float open_db = 10;
+  float quiet_db = -50;
+  // how much audio before the speech is kept, so its start isn't cut off
+  float preroll_secs = 0.2f;
+  // how long the gate stays open after the speech, so the recognizer hears
+  // that it has ended
+  float hangover_secs = 0.6f;
+  // how long the gate can stay shut in the middle of an utterance before the
+  // recognizer is told it has ended anyway
+  float end_utterance_secs = 0.3f;
+};
+
+/**
+ * A voice-activity detector that only lets speech through to the
+ * recognizer. Each block's level is compared with a noise floor that tracks
+ * the background; the gate opens with the recent audio before the speech,
+ * and closes once it has been quiet for a while. Processing a block doesn't
+ * allocate.
+ */
+class SpeechGate {
+ public:
+  SpeechGate(unsigned sample_rate, size_t max_block,
+             const GateParameters& parameters = GateParameters());
+  size_t Process(const float* samples, size_t count);
+  const float* Output() const;
+  bool IsOpen() const;
+  void Reset();
+
+ private:
+  const GateParameters kParameters;
+  const float kSampleRate;
+  const size_t kMaxBlock;
+
+  // the most recent samples, as a ring starting at preroll_next_
+  std::vector<float> preroll_;
+  size_t preroll_next_;
+  size_t preroll_filled_;
+  std::vector<float> output_;
+  float noise_db_;
+  float quiet_secs_;
+  bool is_open_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_SPEECH_GATE_H_
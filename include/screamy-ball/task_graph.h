@@ -0,0 +1,95 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_TASK_GRAPH_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_TASK_GRAPH_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * Runs a graph of tasks, each as soon as the tasks it depends on have
+ * finished: most on a pool of threads, and the ones that must run on the
+ * main thread, like anything that touches OpenGL or the audio graph,
+ * whenever the main thread calls RunMainThreadTasks(). A task that throws
+ * fails, and so does every task that depends on it, without running.
+ */
+class TaskGraph {
+ public:
+  using TaskId = size_t;
+
+  /**
+   * When a task ran, measured from Start(), and how it went.
+   */
+  struct Timing {
+    const char* name;
+    bool on_main_thread;
+    double start_secs;
+    double secs;
+    bool failed;
+    std::string error;
+  };
+
+  explicit TaskGraph(size_t threads);
+  ~TaskGraph();
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+
+  TaskId Add(const char* name, std::function<void()> task,
+             const std::vector<TaskId>& dependencies = {});
+  TaskId AddOnMainThread(const char* name, std::function<void()> task,
+                         const std::vector<TaskId>& dependencies = {});
+  void Start();
+  size_t RunMainThreadTasks();
+  void Wait();
+
+  bool IsDone(TaskId task) const;
+  bool HasFailed(TaskId task) const;
+  bool IsFinished() const;
+  std::string Pending() const;
+  std::vector<Timing> Timings() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  enum class State { kWaiting, kReady, kRunning, kDone, kFailed };
+
+  struct Task {
+    std::function<void()> function;
+    std::vector<TaskId> dependents;
+    size_t remaining_dependencies;
+    State state;
+    Timing timing;
+  };
+
+  TaskId AddTask(const char* name, std::function<void()> task,
+                 const std::vector<TaskId>& dependencies,
+                 bool on_main_thread);
+  void MakeReady(TaskId task);
+  void Run(TaskId task);
+  void Finish(TaskId task, const std::string& error);
+  void RunWorker();
+
+  const size_t kThreads;
+  // guards everything below; tasks run without holding it
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  std::vector<Task> tasks_;
+  std::deque<TaskId> ready_;
+  std::deque<TaskId> main_thread_ready_;
+  size_t unfinished_;
+  bool is_stopping_;
+  Clock::time_point start_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_TASK_GRAPH_H_
@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_TRACER_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_TRACER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * Records a timeline of events from any thread, and writes it to a file in
+ * the Chrome trace-event JSON format, which can be opened in chrome://tracing
+ * or in Perfetto. Each thread records into its own fixed-size buffer without
+ * locking or allocating, and a background thread flushes the buffers to the
+ * file. Events are dropped if a buffer fills up before it's flushed.
+ * Event names and categories must be string literals, since only their
+ * pointers are kept. Recording costs a single atomic load while tracing is
+ * off.
+ */
+class Tracer {
+ public:
+  static Tracer& Get();
+
+  bool Start(const std::string& path);
+  void Stop();
+  bool IsEnabled() const;
+  void NameThread(const char* name);
+  void Record(const char* name, const char* category, char phase,
+              std::chrono::steady_clock::time_point start,
+              std::chrono::steady_clock::duration duration);
+  size_t Dropped() const;
+
+  ~Tracer();
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+ private:
+  struct Event {
+    const char* name;
+    const char* category;
+    char phase;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration duration;
+  };
+
+  // a ring buffer with one thread writing to it, and the flusher reading it
+  struct ThreadBuffer {
+    static const size_t kCapacity = 4096;
+    Event events[kCapacity];
+    std::atomic<size_t> written{0};
+    std::atomic<size_t> read{0};
+    std::atomic<const char*> thread_name{nullptr};
+    size_t thread_id = 0;
+    bool named = false;
+  };
+
+  Tracer();
+  ThreadBuffer* CurrentThreadBuffer();
+  void Flush();
+  void FlushBuffer(ThreadBuffer* buffer);
+  void RunFlusher();
+
+  // each thread's buffer, created the first time the thread records
+  static thread_local ThreadBuffer* thread_buffer_;
+
+  const std::chrono::milliseconds kFlushInterval;
+
+  std::atomic<bool> enabled_;
+  std::atomic<size_t> dropped_;
+  // guards the list of buffers and the file, but never the recording
+  std::mutex mutex_;
+  std::condition_variable stopping_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  std::ofstream file_;
+  bool has_events_;
+  bool is_stopping_;
+  std::chrono::steady_clock::time_point start_;
+  std::thread flusher_;
+};
+
+/**
+ * Records the time between its construction and its destruction as a
+ * complete event.
+ */
+class TraceScope {
+ public:
+  TraceScope(const char* name, const char* category);
+  ~TraceScope();
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const char* kName;
+  const char* kCategory;
+  const bool kEnabled;
+  std::chrono::steady_clock::time_point start_;
+};
+
+void TraceInstant(const char* name, const char* category);
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_TRACER_H_
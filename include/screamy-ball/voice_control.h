@@ -0,0 +1,95 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_VOICE_CONTROL_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_VOICE_CONTROL_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * The thresholds the VoiceAnalyzer uses. Levels are in dB relative to a
+ * full-scale signal.
+ */
+struct VoiceParameters {
+  // a scream is at least this loud, and this much louder than the background
+  float scream_db = -24;
+  float onset_db = 8;
+  // anything quieter is silence, which is never pitched
+  float quiet_db = -50;
+  // a tone lower than this ducks
+  float low_tone_hz = 250;
+  // the range of pitches that are detected
+  float min_pitch_hz = 70;
+  float max_pitch_hz = 600;
+  // how periodic a sound must be to be pitched: lower is stricter
+  float pitch_threshold = 0.2f;
+  // how long a low tone must be held to duck, and let go of to stop
+  float duck_hold_secs = 0.12f;
+  float release_secs = 0.06f;
+  // the shortest time between two jumps
+  float jump_cooldown_secs = 0.25f;
+};
+
+/**
+ * What the player's voice is telling the ball to do.
+ */
+enum class VoiceCommand { kNone, kJump, kDuck, kRelease };
+
+/**
+ * A command, and for jumps, how high to jump as a percentage from 50 to 100.
+ */
+struct VoiceEvent {
+  VoiceCommand command;
+  int strength;
+};
+
+/**
+ * Turns the player's voice into commands, one short block of microphone
+ * samples at a time, much faster than speech recognition can: a sudden loud
+ * sound is a scream, which jumps higher the louder it is, and a sustained
+ * low tone ducks until it stops. Loudness is the block's RMS level, compared
+ * with a slowly moving background level to find onsets, and pitch is found
+ * with the YIN method. Processing a block doesn't allocate.
+ */
+class VoiceAnalyzer {
+ public:
+  explicit VoiceAnalyzer(unsigned sample_rate,
+                         const VoiceParameters& parameters = VoiceParameters());
+  VoiceEvent Process(const float* samples, size_t count);
+
+  float LevelDb() const;
+  float PitchHz() const;
+  bool IsDucking() const;
+
+ private:
+  void AddToHistory(const float* samples, size_t count);
+  float DetectPitch();
+
+  const VoiceParameters kParameters;
+  const float kSampleRate;
+  const size_t kMinLag;
+  const size_t kMaxLag;
+
+  // the most recent samples, enough for two periods of the lowest pitch
+  std::vector<float> history_;
+  size_t history_filled_;
+  // YIN's difference function, for every lag up to kMaxLag
+  std::vector<float> difference_;
+
+  float level_db_;
+  float background_db_;
+  float pitch_hz_;
+  float low_tone_secs_;
+  float no_tone_secs_;
+  float cooldown_secs_;
+  bool is_ducking_;
+};
+
+float Rms(const float* samples, size_t count);
+float SumSquaredDifference(const float* lhs, const float* rhs, size_t count);
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_VOICE_CONTROL_H_
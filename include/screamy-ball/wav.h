@@ -0,0 +1,33 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_WAV_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_WAV_H_
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * Uncompressed audio, with the channels' samples interleaved.
+ */
+struct WavData {
+  unsigned sample_rate;
+  unsigned channels;
+  std::vector<float> samples;
+};
+
+WavData ReadWav(std::istream& input);
+void WriteWav(std::ostream& output, const WavData& wav);
+std::vector<float> MixToMono(const WavData& wav);
+std::vector<float> Deinterleave(const WavData& wav);
+std::vector<float> Resample(const std::vector<float>& samples,
+                            unsigned from_rate, unsigned to_rate);
+std::vector<float> ResamplePlanar(const std::vector<float>& samples,
+                                  unsigned channels, unsigned from_rate,
+                                  unsigned to_rate);
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_WAV_H_
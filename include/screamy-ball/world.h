@@ -0,0 +1,119 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_INCLUDE_SCREAMY_BALL_WORLD_H_
+#define FINALPROJECT_INCLUDE_SCREAMY_BALL_WORLD_H_
+
+#include "geometry.h"
+#include "obstacle.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace screamy_ball {
+
+/**
+ * An obstacle at a position in the world. Like an Obstacle's x, x is the
+ * right edge of its first spike, in sub-tiles, and its spikes run on from
+ * there.
+ */
+struct WorldObstacle {
+  long long x;
+  ObstacleType type;
+  int length;
+};
+
+/**
+ * A window onto the world, in tiles. It only decides what can be seen and
+ * where: the board is drawn through it, and the background's layers scroll
+ * past it more slowly the further away they are. Positions are doubles, so
+ * they stay precise to well under a pixel however far a game goes.
+ */
+class Camera {
+ public:
+  Camera(double width, double height);
+  void MoveTo(double left);
+
+  double Left() const;
+  double Right() const;
+  double Height() const;
+  double ToScreen(double world_x, double parallax = 1) const;
+  bool IsVisible(double left, double right, double parallax = 1) const;
+  long long FirstVisible(double spacing, double parallax) const;
+
+ private:
+  const double kWidth;
+  const double kHeight;
+  double left_;
+};
+
+/**
+ * The obstacles around the camera, bucketed into chunks of the world. Only
+ * a fixed run of chunks is resident at once, in a ring, so the memory and
+ * the cost of finding what's on screen stay the same however long the world
+ * is. Chunks are released once the camera has passed them, and their slots
+ * are reused for the chunks ahead of it. Nothing is allocated after
+ * construction.
+ */
+class ObstacleChunks {
+ public:
+  ObstacleChunks(int chunk_tiles, size_t resident_chunks,
+                 size_t chunk_capacity);
+  bool Add(const WorldObstacle& obstacle);
+  void Release(long long first_chunk);
+  void Clear();
+
+  template <typename F>
+  void ForEachIn(long long left, long long right, F visit) const;
+
+  long long ChunkOf(long long x) const;
+  long long FirstChunk() const;
+  long long EndChunk() const;
+  size_t Size() const;
+
+ private:
+  size_t Slot(long long chunk) const;
+  // the sub-tiles an obstacle covers, from its first spike's left edge
+  long long Start(const WorldObstacle& obstacle) const;
+  long long End(const WorldObstacle& obstacle) const;
+
+  const long long kChunkWidth;
+  const size_t kResidentChunks;
+  const size_t kChunkCapacity;
+  // every resident chunk's obstacles, ordered by position, in its slot
+  std::vector<WorldObstacle> obstacles_;
+  std::vector<size_t> counts_;
+  long long first_chunk_;
+  size_t size_;
+};
+
+/**
+ * Visits the obstacles that overlap part of the world, chunk by chunk, so
+ * only the chunks under that part are looked at.
+ * @param left the left edge of the part, in sub-tiles.
+ * @param right the right edge of the part, in sub-tiles.
+ * @param visit called with each overlapping obstacle, in order.
+ */
+template <typename F>
+void ObstacleChunks::ForEachIn(long long left, long long right,
+                               F visit) const {
+  // an obstacle is bucketed by its start, and is never wider than a chunk,
+  // so one that overlaps left can start in the chunk before it
+  long long chunk = ChunkOf(left) - 1;
+  if (chunk < first_chunk_) {
+    chunk = first_chunk_;
+  }
+  const long long last = ChunkOf(right);
+  for (; chunk <= last && chunk < EndChunk(); chunk++) {
+    const size_t slot = Slot(chunk);
+    const WorldObstacle* first = &obstacles_[slot * kChunkCapacity];
+    for (size_t index = 0; index < counts_[slot]; index++) {
+      if (End(first[index]) > left && Start(first[index]) < right) {
+        visit(first[index]);
+      }
+    }
+  }
+}
+
+}  // namespace screamy_ball
+
+#endif  // FINALPROJECT_INCLUDE_SCREAMY_BALL_WORLD_H_
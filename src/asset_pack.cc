@@ -0,0 +1,314 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/asset_pack.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define SCREAMY_BALL_READ_PACK
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace screamy_ball {
+
+const char kPackMagic[] = "SBPACK01";
+const size_t kMagicSize = 8;
+const uint32_t kPackVersion = 1;
+// the magic, the version, the number of assets, and the index's offset and
+// size
+const size_t kHeaderSize = kMagicSize + 4 + 4 + 8 + 8;
+const uint8_t kFileKind = 0;
+const uint8_t kPcmKind = 1;
+
+/**
+ * Appends a little-endian unsigned integer of `bytes` bytes.
+ */
+void AppendLittleEndian(std::string* output, uint64_t value, size_t bytes) {
+  for (size_t byte = 0; byte < bytes; byte++) {
+    output->push_back(static_cast<char>((value >> (8 * byte)) & 0xff));
+  }
+}
+
+/**
+ * Reads a little-endian unsigned integer of `bytes` bytes from the pack.
+ * @param data the pack.
+ * @param size the pack's size.
+ * @param position where the integer starts, which is moved past it.
+ * @throws std::invalid_argument if the integer goes past the end of the pack.
+ */
+uint64_t ReadLittleEndian(const char* data, size_t size, size_t* position,
+                          size_t bytes) {
+  if (size - *position < bytes) {
+    throw std::invalid_argument("The asset pack ends too early");
+  }
+  uint64_t value = 0;
+  for (size_t byte = 0; byte < bytes; byte++) {
+    value |= static_cast<uint64_t>(
+        static_cast<unsigned char>(data[*position + byte])) << (8 * byte);
+  }
+  *position += bytes;
+  return value;
+}
+
+/**
+ * Rounds an offset up to the next page.
+ */
+size_t AlignToPage(size_t offset) {
+  return (offset + kPackAlignment - 1) / kPackAlignment * kPackAlignment;
+}
+
+/**
+ * Counts the frames of decoded audio, or returns 0 for a file.
+ * @return the number of frames.
+ */
+size_t PackedAsset::Frames() const {
+  if (!is_pcm || channels == 0) {
+    return 0;
+  }
+  return size / sizeof(float) / channels;
+}
+
+/**
+ * Gets one channel of decoded audio. The samples are page-aligned, so they
+ * can be read as floats straight from the mapping.
+ * @param channel the channel, less than `channels`.
+ * @return the channel's Frames() samples.
+ */
+const float* PackedAsset::Samples(size_t channel) const {
+  return reinterpret_cast<const float*>(data) + channel * Frames();
+}
+
+/**
+ * Adds a file, which is stored as it is.
+ * @param name the name the asset is found by.
+ * @param bytes the file's contents.
+ */
+void AssetPackWriter::AddFile(const std::string& name, std::string bytes) {
+  entries_.push_back({ name, std::move(bytes), false, 0, 0 });
+}
+
+/**
+ * Adds decoded audio, so that it can be played without decoding it again.
+ * @param name the name the asset is found by.
+ * @param samples the audio, with every channel's frames one after another.
+ * @param sample_rate the audio's sample rate.
+ * @param channels the number of channels.
+ * @throws std::invalid_argument if the samples can't be split into channels.
+ */
+void AssetPackWriter::AddPcm(const std::string& name,
+                             const std::vector<float>& samples,
+                             unsigned sample_rate, unsigned channels) {
+  if (channels == 0 || samples.size() % channels != 0) {
+    throw std::invalid_argument("The samples of " + name + " can't be split "
+                                "into " + std::to_string(channels)
+                                + " channels");
+  }
+  // the floats are stored in the host's byte order, which is little-endian
+  // on every platform the game runs on
+  std::string bytes(samples.size() * sizeof(float), '\0');
+  if (!samples.empty()) {
+    std::memcpy(&bytes[0], samples.data(), bytes.size());
+  }
+  entries_.push_back({ name, std::move(bytes), true, sample_rate, channels });
+}
+
+/**
+ * Writes the pack.
+ * @param output the pack's file, opened in binary mode.
+ */
+void AssetPackWriter::Write(std::ostream& output) const {
+  std::string index;
+  size_t offset = AlignToPage(kHeaderSize);
+  for (const Entry& entry : entries_) {
+    AppendLittleEndian(&index, entry.name.size(), 2);
+    index += entry.name;
+    index.push_back(static_cast<char>(entry.is_pcm ? kPcmKind : kFileKind));
+    AppendLittleEndian(&index, offset, 8);
+    AppendLittleEndian(&index, entry.bytes.size(), 8);
+    AppendLittleEndian(&index, entry.sample_rate, 4);
+    AppendLittleEndian(&index, entry.channels, 4);
+    offset = AlignToPage(offset + entry.bytes.size());
+  }
+
+  std::string header(kPackMagic, kMagicSize);
+  AppendLittleEndian(&header, kPackVersion, 4);
+  AppendLittleEndian(&header, entries_.size(), 4);
+  AppendLittleEndian(&header, offset, 8);
+  AppendLittleEndian(&header, index.size(), 8);
+  header.resize(AlignToPage(kHeaderSize), '\0');
+  output.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+  for (const Entry& entry : entries_) {
+    output.write(entry.bytes.data(),
+                 static_cast<std::streamsize>(entry.bytes.size()));
+    const size_t padding = AlignToPage(entry.bytes.size())
+        - entry.bytes.size();
+    const std::string zeros(padding, '\0');
+    output.write(zeros.data(), static_cast<std::streamsize>(padding));
+  }
+  output.write(index.data(), static_cast<std::streamsize>(index.size()));
+}
+
+/**
+ * Maps a pack into memory, and reads its index. The assets themselves aren't
+ * read until they're used.
+ * @param path the pack's file.
+ * @throws std::runtime_error if the pack can't be opened.
+ * @throws std::invalid_argument if the file isn't a valid pack.
+ */
+AssetPack::AssetPack(const std::string& path) : data_(nullptr), size_(0) {
+#if defined(SCREAMY_BALL_READ_PACK)
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("Couldn't open the asset pack " + path);
+  }
+  copy_.assign(std::istreambuf_iterator<char>(input),
+               std::istreambuf_iterator<char>());
+  data_ = copy_.data();
+  size_ = copy_.size();
+#else
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw std::runtime_error("Couldn't open the asset pack " + path);
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0 || status.st_size < 0) {
+    close(file);
+    throw std::runtime_error("Couldn't read the asset pack " + path);
+  }
+  size_ = static_cast<size_t>(status.st_size);
+  if (size_ > 0) {
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0);
+    if (mapping == MAP_FAILED) {
+      close(file);
+      throw std::runtime_error("Couldn't map the asset pack " + path);
+    }
+    data_ = static_cast<const char*>(mapping);
+  }
+  // the mapping stays valid once the file is closed
+  close(file);
+#endif
+
+  try {
+    ReadIndex();
+  } catch (...) {
+    Unmap();
+    throw;
+  }
+}
+
+AssetPack::~AssetPack() {
+  Unmap();
+}
+
+void AssetPack::Unmap() {
+#if !defined(SCREAMY_BALL_READ_PACK)
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+/**
+ * Reads the pack's header and index, and checks that every asset is inside
+ * the pack.
+ * @throws std::invalid_argument if the pack isn't valid.
+ */
+void AssetPack::ReadIndex() {
+  if (size_ < kHeaderSize || std::memcmp(data_, kPackMagic, kMagicSize) != 0) {
+    throw std::invalid_argument("Not an asset pack");
+  }
+  size_t position = kMagicSize;
+  if (ReadLittleEndian(data_, size_, &position, 4) != kPackVersion) {
+    throw std::invalid_argument("The asset pack's version isn't supported");
+  }
+  const uint64_t count = ReadLittleEndian(data_, size_, &position, 4);
+  const uint64_t index_offset = ReadLittleEndian(data_, size_, &position, 8);
+  const uint64_t index_size = ReadLittleEndian(data_, size_, &position, 8);
+  if (index_offset > size_ || index_size > size_ - index_offset) {
+    throw std::invalid_argument("The asset pack's index is past its end");
+  }
+
+  const char* index = data_ + index_offset;
+  const size_t size = static_cast<size_t>(index_size);
+  position = 0;
+  for (uint64_t entry = 0; entry < count; entry++) {
+    const size_t name_size = static_cast<size_t>(
+        ReadLittleEndian(index, size, &position, 2));
+    if (size - position < name_size) {
+      throw std::invalid_argument("The asset pack ends too early");
+    }
+    const std::string name(index + position, name_size);
+    position += name_size;
+
+    const uint64_t kind = ReadLittleEndian(index, size, &position, 1);
+    const uint64_t offset = ReadLittleEndian(index, size, &position, 8);
+    const uint64_t asset_size = ReadLittleEndian(index, size, &position, 8);
+    const auto sample_rate = static_cast<unsigned>(
+        ReadLittleEndian(index, size, &position, 4));
+    const auto channels = static_cast<unsigned>(
+        ReadLittleEndian(index, size, &position, 4));
+
+    if (offset > size_ || asset_size > size_ - offset) {
+      throw std::invalid_argument("The asset " + name + " is past the end of "
+                                  "the pack");
+    }
+    if (offset % kPackAlignment != 0) {
+      throw std::invalid_argument("The asset " + name + " isn't aligned");
+    }
+    if (kind != kFileKind && kind != kPcmKind) {
+      throw std::invalid_argument("The asset " + name + " has an unknown "
+                                  "kind");
+    }
+    if (kind == kPcmKind
+        && (channels == 0 || asset_size % (sizeof(float) * channels) != 0)) {
+      throw std::invalid_argument("The audio " + name + " can't be split "
+                                  "into its channels");
+    }
+    assets_[name] = { data_ + offset, static_cast<size_t>(asset_size),
+                      kind == kPcmKind, sample_rate, channels };
+  }
+}
+
+/**
+ * Finds an asset by its name.
+ * @param name the asset's name.
+ * @return a view of the asset, which is valid as long as the pack is open,
+ * or nullptr if the pack doesn't have it.
+ */
+const PackedAsset* AssetPack::Find(const std::string& name) const {
+  const auto asset = assets_.find(name);
+  return asset == assets_.end() ? nullptr : &asset->second;
+}
+
+/**
+ * Lists the pack's assets.
+ * @return the assets' names, in alphabetical order.
+ */
+std::vector<std::string> AssetPack::Names() const {
+  std::vector<std::string> names;
+  for (const auto& asset : assets_) {
+    names.push_back(asset.first);
+  }
+  return names;
+}
+
+/**
+ * Gets the size of the whole pack, which is how much of it is mapped.
+ * @return the size, in bytes.
+ */
+size_t AssetPack::Size() const {
+  return size_;
+}
+
+}  // namespace screamy_ball
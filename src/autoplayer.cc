@@ -0,0 +1,156 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/autoplayer.h>
+
+namespace screamy_ball {
+
+// the inputs that can change the ball's state, in the order they're tried.
+const Action kActions[] = { Action::kJump, Action::kDuck, Action::kRoll };
+
+/**
+ * Returns the action that keeps the ball in its current state.
+ * @param state the ball's state.
+ * @return the action that corresponds to the state.
+ */
+Action CurrentAction(BallState state) {
+  switch (state) {
+    case BallState::kJumping: {
+      return Action::kJump;
+    }
+    case BallState::kDucking: {
+      return Action::kDuck;
+    }
+    default: {
+      return Action::kRoll;
+    }
+  }
+}
+
+Autoplayer::Autoplayer(size_t lookahead) :
+    kLookahead(lookahead),
+    kNodeBudget(4096),
+    nodes_left_(0),
+    decisions_(0) {}
+
+/**
+ * Picks the action that lets the ball survive the longest, looking at most
+ * kLookahead ticks into the future. Giving no new input is tried first, since
+ * it is the most common answer and lets the search stop early.
+ * @param engine the current state of the game.
+ * @return the chosen action. Applying it to `engine` may not change anything.
+ */
+template <typename E>
+Action Autoplayer::Decide(const E& engine) {
+  decisions_++;
+  nodes_left_ = kNodeBudget;
+
+  Action best_action = CurrentAction(engine.state_);
+  size_t best_ticks = Survive(engine, kLookahead);
+
+  for (Action action : kActions) {
+    if (best_ticks == kLookahead) {
+      break;
+    }
+    E clone = engine;
+    if (!Apply(&clone, action)) {
+      continue;
+    }
+
+    const size_t ticks = Survive(clone, kLookahead);
+    if (ticks > best_ticks) {
+      best_ticks = ticks;
+      best_action = action;
+    }
+  }
+  return best_action;
+}
+
+/**
+ * Gives the ball an input, following the same rules as the app: the ball
+ * can't duck mid-air, and it only stops ducking by rolling again.
+ * @param engine the engine to give the input to.
+ * @param action the input.
+ * @return true if the action changed the ball's state, false otherwise.
+ */
+template <typename E>
+bool Autoplayer::Apply(E* engine, Action action) {
+  switch (action) {
+    case Action::kJump: {
+      if (engine->state_ == BallState::kJumping) {
+        return false;
+      }
+      engine->state_ = BallState::kJumping;
+      return true;
+    }
+
+    case Action::kDuck: {
+      if (engine->state_ != BallState::kRolling) {
+        return false;
+      }
+      engine->state_ = BallState::kDucking;
+      return true;
+    }
+
+    case Action::kRoll: {
+      if (engine->state_ != BallState::kDucking) {
+        return false;
+      }
+      engine->state_ = BallState::kRolling;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Getter for the number of decisions made so far.
+ * @return the number of decisions.
+ */
+size_t Autoplayer::Decisions() const { return decisions_; }
+
+/**
+ * Runs `engine` for one tick, then recursively simulates every sequence of
+ * actions from there.
+ * @param engine the state to simulate from. It is copied, never modified.
+ * @param depth the number of ticks left to simulate.
+ * @return the most ticks the ball survived, up to `depth`.
+ */
+template <typename E>
+size_t Autoplayer::Survive(const E& engine, size_t depth) {
+  E next = engine;
+  next.Run();
+  if (next.state_ == BallState::kCollided) {
+    return 0;
+  }
+  if (depth <= 1 || nodes_left_ == 0) {
+    // when the budget runs out, assume the rest of the path is safe
+    return depth;
+  }
+  nodes_left_--;
+
+  size_t best_ticks = Survive(next, depth - 1);
+
+  for (Action action : kActions) {
+    if (best_ticks == depth - 1) {
+      break;
+    }
+    E clone = next;
+    if (!Apply(&clone, action)) {
+      continue;
+    }
+
+    const size_t ticks = Survive(clone, depth - 1);
+    if (ticks > best_ticks) {
+      best_ticks = ticks;
+    }
+  }
+  return best_ticks + 1;
+}
+
+// The Engines the library is built with.
+template Action Autoplayer::Decide(const Engine& engine);
+template bool Autoplayer::Apply(Engine* engine, Action action);
+template Action Autoplayer::Decide(const DefaultEngine& engine);
+template bool Autoplayer::Apply(DefaultEngine* engine, Action action);
+
+}  // namespace screamy_ball
@@ -0,0 +1,217 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/collision.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCREAMY_BALL_SSE2
+#endif
+
+namespace screamy_ball {
+
+/*
+ * An ellipse is tested by stretching the whole scene vertically by
+ * radius_x / radius_y, which turns the ellipse into a circle of radius
+ * radius_x and keeps every triangle a triangle. A circle overlaps a triangle
+ * when its center is inside the triangle, or when its center is closer than
+ * the radius to one of the triangle's edges. Touching doesn't count.
+ */
+
+/**
+ * Calculates the squared distance from a point to a line segment.
+ * @return the squared distance from (px, py) to the segment from (ax, ay) to
+ * (bx, by).
+ */
+float SegmentDistanceSquared(float px, float py, float ax, float ay,
+                             float bx, float by) {
+  const float edge_x = bx - ax;
+  const float edge_y = by - ay;
+  const float length_squared = edge_x * edge_x + edge_y * edge_y;
+  float t = ((px - ax) * edge_x + (py - ay) * edge_y) / length_squared;
+  t = std::min(1.0f, std::max(0.0f, t));
+
+  const float dx = px - (ax + t * edge_x);
+  const float dy = py - (ay + t * edge_y);
+  return dx * dx + dy * dy;
+}
+
+/**
+ * Calculates which side of the line from a to b the point p is on.
+ * @return a positive number on one side, negative on the other, 0 on the line.
+ */
+float Side(float px, float py, float ax, float ay, float bx, float by) {
+  return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+/**
+ * Checks if a circle at the origin overlaps a triangle.
+ * @param radius_squared the circle's squared radius.
+ * @return true if they overlap, false otherwise.
+ */
+bool CircleAtOriginIntersects(float radius_squared, float ax, float ay,
+                              float bx, float by, float cx, float cy) {
+  const float side_ab = Side(0, 0, ax, ay, bx, by);
+  const float side_bc = Side(0, 0, bx, by, cx, cy);
+  const float side_ca = Side(0, 0, cx, cy, ax, ay);
+  const bool has_negative = side_ab < 0 || side_bc < 0 || side_ca < 0;
+  const bool has_positive = side_ab > 0 || side_bc > 0 || side_ca > 0;
+  if (!(has_negative && has_positive)) {
+    return true;
+  }
+
+  return SegmentDistanceSquared(0, 0, ax, ay, bx, by) < radius_squared
+      || SegmentDistanceSquared(0, 0, bx, by, cx, cy) < radius_squared
+      || SegmentDistanceSquared(0, 0, cx, cy, ax, ay) < radius_squared;
+}
+
+/**
+ * Checks if an ellipse overlaps a triangle.
+ * @return true if they overlap, false otherwise.
+ */
+bool Intersects(const Ellipse& ellipse, const Triangle& triangle) {
+  const float scale = ellipse.radius_x / ellipse.radius_y;
+  const float x = ellipse.center_x;
+  const float y = ellipse.center_y;
+
+  return CircleAtOriginIntersects(ellipse.radius_x * ellipse.radius_x,
+      triangle.ax - x, (triangle.ay - y) * scale,
+      triangle.bx - x, (triangle.by - y) * scale,
+      triangle.cx - x, (triangle.cy - y) * scale);
+}
+
+TriangleBatch::TriangleBatch() : size_(0) {}
+
+/**
+ * Adds a triangle to the batch.
+ * @param triangle the triangle to add.
+ * @return true if it was added, false if the batch is already full.
+ */
+bool TriangleBatch::Add(const Triangle& triangle) {
+  if (size_ == kCapacity) {
+    return false;
+  }
+  ax_[size_] = triangle.ax;
+  ay_[size_] = triangle.ay;
+  bx_[size_] = triangle.bx;
+  by_[size_] = triangle.by;
+  cx_[size_] = triangle.cx;
+  cy_[size_] = triangle.cy;
+  size_++;
+  return true;
+}
+
+/**
+ * Getter for the number of triangles in the batch.
+ * @return the number of triangles.
+ */
+size_t TriangleBatch::Size() const { return size_; }
+
+/**
+ * Removes every triangle from the batch.
+ */
+void TriangleBatch::Clear() { size_ = 0; }
+
+#ifdef SCREAMY_BALL_SSE2
+/**
+ * The SIMD version of SegmentDistanceSquared, for four segments at once.
+ */
+__m128 SegmentDistanceSquared4(__m128 ax, __m128 ay, __m128 bx, __m128 by) {
+  const __m128 edge_x = _mm_sub_ps(bx, ax);
+  const __m128 edge_y = _mm_sub_ps(by, ay);
+  const __m128 length_squared = _mm_add_ps(_mm_mul_ps(edge_x, edge_x),
+                                           _mm_mul_ps(edge_y, edge_y));
+  // the point is at the origin, so (p - a) is just -a
+  __m128 t = _mm_div_ps(
+      _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_mul_ps(ax, edge_x),
+                                              _mm_mul_ps(ay, edge_y))),
+      length_squared);
+  t = _mm_min_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_setzero_ps(), t));
+
+  const __m128 dx = _mm_add_ps(ax, _mm_mul_ps(t, edge_x));
+  const __m128 dy = _mm_add_ps(ay, _mm_mul_ps(t, edge_y));
+  return _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+}
+
+/**
+ * The SIMD version of Side, for four lines at once, with p at the origin.
+ */
+__m128 Side4(__m128 ax, __m128 ay, __m128 bx, __m128 by) {
+  return _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(bx, ax), _mm_sub_ps(_mm_setzero_ps(),
+                                                              ay)),
+                    _mm_mul_ps(_mm_sub_ps(by, ay), _mm_sub_ps(_mm_setzero_ps(),
+                                                              ax)));
+}
+#endif
+
+/**
+ * Checks if an ellipse overlaps any triangle in a batch. With SSE2, four
+ * triangles are tested at a time.
+ * @return true if they overlap, false otherwise.
+ */
+bool Intersects(const Ellipse& ellipse, const TriangleBatch& batch) {
+  const float scale = ellipse.radius_x / ellipse.radius_y;
+  const float x = ellipse.center_x;
+  const float y = ellipse.center_y;
+  const float radius_squared = ellipse.radius_x * ellipse.radius_x;
+  size_t index = 0;
+
+#ifdef SCREAMY_BALL_SSE2
+  const __m128 center_x = _mm_set1_ps(x);
+  const __m128 center_y = _mm_set1_ps(y);
+  const __m128 scale4 = _mm_set1_ps(scale);
+  const __m128 radius_squared4 = _mm_set1_ps(radius_squared);
+  const __m128 zero = _mm_setzero_ps();
+
+  for (; index + 4 <= batch.size_; index += 4) {
+    const __m128 ax = _mm_sub_ps(_mm_load_ps(batch.ax_ + index), center_x);
+    const __m128 bx = _mm_sub_ps(_mm_load_ps(batch.bx_ + index), center_x);
+    const __m128 cx = _mm_sub_ps(_mm_load_ps(batch.cx_ + index), center_x);
+    const __m128 ay = _mm_mul_ps(
+        _mm_sub_ps(_mm_load_ps(batch.ay_ + index), center_y), scale4);
+    const __m128 by = _mm_mul_ps(
+        _mm_sub_ps(_mm_load_ps(batch.by_ + index), center_y), scale4);
+    const __m128 cy = _mm_mul_ps(
+        _mm_sub_ps(_mm_load_ps(batch.cy_ + index), center_y), scale4);
+
+    const __m128 side_ab = Side4(ax, ay, bx, by);
+    const __m128 side_bc = Side4(bx, by, cx, cy);
+    const __m128 side_ca = Side4(cx, cy, ax, ay);
+    const __m128 has_negative = _mm_or_ps(
+        _mm_or_ps(_mm_cmplt_ps(side_ab, zero), _mm_cmplt_ps(side_bc, zero)),
+        _mm_cmplt_ps(side_ca, zero));
+    const __m128 has_positive = _mm_or_ps(
+        _mm_or_ps(_mm_cmpgt_ps(side_ab, zero), _mm_cmpgt_ps(side_bc, zero)),
+        _mm_cmpgt_ps(side_ca, zero));
+    const __m128 is_inside = _mm_andnot_ps(
+        _mm_and_ps(has_negative, has_positive), _mm_castsi128_ps(
+            _mm_set1_epi32(-1)));
+
+    const __m128 is_near = _mm_or_ps(
+        _mm_or_ps(
+            _mm_cmplt_ps(SegmentDistanceSquared4(ax, ay, bx, by),
+                         radius_squared4),
+            _mm_cmplt_ps(SegmentDistanceSquared4(bx, by, cx, cy),
+                         radius_squared4)),
+        _mm_cmplt_ps(SegmentDistanceSquared4(cx, cy, ax, ay),
+                     radius_squared4));
+
+    if (_mm_movemask_ps(_mm_or_ps(is_inside, is_near)) != 0) {
+      return true;
+    }
+  }
+#endif
+
+  for (; index < batch.size_; index++) {
+    if (CircleAtOriginIntersects(radius_squared,
+            batch.ax_[index] - x, (batch.ay_[index] - y) * scale,
+            batch.bx_[index] - x, (batch.by_[index] - y) * scale,
+            batch.cx_[index] - x, (batch.cy_[index] - y) * scale)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace screamy_ball
@@ -2,143 +2,371 @@
 
 #include <screamy-ball/engine.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace screamy_ball {
 
-Engine::Engine(const Location& ball_loc, int width, int height) :
+// the furthest past the board's left edge an obstacle is placed, in
+// sub-tiles. One further away in the world, after a gap in a sparse level,
+// is brought in to here, which is still millions of tiles off, so its
+// position fits in an int with room to spare.
+const long long kMaxObstacleX = std::numeric_limits<int>::max() / 2;
+
+/**
+ * Converts a position in sub-tiles to the tile it's in.
+ * @param sub_tiles the position in sub-tiles.
+ * @return the tile, rounded down.
+ */
+int FloorTile(int sub_tiles) {
+  return sub_tiles >= 0 ? sub_tiles / kSubTiles
+                        : -((-sub_tiles + kSubTiles - 1) / kSubTiles);
+}
+
+/**
+ * Converts a position in sub-tiles to the tile it's in.
+ * @param sub_tiles the position in sub-tiles.
+ * @return the tile, rounded up.
+ */
+int CeilTile(int sub_tiles) {
+  return -FloorTile(-sub_tiles);
+}
+
+/**
+ * Creates an Engine whose obstacles are generated from the given seed, so
+ * that the same seed always plays out the same game.
+ * @param ball_loc the ball's starting location, which must be on the ground.
+ * @param geometry the board's geometry and the game's parameters.
+ * @param seed the seed for the obstacle generator.
+ */
+template <typename Geometry>
+BasicEngine<Geometry>::BasicEngine(const Location& ball_loc,
+                                   const Geometry& geometry, unsigned seed) :
+    kMaxHeight(geometry.Ground() - geometry.JumpHeight()),
+    kMinHeight(geometry.Ground()),
     state_(BallState::kRolling),
+    obstacle_(ObstacleType::kLow, { geometry.Width(), geometry.Ground() },
+              geometry.ObstacleHeight(), geometry.MinObstacleLength(),
+              geometry.MaxObstacleLength()),
     ball_(ball_loc),
-    kMaxHeight(ball_loc.Col() - 5),
-    kMinHeight(ball_loc.Col()),
-    kWindowWidth(width),
-    kWindowHeight(height),
-    reached_max_height_(false),
-    obstacle_(ObstacleType::kLow, { width, kMinHeight }) {}
+    kGeometry(geometry),
+    ticks_(0),
+    scroll_(0),
+    jump_strength_(100),
+    launch_strength_(100),
+    source_(nullptr),
+    random_obstacles_(geometry.MinObstacleLength(),
+                      geometry.MaxObstacleLength()),
+    cursor_({ 0, std::minstd_rand(seed) }) {}
+
+Engine::Engine(const Location& ball_loc, int width, int height) :
+    Engine(ball_loc, width, height, std::random_device()()) {}
+
+/**
+ * Creates an Engine whose obstacles are generated from the given seed.
+ * @param seed the seed for the obstacle generator.
+ * @param parameters the jump height and the obstacle dimensions.
+ */
+Engine::Engine(const Location& ball_loc, int width, int height,
+               unsigned seed, const EngineParameters& parameters) :
+    BasicEngine(ball_loc,
+                RuntimeGeometry(width, height, ball_loc.Col(), parameters),
+                seed) {}
 
 /**
  * The main function of Engine, to be called by the app. It checks for
  * collision, it creates obstacles, and it jumps when necessary.
  */
-void Engine::Run() {
+template <typename Geometry>
+void BasicEngine<Geometry>::Run() {
+  SyncPositions();
   if (HasCollided()) {
     state_ = BallState::kCollided;
     return;
   }
   CreateObstacle();
+  if (state_ == BallState::kCollided) {
+    return;
+  }
   if (state_ == BallState::kJumping) {
     Jump();
   }
+  // the count stops once it's too big to matter, rather than overflowing,
+  // since a bot can survive for ever
+  if (ticks_ < std::numeric_limits<int>::max()) {
+    ticks_++;
+  }
 }
 
 /**
- * Changes the ball's location to make it seem like it's jumping.
+ * Moves the ball and the obstacle to the start of their tiles if their
+ * Locations were changed from outside the Engine.
  */
-void Engine::Jump() {
-  if (reached_max_height_) {
-    ball_.location = {ball_.location.Row(),
-                       ball_.location.Col() + 1 };
-    if (ball_.location.Col() == kMinHeight) {
-      reached_max_height_ = false;
-      state_ = BallState::kRolling;
-    }
-  } else {
-    ball_.location = { ball_.location.Row(),
-                        ball_.location.Col() - 1 };
-    if (ball_.location.Col() == kMaxHeight) {
-      reached_max_height_ = true;
-    }
+template <typename Geometry>
+void BasicEngine<Geometry>::SyncPositions() {
+  if (CeilTile(ball_.y) != ball_.location.Col()) {
+    ball_.y = ball_.location.Col() * kSubTiles;
+  }
+  if (FloorTile(obstacle_.x) != obstacle_.location.Row()) {
+    obstacle_.x = obstacle_.location.Row() * kSubTiles;
   }
 }
 
 /**
- * Creates an obstacle and changes its location on every update.
+ * Sets how high the ball's next jump goes, so that a louder scream can jump
+ * higher. Jumps keep the same duration no matter how high they go.
+ * @param percent the jump's height, as a percentage of JumpHeight(), from 50
+ * to 100.
  */
-void Engine::CreateObstacle() {
-  // make obstacle move towards the ball
-  obstacle_.location = { obstacle_.location.Row() - 1,
-                         obstacle_.location.Col() };
+template <typename Geometry>
+void BasicEngine<Geometry>::SetJumpStrength(int percent) {
+  jump_strength_ = std::min(100, std::max(50, percent));
+}
 
-  // if the obstacle hasn't reached the end of the screen, return
-  if (obstacle_.location.Row() != -(obstacle_.length) - 1) {
-    return;
+/**
+ * Sets where the obstacles come from, starting from the source's first
+ * obstacle once the current one has gone.
+ * @param source the source, which must outlive the Engine and its copies,
+ * or nullptr to generate every obstacle randomly.
+ */
+template <typename Geometry>
+void BasicEngine<Geometry>::SetObstacleSource(const ObstacleSource* source) {
+  source_ = source;
+  cursor_.index = 0;
+}
+
+/**
+ * Gets how far the board has scrolled through the world since the start of
+ * the run.
+ * @return the world position of the board's left edge, in sub-tiles.
+ */
+template <typename Geometry>
+long long BasicEngine<Geometry>::Scroll() const {
+  return scroll_;
+}
+
+/**
+ * Gets where the obstacle is in the world, rather than on the board.
+ * @return the obstacle's world position, in sub-tiles.
+ */
+template <typename Geometry>
+long long BasicEngine<Geometry>::ObstacleWorldX() const {
+  return scroll_ + obstacle_.x;
+}
+
+/**
+ * Moves the ball along its jump: it's launched upwards from the ground, and
+ * gravity slows it down until it falls back. The launch speed and gravity
+ * are chosen so that the ball rises for JumpTicks() ticks and peaks at the
+ * jump's strength times JumpHeight() tiles above the ground.
+ */
+template <typename Geometry>
+void BasicEngine<Geometry>::Jump() {
+  const int rise_ticks = kGeometry.JumpTicks();
+  const int ground = kGeometry.Ground() * kSubTiles;
+
+  if (ball_.y >= ground && ball_.velocity <= 0) {
+    launch_strength_ = jump_strength_;
+  }
+  // the ball rises by gravity * (rise_ticks + ... + 1) in total
+  const int gravity = 2 * kGeometry.JumpHeight() * kSubTiles
+      * launch_strength_ / 100 / (rise_ticks * (rise_ticks + 1));
+
+  if (ball_.y >= ground && ball_.velocity <= 0) {
+    ball_.velocity = gravity * rise_ticks;
   }
 
-  // create a random seed to generate a random type and a random length
-  std::random_device dev;
-  mt19937 rng(dev());
+  ball_.y -= ball_.velocity;
+  ball_.velocity -= gravity;
+
+  if (ball_.y >= ground) {
+    ball_.y = ground;
+    ball_.velocity = 0;
+    state_ = BallState::kRolling;
+  }
+  ball_.location = { ball_.location.Row(), CeilTile(ball_.y) };
+}
 
-  obstacle_.type = GetObstacleType(rng);
-  obstacle_.length = GetObstacleLength(rng);
-  obstacle_.location = GetObstacleLocation();
+/**
+ * Calculates how fast obstacles move at this point in the run. They start at
+ * one tile per tick, and speed up linearly until they reach MaxSpeed().
+ * @return the speed, in sub-tiles per tick.
+ */
+template <typename Geometry>
+int BasicEngine<Geometry>::ObstacleSpeed() const {
+  if (kGeometry.RampTicks() <= 0) {
+    return kSubTiles;
+  }
+  const long long speed = kSubTiles
+      + static_cast<long long>(kSubTiles) * ticks_ / kGeometry.RampTicks();
+  const long long max_speed = kGeometry.MaxSpeed() * kSubTiles;
+  return static_cast<int>(speed < max_speed ? speed : max_speed);
 }
 
 /**
- * Randomly generates an obstacle type.
- * @param rng the random seed.
- * @return the generated ObstacleType enum.
+ * Creates an obstacle and changes its location on every update. An obstacle
+ * faster than a tile a tick could skip right over the ball between two
+ * checks, so its move is swept a tile at a time, and the ball collides if
+ * it's hit on the way.
  */
-ObstacleType Engine::GetObstacleType(mt19937 rng) {
-  std::uniform_int_distribution<mt19937::result_type> rand_bool(0,1);
+template <typename Geometry>
+void BasicEngine<Geometry>::CreateObstacle() {
+  // make obstacle move towards the ball, as the board scrolls through the
+  // world towards it
+  obstacle_.velocity = ObstacleSpeed();
+  int remaining = obstacle_.velocity;
+  while (remaining > kSubTiles) {
+    obstacle_.x -= kSubTiles;
+    scroll_ += kSubTiles;
+    remaining -= kSubTiles;
+    if (HasCollided()) {
+      state_ = BallState::kCollided;
+      obstacle_.location = { FloorTile(obstacle_.x),
+                             obstacle_.location.Col() };
+      return;
+    }
+  }
+  obstacle_.x -= remaining;
+  scroll_ += remaining;
+  obstacle_.location = { FloorTile(obstacle_.x), obstacle_.location.Col() };
 
-  if (rand_bool(rng)) {
-    return ObstacleType::kHigh;
+  // if the obstacle hasn't reached the end of the screen, return
+  if (obstacle_.location.Row() > -(obstacle_.length) - 1) {
+    return;
   }
-  return ObstacleType::kLow;
+
+  NextObstacle();
 }
 
 /**
- * Calculates the obstacle's next location.
- * @return the obstacle location.
+ * Replaces the obstacle with the next one from the source, or a random one
+ * once the source has run out. It's placed where the source put it in the
+ * world, but never before the right edge of the board. Once obstacles are
+ * fast enough, the next one is also held back until the ball has had time
+ * for a whole jump after the last one passed it, so that back-to-back low
+ * obstacles can always be jumped. One too far away for its position to fit
+ * is brought closer.
  */
-Location Engine::GetObstacleLocation() {
+template <typename Geometry>
+void BasicEngine<Geometry>::NextObstacle() {
+  // the last obstacle's end, and the ticks from take-off to landing
+  const long long last_end = scroll_ + obstacle_.x
+      + static_cast<long long>(obstacle_.length - 1) * kSubTiles;
+  const long long jump_ticks = 2 * kGeometry.JumpTicks() + 1;
+  // the ball is a tile wide, so the gap has to be a tile wider again
+  const long long earliest_x = std::max(
+      scroll_ + static_cast<long long>(kGeometry.Width()) * kSubTiles,
+      last_end + 2 * kSubTiles + jump_ticks * ObstacleSpeed());
+  WorldObstacle next;
+  if (source_ == nullptr || !source_->Next(earliest_x, &cursor_, &next)) {
+    random_obstacles_.Next(earliest_x, &cursor_, &next);
+  }
+
+  obstacle_.type = next.type;
+  obstacle_.length = next.length;
+  obstacle_.x = static_cast<int>(std::min(
+      std::max(next.x, earliest_x) - scroll_, kMaxObstacleX));
   if (obstacle_.type == ObstacleType::kHigh) {
-    return { kWindowWidth, kMinHeight - obstacle_.kHeight - 1 };
+    obstacle_.location = { FloorTile(obstacle_.x), kGeometry.Ground()
+                           - kGeometry.ObstacleHeight() - 1 };
   } else {
-    return { kWindowWidth, kMinHeight };
+    obstacle_.location = { FloorTile(obstacle_.x), kGeometry.Ground() };
+  }
+}
+
+/**
+ * Calculates the ball's shape, as it's drawn: a circle that fills its tile,
+ * flattened into an ellipse on the ground while ducking.
+ * @return the ball's shape, in tiles.
+ */
+template <typename Geometry>
+Ellipse BasicEngine<Geometry>::BallShape() const {
+  const float radius = 0.5f;
+  const float ducking_radius = 0.125f;
+  const float center_x = static_cast<float>(ball_.location.Row()) + radius;
+  const float bottom = static_cast<float>(ball_.y) / kSubTiles;
+
+  if (state_ == BallState::kDucking) {
+    return { center_x, bottom - ducking_radius, radius, ducking_radius };
   }
+  return { center_x, bottom - radius, radius, radius };
 }
 
 /**
- * Randomly generates the obstacle's length.
- * @param rng the random seed.
- * @return the generated length.
+ * Calculates the shape of one of the obstacle's spikes, as it's drawn. Low
+ * spikes stand on the ground, and high spikes hang down towards it. The solid
+ * block above high spikes isn't included, since the ball can't reach it
+ * without going through the spikes first.
+ * @param index which spike, counting from the one closest to the ball.
+ * @return the spike's shape, in tiles.
  */
-int Engine::GetObstacleLength(mt19937 rng) {
-  std::uniform_int_distribution<mt19937::result_type> rand_length(
-      obstacle_.kMinLength, obstacle_.kMaxLength);
-  return rand_length(rng);
+template <typename Geometry>
+Triangle BasicEngine<Geometry>::SpikeShape(int index) const {
+  const float right = static_cast<float>(obstacle_.x) / kSubTiles
+      + static_cast<float>(index);
+  const float ground = static_cast<float>(kGeometry.Ground());
+  const float height = static_cast<float>(kGeometry.ObstacleHeight());
+
+  if (obstacle_.type == ObstacleType::kHigh) {
+    const float base = ground - height - 0.5f;
+    return { right, base, right - 1, base, right - 0.5f, ground - 0.5f };
+  }
+  return { right, ground, right - 1, ground, right - 0.5f, ground - height };
 }
 
 /**
- * Checks if the ball has collided with an obstacle or not.
+ * Checks if the ball has collided with an obstacle or not. The spikes that
+ * could be touching the ball are found from the ball's bounding box first,
+ * so only those few are tested against the ball's exact shape, no matter how
+ * long the obstacle is.
  * @return true if a collision has occurred, false otherwise.
  */
-bool Engine::HasCollided() {
-  int obstacle_x = obstacle_.location.Row();
-  int ball_x = ball_.location.Row();
+template <typename Geometry>
+bool BasicEngine<Geometry>::HasCollided() {
+  const Ellipse ball = BallShape();
+  const float ball_left = ball.center_x - ball.radius_x;
+  const float ball_right = ball.center_x + ball.radius_x;
+
+  // the obstacle's first spike starts one tile before its position
+  const float obstacle_start = static_cast<float>(obstacle_.x) / kSubTiles - 1;
+  const int first_spike = std::max(0, static_cast<int>(
+      std::floor(ball_left - obstacle_start)));
+  const int last_spike = std::min(obstacle_.length - 1, static_cast<int>(
+      std::ceil(ball_right - obstacle_start)) - 1);
 
   // return false if the obstacle isn't within the range of the ball
-  if (obstacle_x - 1 > ball_x || obstacle_x - 1 <= ball_x - obstacle_.length) {
+  if (first_spike > last_spike) {
     return false;
   }
 
-  switch (obstacle_.type) {
-    case ObstacleType::kHigh: {
-      return state_ != BallState::kDucking;
-    }
-
-    case ObstacleType::kLow: {
-      return ball_.location.Col() >= kMinHeight - obstacle_.kHeight;
-    }
+  TriangleBatch spikes;
+  for (int index = first_spike; index <= last_spike; index++) {
+    spikes.Add(SpikeShape(index));
   }
+  return Intersects(ball, spikes);
 }
 
 /**
- * Resets the Engine's state and all locations.
+ * Resets the Engine's state and all locations, and goes back to the start
+ * of its obstacle source.
  */
-void Engine::Reset() {
+template <typename Geometry>
+void BasicEngine<Geometry>::Reset() {
   state_ = BallState::kRolling;
-  reached_max_height_ = false;
-  ball_.location = { ball_.location.Row(), kMinHeight };
-  obstacle_.location = { kWindowWidth, kMinHeight };
+  ticks_ = 0;
+  scroll_ = 0;
+  cursor_.index = 0;
+  ball_.location = { ball_.location.Row(), kGeometry.Ground() };
+  ball_.y = kGeometry.Ground() * kSubTiles;
+  ball_.velocity = 0;
+  obstacle_.location = { kGeometry.Width(), kGeometry.Ground() };
+  obstacle_.x = kGeometry.Width() * kSubTiles;
 }
+
+// The geometries the library is built with. To specialize the Engine for
+// another board, add its geometry here.
+template class BasicEngine<RuntimeGeometry>;
+template class BasicEngine<DefaultGeometry>;
+
 }  // namespace screamy-ball
@@ -2,6 +2,7 @@
 
 #include <screamy-ball/leaderboard.h>
 #include <screamy-ball/player.h>
+#include <screamy-ball/tracer.h>
 #include <sqlite_modern_cpp.h>
 
 #include <string>
@@ -17,6 +18,7 @@ using std::vector;
  * @param db_path the path to the database.
  */
 Leaderboard::Leaderboard(const string& db_path) : database_(db_path) {
+  TraceScope trace("create table", "sqlite");
   database_ << "CREATE TABLE if not exists leaderboard (\n"
          "  name  TEXT NOT NULL,\n"
          " elapsed_time TEXT NOT NULL\n"
@@ -28,11 +30,36 @@ Leaderboard::Leaderboard(const string& db_path) : database_(db_path) {
  * @param player the player whose name and time is being added.
  */
 void Leaderboard::AddScoreToLeaderboard(const Player& player) {
+  TraceScope trace("insert score", "sqlite");
   database_ << "INSERT INTO leaderboard (name, elapsed_time) "
                "\nVALUES (?, ?);"
             << player.name << player.elapsed_time;
 }
 
+/**
+ * Adds many players to the leaderboard at once, in a single transaction,
+ * which is much faster than adding them one at a time. If any of them can't
+ * be added, none of them are.
+ * @param players the players whose names and times are being added.
+ * @throws sqlite::sqlite_exception if a player couldn't be added.
+ */
+void Leaderboard::AddScoresToLeaderboard(const vector<Player>& players) {
+  TraceScope trace("insert scores", "sqlite");
+  database_ << "BEGIN;";
+  try {
+    for (const Player& player : players) {
+      database_ << "INSERT INTO leaderboard (name, elapsed_time) "
+                   "\nVALUES (?, ?);"
+                << player.name << player.elapsed_time;
+    }
+    database_ << "COMMIT;";
+  } catch (...) {
+    // otherwise the transaction stays open, and every later query is in it
+    database_ << "ROLLBACK;";
+    throw;
+  }
+}
+
 vector<Player> GetPlayers(sqlite::database_binder* rows) {
   vector<Player> players;
 
@@ -54,6 +81,7 @@ vector<Player> GetPlayers(sqlite::database_binder* rows) {
  * @return a vector containing the list of players with the highest scores.
  */
 vector<Player> Leaderboard::RetrieveHighScores(const size_t limit) {
+  TraceScope trace("select high scores", "sqlite");
   auto rows = database_ << "SELECT * "
                      "\nFROM leaderboard "
                      "\nORDER BY \nelapsed_time DESC "
@@ -71,6 +99,7 @@ vector<Player> Leaderboard::RetrieveHighScores(const size_t limit) {
  */
 vector<Player> Leaderboard::RetrieveHighScores(const Player& player,
                                                const size_t limit) {
+  TraceScope trace("select player scores", "sqlite");
   auto rows = database_ << "SELECT * \nFROM leaderboard "
                      "\nWHERE name = ? "
                      "\nORDER BY \nelapsed_time DESC "
@@ -82,6 +111,7 @@ vector<Player> Leaderboard::RetrieveHighScores(const Player& player,
  * Deletes all records in the leaderboard.
  */
 void Leaderboard::Reset() {
+  TraceScope trace("reset", "sqlite");
   database_ << "DELETE \nFROM leaderboard";
 }
 
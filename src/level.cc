@@ -0,0 +1,466 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/level.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define SCREAMY_BALL_READ_LEVEL
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace screamy_ball {
+
+const char kLevelMagic[] = "SBLEVEL1";
+const size_t kLevelMagicSize = 8;
+const uint32_t kLevelVersion = 2;
+// the magic, the version, the chunks' width in tiles, the number of chunks
+// and of obstacles, and the index's offset
+const size_t kLevelHeaderSize = kLevelMagicSize + 4 + 4 + 8 + 8 + 8;
+// an obstacle's position from the start of its chunk in sub-tiles, its
+// type, its length, and two spare bytes
+const size_t kObstacleRecordSize = 4 + 1 + 1 + 2;
+// a chunk's offset, the index of its first obstacle, its number of
+// obstacles, and its longest obstacle's length, so every obstacle's length
+// is checked from the index alone
+const size_t kChunkRecordSize = 8 + 8 + 4 + 4;
+const uint8_t kHighKind = 0;
+const uint8_t kLowKind = 1;
+const int kMaxLevelObstacleLength = 255;
+
+const long long Level::kChunksAhead;
+const long long Level::kChunksBehind;
+
+/**
+ * Appends a field to a level. Fields are stored in the host's byte order,
+ * which is little-endian on every platform the game runs on, so they can be
+ * read straight from the mapping.
+ */
+template <typename T>
+void AppendField(std::string* output, T value) {
+  output->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * Reads a field from a level. The fields aren't aligned, so they're copied
+ * out rather than read in place.
+ */
+template <typename T>
+T LoadField(const char* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+/**
+ * Creates a level with no obstacles.
+ * @param chunk_tiles the width of the level's chunks, in tiles. Chunks are
+ * streamed in whole, so they should be about as wide as the board.
+ * @throws std::invalid_argument if the width isn't positive.
+ */
+LevelWriter::LevelWriter(int chunk_tiles) : kChunkTiles(chunk_tiles) {
+  if (chunk_tiles <= 0) {
+    throw std::invalid_argument("A level's chunks must have a width");
+  }
+}
+
+/**
+ * Adds an obstacle. Obstacles can be added in any order.
+ * @param obstacle the obstacle, whose position is in sub-tiles from the
+ * start of the level.
+ * @throws std::invalid_argument if it's before the start of the level, or
+ * it's longer than a chunk, or its length can't be stored.
+ */
+void LevelWriter::Add(const WorldObstacle& obstacle) {
+  if (obstacle.x < 0) {
+    throw std::invalid_argument("An obstacle is before the start of the "
+                                "level");
+  }
+  const int max_length = std::min(kChunkTiles, kMaxLevelObstacleLength);
+  if (obstacle.length < 1 || obstacle.length > max_length) {
+    throw std::invalid_argument("An obstacle must have from 1 to "
+                                + std::to_string(max_length)
+                                + " spikes, to fit in a chunk");
+  }
+  obstacles_.push_back(obstacle);
+}
+
+/**
+ * Writes the level. Every chunk up to the last obstacle's is in the index,
+ * even if it's empty, so a chunk's entry is found from its position alone.
+ * @param output the level's file, opened in binary mode.
+ */
+void LevelWriter::Write(std::ostream& output) const {
+  std::vector<WorldObstacle> obstacles = obstacles_;
+  std::stable_sort(obstacles.begin(), obstacles.end(),
+                   [](const WorldObstacle& lhs, const WorldObstacle& rhs) {
+                     return lhs.x < rhs.x; });
+  const long long chunk_width = static_cast<long long>(kChunkTiles)
+      * kSubTiles;
+  const long long chunks = obstacles.empty()
+      ? 0 : obstacles.back().x / chunk_width + 1;
+
+  std::string body;
+  std::string index;
+  size_t next = 0;
+  for (long long chunk = 0; chunk < chunks; chunk++) {
+    const size_t first = next;
+    int longest = 0;
+    AppendField<uint64_t>(&index, kLevelHeaderSize + body.size());
+    AppendField<uint64_t>(&index, first);
+    for (; next < obstacles.size()
+           && obstacles[next].x < (chunk + 1) * chunk_width; next++) {
+      const WorldObstacle& obstacle = obstacles[next];
+      longest = std::max(longest, obstacle.length);
+      AppendField(&body, static_cast<uint32_t>(obstacle.x
+                                               - chunk * chunk_width));
+      AppendField(&body, obstacle.type == ObstacleType::kHigh ? kHighKind
+                                                              : kLowKind);
+      AppendField(&body, static_cast<uint8_t>(obstacle.length));
+      AppendField<uint16_t>(&body, 0);
+    }
+    AppendField(&index, static_cast<uint32_t>(next - first));
+    AppendField(&index, static_cast<uint32_t>(longest));
+  }
+
+  std::string header(kLevelMagic, kLevelMagicSize);
+  AppendField(&header, kLevelVersion);
+  AppendField(&header, static_cast<uint32_t>(kChunkTiles));
+  AppendField(&header, static_cast<uint64_t>(chunks));
+  AppendField(&header, static_cast<uint64_t>(obstacles.size()));
+  AppendField<uint64_t>(&header, kLevelHeaderSize + body.size());
+  output.write(header.data(), static_cast<std::streamsize>(header.size()));
+  output.write(body.data(), static_cast<std::streamsize>(body.size()));
+  output.write(index.data(), static_cast<std::streamsize>(index.size()));
+}
+
+/**
+ * Counts the obstacles added so far.
+ * @return the number of obstacles.
+ */
+size_t LevelWriter::Size() const {
+  return obstacles_.size();
+}
+
+/**
+ * Maps a level into memory, and checks its index. None of its chunks are
+ * read until they're streamed in or an obstacle is taken from them.
+ * @param path the level's file.
+ * @throws std::runtime_error if the level can't be opened.
+ * @throws std::invalid_argument if the file isn't a valid level.
+ */
+Level::Level(const std::string& path) :
+    data_(nullptr),
+    size_(0),
+    page_size_(4096),
+    chunk_tiles_(0),
+    chunks_(0),
+    obstacles_(0),
+    longest_(0),
+    index_(nullptr),
+    first_resident_(0),
+    end_resident_(0) {
+#if defined(SCREAMY_BALL_READ_LEVEL)
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("Couldn't open the level " + path);
+  }
+  copy_.assign(std::istreambuf_iterator<char>(input),
+               std::istreambuf_iterator<char>());
+  data_ = copy_.data();
+  size_ = copy_.size();
+#else
+  page_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw std::runtime_error("Couldn't open the level " + path);
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0 || status.st_size < 0) {
+    close(file);
+    throw std::runtime_error("Couldn't read the level " + path);
+  }
+  size_ = static_cast<size_t>(status.st_size);
+  if (size_ > 0) {
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0);
+    if (mapping == MAP_FAILED) {
+      close(file);
+      throw std::runtime_error("Couldn't map the level " + path);
+    }
+    data_ = static_cast<const char*>(mapping);
+  }
+  // the mapping stays valid once the file is closed
+  close(file);
+#endif
+
+  try {
+    ReadIndex();
+  } catch (...) {
+    Unmap();
+    throw;
+  }
+}
+
+Level::~Level() {
+  Unmap();
+}
+
+void Level::Unmap() {
+#if !defined(SCREAMY_BALL_READ_LEVEL)
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+/**
+ * Reads the level's header, and checks that every chunk is inside the level,
+ * that the index counts its obstacles in order, and that no chunk has an
+ * obstacle longer than the chunk.
+ * @throws std::invalid_argument if the level isn't valid.
+ */
+void Level::ReadIndex() {
+  if (size_ < kLevelHeaderSize
+      || std::memcmp(data_, kLevelMagic, kLevelMagicSize) != 0) {
+    throw std::invalid_argument("Not a level");
+  }
+  if (LoadField<uint32_t>(data_ + kLevelMagicSize) != kLevelVersion) {
+    throw std::invalid_argument("The level's version isn't supported");
+  }
+  const uint32_t chunk_tiles = LoadField<uint32_t>(data_ + 12);
+  const uint64_t chunks = LoadField<uint64_t>(data_ + 16);
+  const uint64_t obstacles = LoadField<uint64_t>(data_ + 24);
+  const uint64_t index_offset = LoadField<uint64_t>(data_ + 32);
+  if (chunk_tiles == 0 || chunk_tiles > 1u << 20) {
+    throw std::invalid_argument("The level's chunks are too narrow or too "
+                                "wide");
+  }
+  if (index_offset < kLevelHeaderSize || index_offset > size_
+      || chunks > (size_ - index_offset) / kChunkRecordSize) {
+    throw std::invalid_argument("The level's index is past its end");
+  }
+
+  uint64_t next = 0;
+  uint64_t end_offset = kLevelHeaderSize;
+  uint32_t level_longest = 0;
+  for (uint64_t chunk = 0; chunk < chunks; chunk++) {
+    const char* record = data_ + index_offset + chunk * kChunkRecordSize;
+    const uint64_t offset = LoadField<uint64_t>(record);
+    const uint64_t first = LoadField<uint64_t>(record + 8);
+    const uint32_t count = LoadField<uint32_t>(record + 16);
+    const uint32_t longest = LoadField<uint32_t>(record + 20);
+    if (first != next || offset != end_offset) {
+      throw std::invalid_argument("The level's chunks are out of order");
+    }
+    if (longest > chunk_tiles
+        || longest > static_cast<uint32_t>(kMaxLevelObstacleLength)
+        || (count > 0 && longest == 0)) {
+      throw std::invalid_argument("The level has an obstacle longer than "
+                                  "its chunks");
+    }
+    level_longest = std::max(level_longest, longest);
+    next += count;
+    end_offset += static_cast<uint64_t>(count) * kObstacleRecordSize;
+  }
+  if (next != obstacles || end_offset != index_offset) {
+    throw std::invalid_argument("The level's index doesn't match its "
+                                "obstacles");
+  }
+
+  chunk_tiles_ = static_cast<int>(chunk_tiles);
+  chunks_ = static_cast<long long>(chunks);
+  obstacles_ = static_cast<size_t>(obstacles);
+  longest_ = static_cast<int>(level_longest);
+  index_ = data_ + index_offset;
+}
+
+/**
+ * Takes the next obstacle in the level, wherever it was placed. The Engine
+ * moves it to the right edge of the board if it's behind that.
+ * @return false once the level's obstacles have all been taken.
+ */
+bool Level::Next(long long /* earliest_x */, ObstacleCursor* cursor,
+                 WorldObstacle* obstacle) const {
+  if (cursor->index >= obstacles_) {
+    return false;
+  }
+  *obstacle = At(cursor->index++);
+  return true;
+}
+
+/**
+ * Reads one of the level's obstacles from its chunk.
+ * @param index the obstacle, counting from the start of the level, which
+ * must be less than Size().
+ * @return the obstacle, at its position in the world.
+ */
+WorldObstacle Level::At(size_t index) const {
+  const long long chunk = ChunkOfIndex(index);
+  const char* entry = index_ + chunk * static_cast<long long>(kChunkRecordSize);
+  const uint64_t first = LoadField<uint64_t>(entry + 8);
+  const char* record = data_ + LoadField<uint64_t>(entry)
+      + (index - first) * kObstacleRecordSize;
+
+  const long long chunk_width = static_cast<long long>(chunk_tiles_)
+      * kSubTiles;
+  const auto kind = static_cast<uint8_t>(record[4]);
+  const auto length = static_cast<uint8_t>(record[5]);
+  // the index was checked when the level was opened, so a length that
+  // disagrees with it is kept to what was checked
+  const auto longest = static_cast<int>(LoadField<uint32_t>(entry + 20));
+  return { chunk * chunk_width + LoadField<uint32_t>(record),
+           kind == kHighKind ? ObstacleType::kHigh : ObstacleType::kLow,
+           std::min(std::max(1, static_cast<int>(length)), longest) };
+}
+
+/**
+ * Finds the chunk an obstacle is in, by searching the index for the first
+ * chunk that ends after it.
+ * @param index the obstacle.
+ * @return the chunk.
+ */
+long long Level::ChunkOfIndex(size_t index) const {
+  long long low = 0;
+  long long high = chunks_ - 1;
+  while (low < high) {
+    const long long middle = low + (high - low) / 2;
+    const char* entry = index_ + middle
+        * static_cast<long long>(kChunkRecordSize);
+    const uint64_t end = LoadField<uint64_t>(entry + 8)
+        + LoadField<uint32_t>(entry + 16);
+    if (end > index) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return low;
+}
+
+/**
+ * Keeps the chunks around the camera in memory. The chunks just ahead of it
+ * are read in before the Engine reaches them, and the ones that it has left
+ * behind are let go, so their pages can be reused. This is only a hint to
+ * the system: a chunk that's been let go is read in again if it's used.
+ * @param camera_x the world position of the camera's left edge, in
+ * sub-tiles.
+ */
+void Level::Stream(long long camera_x) {
+  const long long chunk_width = static_cast<long long>(chunk_tiles_)
+      * kSubTiles;
+  const long long chunk = std::max(0LL, camera_x) / chunk_width;
+  const long long first = std::min(chunks_,
+                                   std::max(0LL, chunk - kChunksBehind));
+  const long long end = std::min(chunks_, chunk + kChunksAhead + 1);
+
+  if (first > first_resident_) {
+    Advise(first_resident_, std::min(first, end_resident_), false);
+  }
+  if (end < end_resident_) {
+    Advise(std::max(end, first_resident_), end_resident_, false);
+  }
+  if (first < first_resident_) {
+    Advise(first, std::min(first_resident_, end), true);
+  }
+  if (end > end_resident_) {
+    Advise(std::max(end_resident_, first), end, true);
+  }
+  first_resident_ = first;
+  end_resident_ = end;
+}
+
+/**
+ * Tells the system whether a run of chunks is about to be used. Pages that
+ * are partly in a chunk that's still needed are never let go.
+ * @param first_chunk the first chunk.
+ * @param end_chunk the chunk after the last one.
+ * @param will_need true to read the chunks in, false to let them go.
+ */
+void Level::Advise(long long first_chunk, long long end_chunk,
+                   bool will_need) {
+  if (first_chunk >= end_chunk) {
+    return;
+  }
+  const auto record_size = static_cast<long long>(kChunkRecordSize);
+  const char* last = index_ + (end_chunk - 1) * record_size;
+  size_t start = static_cast<size_t>(
+      LoadField<uint64_t>(index_ + first_chunk * record_size));
+  size_t stop = static_cast<size_t>(LoadField<uint64_t>(last)
+      + LoadField<uint32_t>(last + 16) * kObstacleRecordSize);
+  if (will_need) {
+    start = start / page_size_ * page_size_;
+    stop = std::min(size_, (stop + page_size_ - 1) / page_size_ * page_size_);
+  } else {
+    start = (start + page_size_ - 1) / page_size_ * page_size_;
+    stop = stop / page_size_ * page_size_;
+  }
+  if (start >= stop) {
+    return;
+  }
+
+#if !defined(SCREAMY_BALL_READ_LEVEL)
+  madvise(const_cast<char*>(data_) + start, stop - start,
+          will_need ? MADV_WILLNEED : MADV_DONTNEED);
+#endif
+}
+
+/**
+ * Gets the width of the level's chunks.
+ * @return the width, in tiles.
+ */
+int Level::ChunkTiles() const {
+  return chunk_tiles_;
+}
+
+/**
+ * Counts the level's chunks, up to the one with its last obstacle.
+ * @return the number of chunks.
+ */
+long long Level::Chunks() const {
+  return chunks_;
+}
+
+/**
+ * Counts the level's obstacles.
+ * @return the number of obstacles.
+ */
+size_t Level::Size() const {
+  return obstacles_;
+}
+
+/**
+ * Gets the length of the level's longest obstacle, from its index.
+ * @return the length, in spikes, or 0 if the level has no obstacles.
+ */
+int Level::LongestObstacle() const {
+  return longest_;
+}
+
+/**
+ * Gets the first chunk that's been streamed in.
+ * @return the chunk.
+ */
+long long Level::FirstResidentChunk() const {
+  return first_resident_;
+}
+
+/**
+ * Gets the chunk after the last one that's been streamed in.
+ * @return the chunk.
+ */
+long long Level::EndResidentChunk() const {
+  return end_resident_;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,257 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/music_stream.h>
+#include <screamy-ball/tracer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace screamy_ball {
+
+// how many frames are decoded, and mixed, at a time
+const size_t kDecodeFrames = 1024;
+const size_t kMixFrames = 512;
+const float kHalfPi = 1.57079632679f;
+
+/**
+ * Finds where a track loops, within the track.
+ * @param loop the loop points that were asked for.
+ * @param frames the track's length.
+ * @return the frame the loop ends at.
+ */
+size_t LoopEnd(const LoopPoints& loop, size_t frames) {
+  return loop.end == 0 ? frames : std::min(loop.end, frames);
+}
+
+/**
+ * Creates a streamer. Nothing is decoded until Fill() or Start() is called.
+ * @param source the track's decoder, at the output's sample rate.
+ * @param sample_rate the output's sample rate.
+ * @param loop where the track loops. The crossfade is shortened to half the
+ * loop if it's longer.
+ * @param buffer_secs how much is decoded ahead of what's playing.
+ * @throws std::invalid_argument if the loop doesn't fit in the track.
+ */
+MusicStreamer::MusicStreamer(std::unique_ptr<MusicSource> source,
+                             unsigned sample_rate, const LoopPoints& loop,
+                             float buffer_secs) :
+    source_(std::move(source)),
+    kChannels(std::max<size_t>(1, source_->Channels())),
+    kLoopStart(loop.start),
+    kLoopEnd(LoopEnd(loop, source_->Frames())),
+    kCrossfade(kLoopEnd > kLoopStart
+        ? std::min(loop.crossfade, (kLoopEnd - kLoopStart) / 2) : 0),
+    kRefillSecs(buffer_secs / 4),
+    head_(kCrossfade * kChannels),
+    decoded_(kDecodeFrames * kChannels),
+    position_(0),
+    is_primed_(false),
+    ring_(std::max(kDecodeFrames, static_cast<size_t>(
+        buffer_secs * static_cast<float>(sample_rate))) * kChannels),
+    mixed_(kMixFrames * kChannels),
+    loops_(0),
+    underruns_(0),
+    is_stopping_(false) {
+  if (kLoopStart >= kLoopEnd) {
+    throw std::invalid_argument("The music's loop must start before it "
+                                "ends");
+  }
+}
+
+/**
+ * Stops the worker, if it was started.
+ */
+MusicStreamer::~MusicStreamer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  stopping_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+/**
+ * Starts the worker, which keeps the ring buffer full from then on.
+ */
+void MusicStreamer::Start() {
+  worker_ = std::thread(&MusicStreamer::RunWorker, this);
+}
+
+void MusicStreamer::RunWorker() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!is_stopping_) {
+    lock.unlock();
+    Fill();
+    lock.lock();
+    // the audio callback never waits for the worker, so it's woken up on a
+    // timer, often enough that the ring never runs dry
+    stopping_.wait_for(lock, std::chrono::duration<float>(kRefillSecs),
+                       [this]() { return is_stopping_; });
+  }
+}
+
+/**
+ * Decodes until the ring buffer is full. Only one thread may call this: the
+ * worker once it's started, or whoever starts it, to buffer the start of the
+ * track before it plays.
+ * @return the number of frames decoded.
+ */
+size_t MusicStreamer::Fill() {
+  if (!is_primed_) {
+    // the start of the loop is decoded once, to fade into at its end
+    source_->Seek(kLoopStart);
+    size_t primed = 0;
+    while (primed < kCrossfade) {
+      const size_t frames = source_->Read(&head_[primed * kChannels],
+                                          kCrossfade - primed);
+      if (frames == 0) {
+        break;
+      }
+      primed += frames;
+    }
+    source_->Seek(0);
+    is_primed_ = true;
+  }
+
+  size_t total = 0;
+  while (ring_.Space() >= kChannels) {
+    const size_t frames = Decode(decoded_.data(), std::min(
+        kDecodeFrames, ring_.Space() / kChannels));
+    if (frames == 0) {
+      break;
+    }
+    ring_.Write(decoded_.data(), frames * kChannels);
+    total += frames;
+  }
+  return total;
+}
+
+/**
+ * Decodes the next frames of the looping track. The end of the loop is
+ * crossfaded into its start, and then the track carries on from just after
+ * the start, so no frame is played twice.
+ * @param samples where the frames are decoded to, interleaved.
+ * @param frames the most frames to decode.
+ * @return the number of frames decoded.
+ */
+size_t MusicStreamer::Decode(float* samples, size_t frames) {
+  const size_t fade_start = kLoopEnd - kCrossfade;
+  size_t decoded;
+  if (position_ < fade_start) {
+    decoded = source_->Read(samples, std::min(frames,
+                                              fade_start - position_));
+    if (decoded == 0) {
+      // the track is shorter than it said, so it loops from here, without
+      // the crossfade
+      source_->Seek(kLoopStart);
+      position_ = kLoopStart;
+      loops_.fetch_add(1, std::memory_order_relaxed);
+      decoded = source_->Read(samples, std::min(frames,
+                                                fade_start - position_));
+    }
+  } else {
+    decoded = std::min(frames, kLoopEnd - position_);
+    const size_t read = source_->Read(samples, decoded);
+    std::fill(samples + read * kChannels, samples + decoded * kChannels,
+              0.0f);
+    Crossfade(samples, decoded);
+  }
+
+  position_ += decoded;
+  if (position_ >= kLoopEnd) {
+    source_->Seek(kLoopStart + kCrossfade);
+    position_ = kLoopStart + kCrossfade;
+    loops_.fetch_add(1, std::memory_order_relaxed);
+    TraceInstant("music loop", "audio");
+  }
+  return decoded;
+}
+
+/**
+ * Fades the end of the loop out and its start in, keeping the power the
+ * same throughout.
+ * @param samples the frames at the end of the loop, from position_ on.
+ * @param frames the number of frames.
+ */
+void MusicStreamer::Crossfade(float* samples, size_t frames) const {
+  const size_t offset = position_ - (kLoopEnd - kCrossfade);
+  for (size_t frame = 0; frame < frames; frame++) {
+    const float progress = (static_cast<float>(offset + frame) + 0.5f)
+        / static_cast<float>(kCrossfade);
+    const float fade_out = std::cos(progress * kHalfPi);
+    const float fade_in = std::sin(progress * kHalfPi);
+    for (size_t channel = 0; channel < kChannels; channel++) {
+      float& sample = samples[frame * kChannels + channel];
+      sample = sample * fade_out
+          + head_[(offset + frame) * kChannels + channel] * fade_in;
+    }
+  }
+}
+
+/**
+ * Plays the next frames from the ring buffer, from the audio callback. This
+ * never waits or allocates: if the worker has fallen behind, the rest of the
+ * block is silent, and counted. Output channels past the track's channels
+ * repeat the track's channels.
+ * @param output where to write the audio, with every channel's frames one
+ * after another.
+ * @param channels the number of output channels.
+ * @param frames the number of frames in each output channel.
+ */
+void MusicStreamer::Mix(float* output, size_t channels, size_t frames) {
+  size_t done = 0;
+  while (done < frames) {
+    const size_t chunk = std::min(frames - done, kMixFrames);
+    const size_t read = ring_.Read(mixed_.data(), chunk * kChannels)
+        / kChannels;
+    for (size_t channel = 0; channel < channels; channel++) {
+      float* destination = output + channel * frames + done;
+      const size_t source = channel % kChannels;
+      for (size_t frame = 0; frame < read; frame++) {
+        destination[frame] = mixed_[frame * kChannels + source];
+      }
+    }
+    done += read;
+
+    if (read < chunk) {
+      for (size_t channel = 0; channel < channels; channel++) {
+        std::fill(output + channel * frames + done,
+                  output + (channel + 1) * frames, 0.0f);
+      }
+      underruns_.fetch_add(frames - done, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+/**
+ * Gets the number of channels in the track.
+ * @return the number of channels.
+ */
+size_t MusicStreamer::Channels() const {
+  return kChannels;
+}
+
+/**
+ * Gets the number of times the track has looped, as it's decoded.
+ * @return the number of loops.
+ */
+size_t MusicStreamer::Loops() const {
+  return loops_.load(std::memory_order_relaxed);
+}
+
+/**
+ * Gets the number of frames that were silent because the worker had fallen
+ * behind.
+ * @return the number of frames.
+ */
+size_t MusicStreamer::Underruns() const {
+  return underruns_.load(std::memory_order_relaxed);
+}
+
+}  // namespace screamy_ball
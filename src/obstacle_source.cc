@@ -0,0 +1,33 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/obstacle_source.h>
+
+namespace screamy_ball {
+
+/**
+ * Creates a source of random obstacles.
+ * @param min_length the fewest spikes an obstacle can have.
+ * @param max_length the most spikes an obstacle can have.
+ */
+RandomObstacles::RandomObstacles(int min_length, int max_length) :
+    min_length_(min_length),
+    max_length_(max_length) {}
+
+/**
+ * Randomly generates an obstacle at the right edge of the board. Random
+ * obstacles never run out.
+ */
+bool RandomObstacles::Next(long long earliest_x, ObstacleCursor* cursor,
+                           WorldObstacle* obstacle) const {
+  std::uniform_int_distribution<std::minstd_rand::result_type> rand_bool(
+      0, 1);
+  obstacle->x = earliest_x;
+  obstacle->type = rand_bool(cursor->rng) ? ObstacleType::kHigh
+                                          : ObstacleType::kLow;
+  std::uniform_int_distribution<int> rand_length(min_length_, max_length_);
+  obstacle->length = rand_length(cursor->rng);
+  cursor->index++;
+  return true;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,211 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/particles.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCREAMY_BALL_SSE2
+#endif
+
+namespace screamy_ball {
+
+// the fraction of its speed a particle keeps after a second, from air drag
+const float kDrag = 0.25f;
+
+/**
+ * Rounds a number of particles up to a whole number of SIMD lanes.
+ * @param count the number of particles.
+ * @return the count, rounded up to a multiple of four.
+ */
+size_t PadToLanes(size_t count) {
+  return (count + 3) / 4 * 4;
+}
+
+/**
+ * Creates an empty pool of particles.
+ * @param capacity the most particles that can be alive at once.
+ * @param seed the seed for the bursts' random directions and speeds.
+ */
+ParticleSystem::ParticleSystem(size_t capacity, unsigned seed) :
+    kCapacity(capacity),
+    x_(PadToLanes(capacity)),
+    y_(PadToLanes(capacity)),
+    velocity_x_(PadToLanes(capacity)),
+    velocity_y_(PadToLanes(capacity)),
+    gravity_(PadToLanes(capacity)),
+    life_(PadToLanes(capacity)),
+    inverse_life_(PadToLanes(capacity)),
+    kind_(PadToLanes(capacity)),
+    size_(0),
+    dropped_(0),
+    rng_(seed) {}
+
+/**
+ * Throws out a burst of particles. Once the pool is half full, bursts are
+ * thinned out in proportion to how much room is left, so it never has to
+ * cut a burst off all at once.
+ * @param burst the burst. Its min_speed must be at most its max_speed.
+ * @return the number of particles emitted.
+ */
+size_t ParticleSystem::Emit(const Burst& burst) {
+  if (!(burst.life_secs > 0)) {
+    return 0;
+  }
+  const size_t soft_limit = kCapacity / 2;
+  size_t count = burst.count;
+  if (size_ > soft_limit) {
+    count = count * (kCapacity - size_) / (kCapacity - soft_limit);
+  }
+  count = std::min(count, kCapacity - size_);
+  dropped_ += burst.count - count;
+
+  std::uniform_real_distribution<float> speed(burst.min_speed,
+                                              burst.max_speed);
+  std::uniform_real_distribution<float> angle(burst.angle - burst.spread,
+                                              burst.angle + burst.spread);
+  for (size_t particle = size_; particle < size_ + count; particle++) {
+    const float direction = angle(rng_);
+    const float particle_speed = speed(rng_);
+    x_[particle] = burst.x;
+    y_[particle] = burst.y;
+    // the angle goes anticlockwise on the screen, where y grows downwards
+    velocity_x_[particle] = std::cos(direction) * particle_speed;
+    velocity_y_[particle] = -std::sin(direction) * particle_speed;
+    gravity_[particle] = burst.gravity;
+    life_[particle] = burst.life_secs;
+    inverse_life_[particle] = 1 / burst.life_secs;
+    kind_[particle] = static_cast<float>(burst.kind);
+  }
+  size_ += count;
+  return count;
+}
+
+/**
+ * Moves every particle on by some time, and removes the ones whose lives
+ * are over. The last particle is moved into each removed one's place, so
+ * the live particles stay packed at the front of the arrays.
+ * @param secs the time since the last update.
+ */
+void ParticleSystem::Update(float secs) {
+  const float drag = std::pow(kDrag, secs);
+  const size_t lanes = PadToLanes(size_);
+  size_t particle = 0;
+
+#ifdef SCREAMY_BALL_SSE2
+  const __m128 step = _mm_set1_ps(secs);
+  const __m128 drags = _mm_set1_ps(drag);
+  for (; particle < lanes; particle += 4) {
+    __m128 velocity_x = _mm_loadu_ps(&velocity_x_[particle]);
+    __m128 velocity_y = _mm_add_ps(_mm_loadu_ps(&velocity_y_[particle]),
+        _mm_mul_ps(_mm_loadu_ps(&gravity_[particle]), step));
+    _mm_storeu_ps(&x_[particle], _mm_add_ps(_mm_loadu_ps(&x_[particle]),
+                                            _mm_mul_ps(velocity_x, step)));
+    _mm_storeu_ps(&y_[particle], _mm_add_ps(_mm_loadu_ps(&y_[particle]),
+                                            _mm_mul_ps(velocity_y, step)));
+    _mm_storeu_ps(&velocity_x_[particle], _mm_mul_ps(velocity_x, drags));
+    _mm_storeu_ps(&velocity_y_[particle], _mm_mul_ps(velocity_y, drags));
+    _mm_storeu_ps(&life_[particle],
+                  _mm_sub_ps(_mm_loadu_ps(&life_[particle]), step));
+  }
+#endif
+
+  for (; particle < lanes; particle++) {
+    velocity_y_[particle] += gravity_[particle] * secs;
+    x_[particle] += velocity_x_[particle] * secs;
+    y_[particle] += velocity_y_[particle] * secs;
+    velocity_x_[particle] *= drag;
+    velocity_y_[particle] *= drag;
+    life_[particle] -= secs;
+  }
+
+  for (particle = 0; particle < size_;) {
+    if (life_[particle] > 0) {
+      particle++;
+      continue;
+    }
+    const size_t last = --size_;
+    x_[particle] = x_[last];
+    y_[particle] = y_[last];
+    velocity_x_[particle] = velocity_x_[last];
+    velocity_y_[particle] = velocity_y_[last];
+    gravity_[particle] = gravity_[last];
+    life_[particle] = life_[last];
+    inverse_life_[particle] = inverse_life_[last];
+    kind_[particle] = kind_[last];
+  }
+}
+
+/**
+ * Removes every particle.
+ */
+void ParticleSystem::Clear() {
+  size_ = 0;
+}
+
+/**
+ * Writes the live particles out for an instanced draw, each as its x, its
+ * y, the fraction of its life it has left and its kind.
+ * @param instances where the particles are written, which must have room
+ * for kInstanceFloats * Capacity() floats.
+ * @return the number of particles written.
+ */
+size_t ParticleSystem::WriteInstances(float* instances) const {
+  size_t particle = 0;
+
+#ifdef SCREAMY_BALL_SSE2
+  // four particles' fields are loaded as four columns, and transposed into
+  // four rows, one per particle
+  for (; particle + 4 <= size_; particle += 4) {
+    __m128 x = _mm_loadu_ps(&x_[particle]);
+    __m128 y = _mm_loadu_ps(&y_[particle]);
+    __m128 left = _mm_mul_ps(_mm_loadu_ps(&life_[particle]),
+                             _mm_loadu_ps(&inverse_life_[particle]));
+    __m128 kind = _mm_loadu_ps(&kind_[particle]);
+    _MM_TRANSPOSE4_PS(x, y, left, kind);
+    float* instance = instances + particle * kInstanceFloats;
+    _mm_storeu_ps(instance, x);
+    _mm_storeu_ps(instance + 4, y);
+    _mm_storeu_ps(instance + 8, left);
+    _mm_storeu_ps(instance + 12, kind);
+  }
+#endif
+
+  for (; particle < size_; particle++) {
+    float* instance = instances + particle * kInstanceFloats;
+    instance[0] = x_[particle];
+    instance[1] = y_[particle];
+    instance[2] = life_[particle] * inverse_life_[particle];
+    instance[3] = kind_[particle];
+  }
+  return size_;
+}
+
+/**
+ * Gets the number of live particles.
+ * @return the number of particles.
+ */
+size_t ParticleSystem::Size() const {
+  return size_;
+}
+
+/**
+ * Gets the most particles that can be alive at once.
+ * @return the capacity.
+ */
+size_t ParticleSystem::Capacity() const {
+  return kCapacity;
+}
+
+/**
+ * Gets the number of particles that bursts asked for, but that were thinned
+ * out because the pool was filling up.
+ * @return the number of particles.
+ */
+size_t ParticleSystem::Dropped() const {
+  return dropped_;
+}
+
+}  // namespace screamy_ball
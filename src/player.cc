@@ -0,0 +1,32 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/player.h>
+
+#include <cstdio>
+
+namespace screamy_ball {
+
+const int kNumSeconds = 60;
+
+/**
+ * Pretty Prints the input time in seconds in the format hh:mm:ss.
+ * @param time_secs the time in seconds to pretty print
+ * @return the elapsed time in the above format
+ */
+std::string PrettyPrintElapsedTime(double time_secs) {
+  int seconds = (int) time_secs;
+
+  int hours = seconds / (kNumSeconds * kNumSeconds);
+  seconds -= hours * (kNumSeconds * kNumSeconds);
+
+  int minutes = seconds / kNumSeconds;
+  seconds -= minutes * kNumSeconds;
+
+  // "hh:mm:ss" fits in the string's own buffer, so this doesn't allocate
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", hours, minutes,
+                seconds);
+  return buffer;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,114 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/profiler.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace screamy_ball {
+
+FrameProfiler::FrameProfiler() :
+    samples_(),
+    has_started_(false),
+    frames_(0) {}
+
+/**
+ * Finishes the current frame, recording its total time, and starts the next
+ * one. The whole frame is timed from one call to the next, so it includes
+ * the time spent outside the timed phases.
+ */
+void FrameProfiler::BeginFrame() {
+  const Clock::time_point now = Clock::now();
+  const size_t frame = frames_.load(std::memory_order_relaxed);
+
+  if (has_started_) {
+    samples_[frame % kFrames][kFrame] =
+        std::chrono::duration<float>(now - frame_start_).count();
+    frames_.store(frame + 1, std::memory_order_release);
+  }
+
+  // clear the slot of the frame that's starting
+  float* next = samples_[(has_started_ ? frame + 1 : frame) % kFrames];
+  std::fill(next, next + kMaxPhases + 1, 0.0f);
+  frame_start_ = now;
+  has_started_ = true;
+}
+
+/**
+ * Adds time to one of the current frame's phases.
+ * @param phase the phase, less than kMaxPhases.
+ * @param time the time spent in the phase.
+ */
+void FrameProfiler::AddTime(size_t phase, Clock::duration time) {
+  if (phase >= kMaxPhases) {
+    return;
+  }
+  const size_t frame = frames_.load(std::memory_order_relaxed);
+  samples_[frame % kFrames][phase] +=
+      std::chrono::duration<float>(time).count();
+}
+
+/**
+ * Counts the frames that can be read. The oldest slot of the buffer holds the
+ * frame being recorded, so at most kFrames - 1 frames can be read.
+ * @return the number of finished frames still in the buffer.
+ */
+size_t FrameProfiler::Frames() const {
+  return std::min(frames_.load(std::memory_order_acquire), kFrames - 1);
+}
+
+/**
+ * Looks up how long a phase took in one of the recent frames.
+ * @param phase the phase, or kFrame for the whole frame.
+ * @param frames_ago 0 for the last finished frame, 1 for the one before it,
+ * and so on, up to Frames() - 1.
+ * @return the time, in seconds, or 0 if there's no such frame.
+ */
+double FrameProfiler::Secs(size_t phase, size_t frames_ago) const {
+  const size_t frames = frames_.load(std::memory_order_acquire);
+  if (phase > kFrame || frames_ago >= std::min(frames, kFrames - 1)) {
+    return 0;
+  }
+  return samples_[(frames - 1 - frames_ago) % kFrames][phase];
+}
+
+/**
+ * Calculates a percentile of a phase's time over the recent frames, using the
+ * nearest-rank method.
+ * @param phase the phase, or kFrame for the whole frame.
+ * @param fraction the percentile, between 0 and 1: 0.5 for the median.
+ * @return the time, in seconds, or 0 if no frames have finished yet.
+ */
+double FrameProfiler::Percentile(size_t phase, double fraction) const {
+  const size_t frames = Frames();
+  if (frames == 0 || phase > kFrame) {
+    return 0;
+  }
+
+  float sorted[kFrames];
+  for (size_t frame = 0; frame < frames; frame++) {
+    sorted[frame] = static_cast<float>(Secs(phase, frame));
+  }
+
+  const double rank = std::ceil(fraction * static_cast<double>(frames));
+  const size_t index = std::min(frames - 1, static_cast<size_t>(
+      std::max(1.0, rank)) - 1);
+  std::nth_element(sorted, sorted + index, sorted + frames);
+  return sorted[index];
+}
+
+/**
+ * Starts timing a phase.
+ * @param profiler the profiler to add the time to.
+ * @param phase the phase being timed.
+ */
+ScopedTimer::ScopedTimer(FrameProfiler* profiler, size_t phase) :
+    profiler_(profiler),
+    kPhase(phase),
+    kStart(std::chrono::steady_clock::now()) {}
+
+ScopedTimer::~ScopedTimer() {
+  profiler_->AddTime(kPhase, std::chrono::steady_clock::now() - kStart);
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,174 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/quality.h>
+#include <screamy-ball/tracer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace screamy_ball {
+
+// the percentile of a window's frames that's compared with the target
+const double kPercentile = 0.9;
+// a window misses the target when its frames take longer than this much of
+// it, and has headroom when its work takes less than this much of it
+const double kMissRatio = 1.2;
+const double kHeadroomRatio = 0.5;
+const size_t kFirstHoldWindows = 2;
+
+/**
+ * Creates a controller that starts at the best level.
+ * @param levels the number of quality levels.
+ * @param target_secs the frame time to hold.
+ * @throws std::invalid_argument if there are no levels, or no target.
+ */
+QualityController::QualityController(size_t levels, double target_secs) :
+    kLevels(levels),
+    kTargetSecs(target_secs),
+    level_(0),
+    frame_secs_(),
+    work_secs_(),
+    frames_(0),
+    last_frame_secs_(0),
+    last_work_secs_(0),
+    headroom_windows_(0),
+    hold_windows_(kFirstHoldWindows),
+    settled_windows_(0),
+    is_trying_level_(false) {
+  if (kLevels == 0 || !(kTargetSecs > 0)) {
+    throw std::invalid_argument("The quality controller needs at least one "
+                                "level and a target frame time");
+  }
+}
+
+/**
+ * Adds a frame's times, and changes the level once a window of frames has
+ * been added, if the window called for it. Never allocates.
+ * @param frame_secs how long the whole frame took.
+ * @param work_secs how long the frame's own work took, without waiting for
+ * vsync: the longer of the CPU's and the GPU's time.
+ * @return true if the level changed.
+ */
+bool QualityController::AddFrame(double frame_secs, double work_secs) {
+  frame_secs_[frames_] = static_cast<float>(frame_secs);
+  work_secs_[frames_] = static_cast<float>(work_secs);
+  if (++frames_ < kWindowFrames) {
+    return false;
+  }
+  frames_ = 0;
+  last_frame_secs_ = Percentile(frame_secs_);
+  last_work_secs_ = Percentile(work_secs_);
+  const bool was_trying_level = is_trying_level_;
+  is_trying_level_ = false;
+
+  if (last_frame_secs_ > kTargetSecs * kMissRatio) {
+    headroom_windows_ = 0;
+    settled_windows_ = 0;
+    if (level_ + 1 >= kLevels) {
+      return false;
+    }
+    if (was_trying_level) {
+      hold_windows_ = std::min(hold_windows_ * 2, kMaxHoldWindows);
+    }
+    level_++;
+    TraceInstant("quality down", "frame");
+    return true;
+  }
+
+  if (++settled_windows_ >= kSettleWindows) {
+    settled_windows_ = 0;
+    hold_windows_ = std::max(hold_windows_ / 2, kFirstHoldWindows);
+  }
+
+  if (last_work_secs_ >= kTargetSecs * kHeadroomRatio || level_ == 0) {
+    headroom_windows_ = 0;
+    return false;
+  }
+  if (++headroom_windows_ < hold_windows_) {
+    return false;
+  }
+  headroom_windows_ = 0;
+  is_trying_level_ = true;
+  level_--;
+  TraceInstant("quality up", "frame");
+  return true;
+}
+
+/**
+ * Throws away the frames of the window so far, such as when the game
+ * pauses, so frames that weren't drawn at the level don't judge it.
+ */
+void QualityController::Discard() {
+  frames_ = 0;
+}
+
+/**
+ * Moves to a level, and starts judging it from scratch.
+ * @param level the level, which is clamped to the cheapest one.
+ */
+void QualityController::SetLevel(size_t level) {
+  level_ = std::min(level, kLevels - 1);
+  frames_ = 0;
+  headroom_windows_ = 0;
+  is_trying_level_ = false;
+}
+
+/**
+ * Gets the current level.
+ * @return the level, where 0 is the best looking.
+ */
+size_t QualityController::Level() const {
+  return level_;
+}
+
+/**
+ * Gets the number of levels.
+ * @return the number of levels.
+ */
+size_t QualityController::Levels() const {
+  return kLevels;
+}
+
+/**
+ * Gets the frame time being held.
+ * @return the target, in seconds.
+ */
+double QualityController::TargetSecs() const {
+  return kTargetSecs;
+}
+
+/**
+ * Gets how long the frames of the last full window took, at the percentile
+ * the level is judged by.
+ * @return the time, in seconds, or 0 before the first window.
+ */
+double QualityController::FrameSecs() const {
+  return last_frame_secs_;
+}
+
+/**
+ * Gets how long the work in the frames of the last full window took, at the
+ * percentile the level is judged by.
+ * @return the time, in seconds, or 0 before the first window.
+ */
+double QualityController::WorkSecs() const {
+  return last_work_secs_;
+}
+
+/**
+ * Calculates the judged percentile of a window's times, using the
+ * nearest-rank method.
+ * @param samples the window's times.
+ * @return the percentile, in seconds.
+ */
+double QualityController::Percentile(const float* samples) const {
+  float sorted[kWindowFrames];
+  std::copy(samples, samples + kWindowFrames, sorted);
+  const auto index = static_cast<size_t>(std::ceil(
+      kPercentile * static_cast<double>(kWindowFrames))) - 1;
+  std::nth_element(sorted, sorted + index, sorted + kWindowFrames);
+  return sorted[index];
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,64 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/replay.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace screamy_ball {
+
+/**
+ * Parses a replay, which has one event per line: the frame number, followed
+ * by the action to take on that frame. Blank lines, and everything after a
+ * '#', are ignored.
+ * @param input the replay's text.
+ * @return the replay's events, ordered by frame. Events on the same frame
+ * keep the order they were written in.
+ * @throws std::invalid_argument if a line isn't a frame and an action, or
+ * its frame is too big to count to.
+ */
+std::vector<ReplayEvent> ParseReplay(std::istream& input) {
+  std::vector<ReplayEvent> events;
+  std::string line;
+  size_t line_number = 0;
+
+  while (std::getline(input, line)) {
+    line_number++;
+    line = line.substr(0, line.find('#'));
+
+    std::istringstream fields(line);
+    std::string frame;
+    if (!(fields >> frame)) {
+      continue;
+    }
+
+    ReplayEvent event;
+    std::string extra;
+    if (frame.find_first_not_of("0123456789") != std::string::npos
+        || !(fields >> event.action) || fields >> extra) {
+      throw std::invalid_argument("Line " + std::to_string(line_number)
+          + " of the replay should be a frame and an action");
+    }
+    try {
+      const unsigned long long parsed = std::stoull(frame);
+      if (parsed > std::numeric_limits<size_t>::max()) {
+        throw std::out_of_range(frame);
+      }
+      event.frame = static_cast<size_t>(parsed);
+    } catch (const std::out_of_range&) {
+      throw std::invalid_argument("Line " + std::to_string(line_number)
+          + " of the replay has a frame too far in to play");
+    }
+    events.push_back(event);
+  }
+
+  std::stable_sort(events.begin(), events.end(),
+      [](const ReplayEvent& lhs, const ReplayEvent& rhs) {
+        return lhs.frame < rhs.frame;
+      });
+  return events;
+}
+
+}  // namespace screamy_ball
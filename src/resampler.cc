@@ -0,0 +1,156 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/resampler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace screamy_ball {
+
+const double kPi = 3.14159265358979323846;
+// the filter passes up to this fraction of the new rate's highest frequency,
+// leaving the rest for it to roll off before what would alias
+const double kPassFraction = 0.9;
+// taps on either side of the middle, for every input sample an output
+// sample steps over
+const int kTapsPerStep = 8;
+
+/**
+ * Designs a low-pass filter for going down in rate: a sinc cut off below the
+ * new rate's highest frequency, with a Blackman window, scaled so it passes
+ * what's below the cutoff unchanged.
+ * @param step the number of input samples for every output sample.
+ * @return the filter's taps, or just {1} when the rate isn't going down.
+ */
+std::vector<float> LowPassTaps(double step) {
+  if (step <= 1.0) {
+    return {1.0f};
+  }
+  const int half = kTapsPerStep * static_cast<int>(std::ceil(step));
+  const int count = 2 * half + 1;
+  const double cutoff = kPassFraction * 0.5 / step;
+
+  std::vector<double> taps(static_cast<size_t>(count));
+  double sum = 0.0;
+  for (int tap = 0; tap < count; tap++) {
+    const double offset = tap - half;
+    const double sinc = tap == half
+        ? 2.0 * cutoff
+        : std::sin(2.0 * kPi * cutoff * offset) / (kPi * offset);
+    const double phase = 2.0 * kPi * tap / (count - 1);
+    const double window = 0.42 - 0.5 * std::cos(phase)
+        + 0.08 * std::cos(2.0 * phase);
+    taps[static_cast<size_t>(tap)] = sinc * window;
+    sum += sinc * window;
+  }
+
+  std::vector<float> normalized(taps.size());
+  for (size_t tap = 0; tap < taps.size(); tap++) {
+    normalized[tap] = static_cast<float>(taps[tap] / sum);
+  }
+  return normalized;
+}
+
+/**
+ * Gets how far apart output samples are, in input samples.
+ * @param from_rate the audio's sample rate.
+ * @param to_rate the new sample rate.
+ * @return the step.
+ * @throws std::invalid_argument if either rate is 0.
+ */
+double ResampleStep(unsigned from_rate, unsigned to_rate) {
+  if (from_rate == 0 || to_rate == 0) {
+    throw std::invalid_argument("Audio can't be resampled to or from a "
+                                "sample rate of 0");
+  }
+  return static_cast<double>(from_rate) / to_rate;
+}
+
+/**
+ * Creates a resampler, which has heard nothing yet.
+ * @param from_rate the audio's sample rate.
+ * @param to_rate the new sample rate.
+ * @param max_chunk the most samples that are given to Process() at once.
+ * @throws std::invalid_argument if either rate is 0.
+ */
+StreamResampler::StreamResampler(unsigned from_rate, unsigned to_rate,
+                                 size_t max_chunk) :
+    kStep(ResampleStep(from_rate, to_rate)),
+    kMaxChunk(max_chunk),
+    taps_(LowPassTaps(kStep)),
+    input_(taps_.size() - 1 + max_chunk, 0.0f),
+    filtered_(max_chunk, 0.0f),
+    position_(0.0),
+    last_filtered_(0.0f) {}
+
+/**
+ * Resamples the next chunk of audio. Nothing is allocated.
+ * @param samples the chunk's samples.
+ * @param count the number of samples, up to the maximum chunk.
+ * @param output set to the resampled audio, which there's room for
+ * MaxOutput() samples of.
+ * @return the number of samples written to output.
+ * @throws std::invalid_argument if the chunk is bigger than the maximum.
+ */
+size_t StreamResampler::Process(const float* samples, size_t count,
+                                float* output) {
+  if (count > kMaxChunk) {
+    throw std::invalid_argument("The chunk is too big to resample");
+  }
+  if (count == 0) {
+    return 0;
+  }
+  const size_t history = taps_.size() - 1;
+  std::copy(samples, samples + count, input_.begin()
+      + static_cast<std::ptrdiff_t>(history));
+  for (size_t index = 0; index < count; index++) {
+    float sum = 0.0f;
+    for (size_t tap = 0; tap < taps_.size(); tap++) {
+      sum += taps_[tap] * input_[index + tap];
+    }
+    filtered_[index] = sum;
+  }
+  std::copy(input_.begin() + static_cast<std::ptrdiff_t>(count),
+            input_.begin() + static_cast<std::ptrdiff_t>(count + history),
+            input_.begin());
+
+  // positions before the chunk's first sample are between it and the last
+  // chunk's final sample
+  size_t written = 0;
+  const auto last_index = static_cast<double>(count - 1);
+  while (position_ < last_index) {
+    const double before = std::floor(position_);
+    const float from = before < 0.0
+        ? last_filtered_
+        : filtered_[static_cast<size_t>(before)];
+    const float to = filtered_[static_cast<size_t>(before + 1.0)];
+    const auto fraction = static_cast<float>(position_ - before);
+    output[written++] = from + (to - from) * fraction;
+    position_ += kStep;
+  }
+  position_ -= static_cast<double>(count);
+  last_filtered_ = filtered_[count - 1];
+  return written;
+}
+
+/**
+ * Gets the most samples Process() writes for one chunk.
+ * @return the number of samples.
+ */
+size_t StreamResampler::MaxOutput() const {
+  const double chunk = static_cast<double>(kMaxChunk);
+  return static_cast<size_t>(std::ceil(chunk / kStep)) + 1;
+}
+
+/**
+ * Forgets the audio heard so far, so the next chunk is resampled as the
+ * start of a new stream.
+ */
+void StreamResampler::Reset() {
+  std::fill(input_.begin(), input_.end(), 0.0f);
+  position_ = 0.0;
+  last_filtered_ = 0.0f;
+}
+
+}  // namespace screamy_ball
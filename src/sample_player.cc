@@ -0,0 +1,160 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/sample_player.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace screamy_ball {
+
+/**
+ * Creates a sample player for a decoded clip.
+ * @param clip the clip's samples, with every channel's frames one after
+ * another.
+ * @param channels the number of channels in the clip.
+ * @param voices how many copies of the clip can play at once, up to
+ * kMaxVoices.
+ */
+SamplePlayer::SamplePlayer(std::vector<float> clip, size_t channels,
+                           size_t voices) :
+    kClip(std::move(clip)),
+    kChannels(std::max<size_t>(1, channels)),
+    kFrames(kClip.size() / kChannels),
+    kVoices(std::min(std::max<size_t>(1, voices), kMaxVoices)),
+    voices_(),
+    pending_triggers_(0),
+    last_trigger_ns_(0),
+    started_(0),
+    total_latency_ns_(0),
+    max_latency_ns_(0) {}
+
+/**
+ * Plays the clip from the start, on the next call to Mix. This can be called
+ * from any thread.
+ */
+void SamplePlayer::Trigger() {
+  last_trigger_ns_.store(Now(), std::memory_order_relaxed);
+  pending_triggers_.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * Starts the voices that were triggered since the last call, and writes the
+ * mix of every playing voice to the output. Output channels past the clip's
+ * channels repeat the clip's channels.
+ * @param output where to write the audio, with every channel's frames one
+ * after another.
+ * @param channels the number of output channels.
+ * @param frames the number of frames in each output channel.
+ */
+void SamplePlayer::Mix(float* output, size_t channels, size_t frames) {
+  const size_t triggers =
+      pending_triggers_.exchange(0, std::memory_order_acquire);
+  if (triggers > 0) {
+    // only the last trigger's time is known, so that's the one measured
+    const int64_t latency_ns =
+        Now() - last_trigger_ns_.load(std::memory_order_relaxed);
+    started_.fetch_add(1, std::memory_order_relaxed);
+    total_latency_ns_.fetch_add(latency_ns, std::memory_order_relaxed);
+    if (latency_ns > max_latency_ns_.load(std::memory_order_relaxed)) {
+      max_latency_ns_.store(latency_ns, std::memory_order_relaxed);
+    }
+  }
+  for (size_t trigger = 0; trigger < std::min(triggers, kVoices); trigger++) {
+    StartVoice();
+  }
+
+  std::fill(output, output + channels * frames, 0.0f);
+  for (size_t index = 0; index < kVoices; index++) {
+    Voice& voice = voices_[index];
+    if (!voice.is_active) {
+      continue;
+    }
+
+    const size_t length = std::min(frames, kFrames - voice.position);
+    for (size_t channel = 0; channel < channels; channel++) {
+      const float* source = &kClip[(channel % kChannels) * kFrames
+                                   + voice.position];
+      float* destination = output + channel * frames;
+      for (size_t frame = 0; frame < length; frame++) {
+        destination[frame] += source[frame];
+      }
+    }
+
+    voice.position += length;
+    voice.is_active = voice.position < kFrames;
+  }
+}
+
+/**
+ * Starts a voice at the start of the clip: a free one if there is one, or
+ * else the one that's furthest into the clip.
+ */
+void SamplePlayer::StartVoice() {
+  Voice* chosen = &voices_[0];
+  for (size_t index = 0; index < kVoices; index++) {
+    Voice& voice = voices_[index];
+    if (!voice.is_active) {
+      chosen = &voice;
+      break;
+    }
+    if (voice.position > chosen->position) {
+      chosen = &voice;
+    }
+  }
+  chosen->is_active = kFrames > 0;
+  chosen->position = 0;
+}
+
+/**
+ * Counts the voices that are playing. This should only be called from the
+ * thread that calls Mix.
+ * @return the number of voices playing.
+ */
+size_t SamplePlayer::ActiveVoices() const {
+  size_t active = 0;
+  for (size_t index = 0; index < kVoices; index++) {
+    active += voices_[index].is_active;
+  }
+  return active;
+}
+
+/**
+ * Counts the times Mix has started voices.
+ * @return the number of times voices were started.
+ */
+size_t SamplePlayer::Triggers() const {
+  return started_.load(std::memory_order_relaxed);
+}
+
+/**
+ * Calculates the mean time from a trigger to Mix starting its voice.
+ * @return the mean latency, in seconds, or 0 if nothing has played yet.
+ */
+double SamplePlayer::MeanLatencySecs() const {
+  const size_t started = Triggers();
+  if (started == 0) {
+    return 0;
+  }
+  return static_cast<double>(total_latency_ns_.load(
+      std::memory_order_relaxed)) / static_cast<double>(started) / 1e9;
+}
+
+/**
+ * Finds the longest time from a trigger to Mix starting its voice.
+ * @return the longest latency, in seconds.
+ */
+double SamplePlayer::MaxLatencySecs() const {
+  return static_cast<double>(max_latency_ns_.load(
+      std::memory_order_relaxed)) / 1e9;
+}
+
+/**
+ * Gets the current time, as a number so it can be stored atomically.
+ * @return nanoseconds since the steady clock's epoch.
+ */
+int64_t SamplePlayer::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now().time_since_epoch()).count();
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,642 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/shared_env.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#if defined(_WIN32)
+#define SCREAMY_BALL_NO_SHARED_ENV
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#define SCREAMY_BALL_FUTEX
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCREAMY_BALL_SSE2
+#endif
+
+namespace screamy_ball {
+
+const char kEnvMagic[] = "SBENV01";
+const uint32_t kEnvVersion = 2;
+const size_t kCacheLine = 64;
+// how many times a side checks for the other before going to sleep, which
+// is long enough to cover a batch of a few hundred environments
+const int kSpins = 2000;
+// the longest a side sleeps before checking whether the other has gone
+const int kSleepSliceMs = 100;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "The shared counters must be lock-free to work across "
+              "processes");
+
+/**
+ * Rounds an offset up to the next cache line.
+ */
+size_t AlignToCacheLine(size_t offset) {
+  return (offset + kCacheLine - 1) / kCacheLine * kCacheLine;
+}
+
+/**
+ * Decides how long to spin before sleeping. With only one CPU, the other
+ * side can't run while this one spins, so it sleeps straight away.
+ * @return the number of checks.
+ */
+int SpinLimit() {
+  static const int spins = std::thread::hardware_concurrency() > 1 ? kSpins
+                                                                   : 0;
+  return spins;
+}
+
+/**
+ * Lets the other hyperthread run while spinning.
+ */
+void SpinPause() {
+#ifdef SCREAMY_BALL_SSE2
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+/**
+ * Sleeps until a counter is woken, or it's no longer the given value.
+ * Without futexes, it just sleeps briefly.
+ * @param word the counter, which is in the shared file.
+ * @param value what the counter was.
+ * @param timeout_ms the longest to sleep.
+ */
+void FutexWait(std::atomic<uint32_t>* word, uint32_t value, int timeout_ms) {
+#ifdef SCREAMY_BALL_FUTEX
+  timespec timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+  // not FUTEX_WAIT_PRIVATE, since the other side is another process
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, value,
+          &timeout, nullptr, 0);
+#else
+  (void) word;
+  (void) value;
+  std::this_thread::sleep_for(std::chrono::microseconds(
+      std::min(timeout_ms * 1000, 50)));
+#endif
+}
+
+/**
+ * Wakes everything sleeping on a counter.
+ */
+void FutexWake(std::atomic<uint32_t>* word) {
+#ifdef SCREAMY_BALL_FUTEX
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX,
+          nullptr, nullptr, 0);
+#else
+  (void) word;
+#endif
+}
+
+/**
+ * Sets a counter, and wakes the other side if it's asleep waiting for it.
+ * The waiting flag is only set by a side about to sleep, so a side that's
+ * still spinning is never woken with a system call.
+ * @param word the counter.
+ * @param value the counter's new value.
+ * @param waiting the other side's flag for sleeping on the counter.
+ */
+void Publish(std::atomic<uint32_t>* word, uint32_t value,
+             std::atomic<uint32_t>* waiting) {
+  word->store(value, std::memory_order_seq_cst);
+  if (waiting->load(std::memory_order_seq_cst) != 0) {
+    FutexWake(word);
+  }
+}
+
+/**
+ * Waits for the other side to change a counter: first by spinning, then by
+ * sleeping on it.
+ * @param word the counter.
+ * @param old_value the counter's value before the change.
+ * @param waiting this side's flag for sleeping on the counter.
+ * @param closed set once the other side has gone, or nullptr if it can't go.
+ * @param timeout_ms the longest to wait, or -1 to wait until it changes.
+ * @return true if it changed, or false if the wait timed out or the other
+ * side has gone.
+ */
+bool WaitForChange(std::atomic<uint32_t>* word, uint32_t old_value,
+                   std::atomic<uint32_t>* waiting,
+                   const std::atomic<uint32_t>* closed, int timeout_ms) {
+  for (int spin = 0; spin < SpinLimit(); spin++) {
+    if (word->load(std::memory_order_acquire) != old_value) {
+      return true;
+    }
+    SpinPause();
+  }
+  if (timeout_ms == 0) {
+    return word->load(std::memory_order_acquire) != old_value;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now()
+      + std::chrono::milliseconds(timeout_ms);
+  while (true) {
+    int slice = kSleepSliceMs;
+    if (timeout_ms > 0) {
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline - std::chrono::steady_clock::now()).count();
+      slice = static_cast<int>(std::max<long long>(
+          0, std::min<long long>(slice, left)));
+    }
+
+    // the flag is set before the last check, so the other side either sees
+    // it and wakes this side, or changed the counter before the check
+    waiting->store(1, std::memory_order_seq_cst);
+    if (word->load(std::memory_order_seq_cst) == old_value
+        && (closed == nullptr || closed->load() == 0) && slice > 0) {
+      FutexWait(word, old_value, slice);
+    }
+    waiting->store(0, std::memory_order_relaxed);
+
+    if (word->load(std::memory_order_acquire) != old_value) {
+      return true;
+    }
+    if (closed != nullptr && closed->load(std::memory_order_acquire) != 0) {
+      return false;
+    }
+    if (timeout_ms > 0 && std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+  }
+}
+
+/**
+ * Maps a shared file into memory, for reading and writing.
+ * @param file the open file.
+ * @param size the file's size.
+ * @return the mapping.
+ * @throws std::runtime_error if it can't be mapped.
+ */
+char* MapShared(int file, size_t size) {
+#ifdef SCREAMY_BALL_NO_SHARED_ENV
+  (void) file;
+  (void) size;
+  throw std::runtime_error("Shared environments need POSIX shared memory");
+#else
+  void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       file, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Couldn't map the shared environments");
+  }
+  return static_cast<char*>(mapping);
+#endif
+}
+
+/**
+ * Unmaps a shared file.
+ */
+void UnmapShared(char* data, size_t size) {
+#ifndef SCREAMY_BALL_NO_SHARED_ENV
+  if (data != nullptr) {
+    munmap(data, size);
+  }
+#else
+  (void) data;
+  (void) size;
+#endif
+}
+
+/**
+ * Writes out what an environment looks like.
+ * @param engine the environment.
+ * @param batch the batch that stepped it.
+ * @param episode_ticks the ticks survived in its episode.
+ * @param reward the reward for the step.
+ * @param done why the step ended its last episode, or 0 if it didn't.
+ * @param observation where it's written.
+ */
+void Observe(const Engine& engine, uint32_t batch, uint32_t episode_ticks,
+             float reward, uint8_t done, EnvObservation* observation) {
+  observation->batch = batch;
+  observation->episode_ticks = episode_ticks;
+  observation->ball_y = engine.ball_.y;
+  observation->ball_velocity = engine.ball_.velocity;
+  observation->obstacle_x = engine.obstacle_.x;
+  observation->obstacle_velocity = engine.obstacle_.velocity;
+  observation->ball_state = static_cast<uint8_t>(engine.state_);
+  observation->obstacle_type = static_cast<uint8_t>(engine.obstacle_.type);
+  observation->obstacle_length = static_cast<uint8_t>(
+      std::min(engine.obstacle_.length, 255));
+  observation->done = done;
+  observation->reward = reward;
+}
+
+/**
+ * Checks whether the ring has a power of two slots, so that the slot a
+ * batch is in carries on round the ring when the batch counter wraps.
+ * @param ring the number of slots.
+ * @return true if it's a power of two.
+ */
+bool IsPowerOfTwo(uint64_t ring) {
+  return ring != 0 && (ring & (ring - 1)) == 0;
+}
+
+/**
+ * Creates the shared file, and the environments, each at the start of an
+ * episode. The starting observations are in the ring as batch 0.
+ * @param path the shared file, which is replaced if it's there. A file in
+ * /dev/shm never touches the disk.
+ * @param envs the number of environments.
+ * @param ring the number of batches of observations kept, so the client
+ * can look back at the last few, which is a power of two.
+ * @param width the number of tiles in each row of the board, which has room
+ * for the ball, 2 tiles in, and a tile in front of it.
+ * @param height the number of tiles in each column of the board, which has
+ * room for a whole jump above the ground, 2 tiles from the bottom.
+ * @param seed the first environment's seed; each one after it has the next.
+ * @param max_episode_ticks the most ticks an episode lasts, after which it's
+ * truncated and the environment restarts, so a bot that never collides
+ * still gets new episodes.
+ * @throws std::invalid_argument if there are no environments, the board is
+ * too small, the ring isn't a power of two, or there's no tick limit.
+ * @throws std::runtime_error if the file can't be made.
+ */
+SharedEnvServer::SharedEnvServer(const std::string& path, size_t envs,
+                                 size_t ring, int width, int height,
+                                 unsigned seed, uint32_t max_episode_ticks) :
+    data_(nullptr),
+    size_(0),
+    header_(nullptr),
+    actions_(nullptr),
+    observations_(nullptr),
+    served_(0) {
+  if (envs == 0 || envs > UINT32_MAX) {
+    throw std::invalid_argument("There must be at least one environment");
+  }
+  if (!IsPowerOfTwo(ring) || ring > UINT32_MAX) {
+    throw std::invalid_argument("The ring of observations must have a "
+                                "power of two batches");
+  }
+  if (max_episode_ticks == 0) {
+    throw std::invalid_argument("Episodes must last at least a tick");
+  }
+  if (width < 4 || height - 2 < EngineParameters().jump_height) {
+    throw std::invalid_argument("The board must be at least 4 tiles wide, "
+                                "and tall enough for the ball to jump");
+  }
+
+  // the engines are made before the file is mapped, so nothing can throw
+  // once it is, and leave it mapped with no destructor to unmap it
+  engines_.reserve(envs);
+  for (size_t env = 0; env < envs; env++) {
+    engines_.emplace_back(Location(2, height - 2), width, height,
+                          seed + static_cast<unsigned>(env));
+  }
+  episode_ticks_.assign(envs, 0);
+  const size_t actions_offset = AlignToCacheLine(sizeof(SharedEnvHeader));
+  const size_t observations_offset = AlignToCacheLine(actions_offset + envs);
+  size_ = observations_offset + ring * envs * sizeof(EnvObservation);
+
+#ifdef SCREAMY_BALL_NO_SHARED_ENV
+  data_ = MapShared(-1, size_);
+#else
+  const int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (file < 0) {
+    throw std::runtime_error("Couldn't create the shared environments "
+                             + path);
+  }
+  if (ftruncate(file, static_cast<off_t>(size_)) != 0) {
+    close(file);
+    throw std::runtime_error("Couldn't size the shared environments " + path);
+  }
+  try {
+    data_ = MapShared(file, size_);
+  } catch (...) {
+    close(file);
+    throw;
+  }
+  close(file);
+#endif
+
+  // the file starts out zeroed, and the magic is written last, so a client
+  // never sees a header that's only partly written
+  header_ = new (data_) SharedEnvHeader;
+  header_->version = kEnvVersion;
+  header_->envs = static_cast<uint32_t>(envs);
+  header_->ring = static_cast<uint32_t>(ring);
+  header_->observation_size = sizeof(EnvObservation);
+  header_->actions_offset = actions_offset;
+  header_->observations_offset = observations_offset;
+  header_->width = width;
+  header_->height = height;
+  header_->max_episode_ticks = max_episode_ticks;
+  header_->request.store(0);
+  header_->server_waiting.store(0);
+  header_->response.store(0);
+  header_->client_waiting.store(0);
+  header_->closed.store(0);
+  actions_ = reinterpret_cast<const uint8_t*>(data_ + actions_offset);
+  observations_ = reinterpret_cast<EnvObservation*>(data_
+                                                    + observations_offset);
+
+  for (size_t env = 0; env < envs; env++) {
+    Observe(engines_[env], 0, 0, 0, 0, &observations_[env]);
+  }
+
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(header_->magic, kEnvMagic, sizeof(header_->magic));
+}
+
+/**
+ * Tells the client that the server has gone, and unmaps the shared file.
+ * The file itself is left for the client to finish reading.
+ */
+SharedEnvServer::~SharedEnvServer() {
+  if (header_ != nullptr) {
+    header_->closed.store(1);
+    FutexWake(&header_->response);
+  }
+  UnmapShared(data_, size_);
+}
+
+/**
+ * Waits for the client to ask for a batch, and steps every environment.
+ * @param timeout_ms the longest to wait, or -1 to wait until it asks.
+ * @return true if a batch was stepped.
+ */
+bool SharedEnvServer::ServeBatch(int timeout_ms) {
+  if (!WaitForChange(&header_->request, served_, &header_->server_waiting,
+                     nullptr, timeout_ms)) {
+    return false;
+  }
+  const uint32_t batch = header_->request.load(std::memory_order_acquire);
+  StepAll(batch);
+  served_ = batch;
+  Publish(&header_->response, batch, &header_->client_waiting);
+  return true;
+}
+
+/**
+ * Serves batches until it's stopped.
+ * @param stop set to stop serving, which is noticed within a fraction of a
+ * second.
+ */
+void SharedEnvServer::Serve(const std::atomic<bool>& stop) {
+  while (!stop.load()) {
+    ServeBatch(kSleepSliceMs);
+  }
+}
+
+/**
+ * Steps every environment with its action, and writes their observations
+ * into the batch's slot of the ring. A collision, or reaching the tick
+ * limit, ends the episode, and the environment starts a new one straight
+ * away.
+ * @param batch the batch.
+ */
+void SharedEnvServer::StepAll(uint32_t batch) {
+  const size_t envs = engines_.size();
+  EnvObservation* observations = observations_ + batch % header_->ring * envs;
+
+  for (size_t env = 0; env < envs; env++) {
+    Engine& engine = engines_[env];
+    float reward = 0;
+    uint8_t done = 0;
+
+    if (actions_[env] == kResetAction) {
+      engine.Reset();
+      episode_ticks_[env] = 0;
+    } else {
+      if (actions_[env] <= static_cast<uint8_t>(Action::kDuck)) {
+        Autoplayer::Apply(&engine, static_cast<Action>(actions_[env]));
+      }
+      engine.Run();
+      if (engine.state_ == BallState::kCollided) {
+        engine.Reset();
+        episode_ticks_[env] = 0;
+        done = kEpisodeCollided;
+      } else if (episode_ticks_[env] + 1 >= header_->max_episode_ticks) {
+        engine.Reset();
+        episode_ticks_[env] = 0;
+        done = kEpisodeTruncated;
+        reward = 1;
+      } else {
+        episode_ticks_[env]++;
+        reward = 1;
+      }
+    }
+    Observe(engine, batch, episode_ticks_[env], reward, done,
+            &observations[env]);
+  }
+}
+
+/**
+ * Counts the environments.
+ * @return the number of environments.
+ */
+size_t SharedEnvServer::Envs() const {
+  return engines_.size();
+}
+
+/**
+ * Gets the last batch that was stepped.
+ * @return the batch, counting from 1.
+ */
+uint32_t SharedEnvServer::Batches() const {
+  return served_;
+}
+
+/**
+ * Maps a server's shared file, and starts from the server's last batch.
+ * @param path the shared file.
+ * @throws std::runtime_error if it can't be opened.
+ * @throws std::invalid_argument if it isn't a server's file.
+ */
+SharedEnvClient::SharedEnvClient(const std::string& path) :
+    data_(nullptr),
+    size_(0),
+    header_(nullptr),
+    actions_(nullptr),
+    observations_(nullptr),
+    batch_(0),
+    pending_(0) {
+#ifdef SCREAMY_BALL_NO_SHARED_ENV
+  data_ = MapShared(-1, 0);
+#else
+  const int file = open(path.c_str(), O_RDWR);
+  if (file < 0) {
+    throw std::runtime_error("Couldn't open the shared environments "
+                             + path);
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0 || status.st_size < 0) {
+    close(file);
+    throw std::runtime_error("Couldn't read the shared environments "
+                             + path);
+  }
+  size_ = static_cast<size_t>(status.st_size);
+  if (size_ < sizeof(SharedEnvHeader)) {
+    close(file);
+    throw std::invalid_argument("Not shared environments");
+  }
+  try {
+    data_ = MapShared(file, size_);
+  } catch (...) {
+    close(file);
+    throw;
+  }
+  close(file);
+#endif
+
+  header_ = reinterpret_cast<SharedEnvHeader*>(data_);
+  const uint64_t envs = header_->envs;
+  const uint64_t ring = header_->ring;
+  if (std::memcmp(header_->magic, kEnvMagic, sizeof(header_->magic)) != 0
+      || header_->version != kEnvVersion
+      || header_->observation_size != sizeof(EnvObservation)
+      || !IsPowerOfTwo(ring)
+      || header_->actions_offset + envs > header_->observations_offset
+      || header_->observations_offset > size_
+      || ring * envs > (size_ - header_->observations_offset)
+          / sizeof(EnvObservation)) {
+    UnmapShared(data_, size_);
+    throw std::invalid_argument("Not shared environments");
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  actions_ = reinterpret_cast<uint8_t*>(data_ + header_->actions_offset);
+  observations_ = reinterpret_cast<const EnvObservation*>(
+      data_ + header_->observations_offset);
+  batch_ = header_->response.load(std::memory_order_acquire);
+  pending_ = batch_;
+}
+
+SharedEnvClient::~SharedEnvClient() {
+  UnmapShared(data_, size_);
+}
+
+/**
+ * Sets the action an environment takes on the next step.
+ * @param env the environment.
+ * @param action the action, which follows the game's rules: the ball can't
+ * duck mid-air, and it only stops ducking by rolling again.
+ */
+void SharedEnvClient::SetAction(size_t env, Action action) {
+  actions_[env] = static_cast<uint8_t>(action);
+}
+
+/**
+ * Sets every environment's action.
+ * @param action an Action, or kResetAction to restart every episode.
+ */
+void SharedEnvClient::SetAllActions(uint8_t action) {
+  std::memset(actions_, action, Envs());
+}
+
+/**
+ * Gets every environment's action, to be set in bulk.
+ * @return Envs() actions, each an Action or kResetAction.
+ */
+uint8_t* SharedEnvClient::Actions() {
+  return actions_;
+}
+
+/**
+ * Asks the server to step every environment with its action. The actions
+ * mustn't be changed until Wait() returns.
+ */
+void SharedEnvClient::Submit() {
+  pending_ = batch_ + 1;
+  Publish(&header_->request, pending_, &header_->server_waiting);
+}
+
+/**
+ * Waits for the server to finish the submitted batch.
+ * @param timeout_ms the longest to wait, or -1 to wait until it's done.
+ * @return false if it timed out, or the server has gone, in which case the
+ * observations are the last batch's.
+ */
+bool SharedEnvClient::Wait(int timeout_ms) {
+  if (pending_ == batch_) {
+    return true;
+  }
+  if (!WaitForChange(&header_->response, batch_, &header_->client_waiting,
+                     &header_->closed, timeout_ms)) {
+    return false;
+  }
+  batch_ = pending_;
+  return true;
+}
+
+/**
+ * Steps every environment with its action, and waits for their
+ * observations.
+ * @param timeout_ms the longest to wait, or -1 to wait until it's done.
+ * @return false if it timed out, or the server has gone.
+ */
+bool SharedEnvClient::Step(int timeout_ms) {
+  Submit();
+  return Wait(timeout_ms);
+}
+
+/**
+ * Restarts every environment's episode, and then sets every action back to
+ * rolling.
+ * @param timeout_ms the longest to wait, or -1 to wait until it's done.
+ * @return false if it timed out, or the server has gone.
+ */
+bool SharedEnvClient::ResetAll(int timeout_ms) {
+  SetAllActions(kResetAction);
+  const bool done = Step(timeout_ms);
+  SetAllActions(static_cast<uint8_t>(Action::kRoll));
+  return done;
+}
+
+/**
+ * Gets every environment's observation from a recent batch.
+ * @param batches_ago how many batches back to look, which must be less than
+ * Ring().
+ * @return Envs() observations, one for each environment, which are
+ * overwritten once the ring comes round to them again.
+ */
+const EnvObservation* SharedEnvClient::Observations(
+    size_t batches_ago) const {
+  const uint32_t batch = batch_ - static_cast<uint32_t>(batches_ago);
+  return observations_ + batch % header_->ring * Envs();
+}
+
+/**
+ * Counts the environments.
+ * @return the number of environments.
+ */
+size_t SharedEnvClient::Envs() const {
+  return header_->envs;
+}
+
+/**
+ * Counts the batches of observations the ring keeps.
+ * @return the number of batches.
+ */
+size_t SharedEnvClient::Ring() const {
+  return header_->ring;
+}
+
+/**
+ * Gets the last batch that was finished.
+ * @return the batch, which is 0 before the first step.
+ */
+uint32_t SharedEnvClient::Batch() const {
+  return batch_;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,218 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/speech_commands.h>
+#include <screamy-ball/voice_control.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <sstream>
+
+namespace screamy_ball {
+
+// the length of the blocks whose levels find the end of an utterance
+const double kLevelBlockSecs = 0.01;
+// how far below the loudest block speech can be, and the quietest speech
+const float kSpeechRangeDb = 30;
+const float kMinSpeechLevel = 1e-4f;
+
+/**
+ * Gets the phrases the game listens for. Only whole phrases are commands,
+ * since single words like "pause" and "mute" are recognized randomly;
+ * "sounds" alone isn't, so it mutes by itself.
+ * @return the phrases, with their commands and keyword spotting thresholds.
+ */
+const std::vector<SpeechPhrase>& SpeechPhrases() {
+  static const std::vector<SpeechPhrase> phrases = {
+      { "HIGHER", SpeechCommand::kJump, 1e-15 },
+      { "LOWER", SpeechCommand::kDuck, 1e-15 },
+      { "PAUSE GAME", SpeechCommand::kPause, 1e-25 },
+      { "RESET GAME", SpeechCommand::kReset, 1e-25 },
+      { "RESET", SpeechCommand::kReset, 1e-20 },
+      { "MUTE SOUNDS", SpeechCommand::kMute, 1e-25 },
+      { "SOUNDS", SpeechCommand::kMute, 1e-15 },
+      { "MAIN MENU", SpeechCommand::kMenu, 1e-25 },
+      { "MENU", SpeechCommand::kMenu, 1e-15 },
+      { "INSTRUCTIONS", SpeechCommand::kHelp, 1e-30 }
+  };
+  return phrases;
+}
+
+/**
+ * Turns the speech recognizer's hypothesis into a command.
+ * @param hypothesis the recognized words, in upper case.
+ * @return the command, or kNone if the words aren't one of the phrases.
+ */
+SpeechCommand ParseSpeechCommand(const std::string& hypothesis) {
+  for (const SpeechPhrase& phrase : SpeechPhrases()) {
+    if (phrase.phrase == hypothesis) {
+      return phrase.command;
+    }
+  }
+  return SpeechCommand::kNone;
+}
+
+/**
+ * Turns a partial hypothesis into a command, if it's certain: the words are
+ * a whole phrase, and no longer phrase that starts with them is a different
+ * command. "RESET" is certain, since "RESET GAME" resets too.
+ * @param partial the words recognized so far, in upper case.
+ * @return the command, or kNone if it isn't certain yet.
+ */
+SpeechCommand ParseEarlyCommand(const std::string& partial) {
+  const SpeechCommand command = ParseSpeechCommand(partial);
+  if (command == SpeechCommand::kNone) {
+    return command;
+  }
+  const std::string prefix = partial + " ";
+  for (const SpeechPhrase& phrase : SpeechPhrases()) {
+    if (phrase.phrase.compare(0, prefix.size(), prefix) == 0
+        && phrase.command != command) {
+      return SpeechCommand::kNone;
+    }
+  }
+  return command;
+}
+
+/**
+ * Creates a JSGF grammar that only accepts the phrases, for the recognizer's
+ * finite-state grammar mode.
+ * @return the grammar's text.
+ */
+std::string CommandGrammar() {
+  std::string grammar = "#JSGF V1.0;\ngrammar commands;\n"
+                        "public <command> = ";
+  for (size_t index = 0; index < SpeechPhrases().size(); index++) {
+    grammar += (index == 0 ? "" : " | ") + SpeechPhrases()[index].phrase;
+  }
+  return grammar + ";\n";
+}
+
+/**
+ * Creates a keyword list with every phrase and its threshold, for the
+ * recognizer's keyword spotting mode.
+ * @return the list's text, with one "PHRASE /threshold/" per line.
+ */
+std::string KeywordList() {
+  std::ostringstream list;
+  for (const SpeechPhrase& phrase : SpeechPhrases()) {
+    list << phrase.phrase << " /" << phrase.threshold << "/\n";
+  }
+  return list.str();
+}
+
+CommandTrigger::CommandTrigger() : has_triggered_(false) {}
+
+/**
+ * Handles a partial hypothesis, while the utterance is still being spoken.
+ * @param partial the words recognized so far.
+ * @return the command to trigger now, or kNone.
+ */
+SpeechCommand CommandTrigger::OnPartial(const std::string& partial) {
+  if (has_triggered_) {
+    return SpeechCommand::kNone;
+  }
+  const SpeechCommand command = ParseEarlyCommand(partial);
+  has_triggered_ = command != SpeechCommand::kNone;
+  return command;
+}
+
+/**
+ * Handles the final hypothesis at the end of the utterance, and gets ready
+ * for the next one.
+ * @param hypothesis the recognized words.
+ * @return the command to trigger now, or kNone if it already was.
+ */
+SpeechCommand CommandTrigger::OnFinal(const std::string& hypothesis) {
+  const SpeechCommand command = has_triggered_
+      ? SpeechCommand::kNone : ParseSpeechCommand(hypothesis);
+  has_triggered_ = false;
+  return command;
+}
+
+/**
+ * Gets the name of a command, as it's reported.
+ * @param command the command.
+ * @return its name.
+ */
+std::string SpeechCommandName(SpeechCommand command) {
+  switch (command) {
+    case SpeechCommand::kJump:
+      return "jump";
+    case SpeechCommand::kDuck:
+      return "duck";
+    case SpeechCommand::kPause:
+      return "pause";
+    case SpeechCommand::kReset:
+      return "reset";
+    case SpeechCommand::kMute:
+      return "mute";
+    case SpeechCommand::kMenu:
+      return "menu";
+    case SpeechCommand::kHelp:
+      return "help";
+    default:
+      return "none";
+  }
+}
+
+/**
+ * Parses a corpus of recordings, which has one recording per line: the WAV
+ * file's path, followed by the words spoken in it, if any. Blank lines, and
+ * everything after a '#', are ignored.
+ * @param input the corpus's text.
+ * @return the corpus's recordings, in order.
+ */
+std::vector<CorpusEntry> ParseCorpus(std::istream& input) {
+  std::vector<CorpusEntry> entries;
+  std::string line;
+
+  while (std::getline(input, line)) {
+    line = line.substr(0, line.find('#'));
+
+    std::istringstream fields(line);
+    CorpusEntry entry;
+    if (!(fields >> entry.wav_path)) {
+      continue;
+    }
+    std::string word;
+    while (fields >> word) {
+      std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+      entry.transcript += (entry.transcript.empty() ? "" : " ") + word;
+    }
+    entries.push_back(entry);
+  }
+  return entries;
+}
+
+/**
+ * Finds when the speech in a recording ends: the end of the last 10ms block
+ * that's within 30dB of the loudest block.
+ * @param samples the recording's mono samples.
+ * @param sample_rate the recording's sample rate.
+ * @return the time the speech ends, in seconds, or 0 if it's silent.
+ */
+double UtteranceEndSecs(const std::vector<float>& samples,
+                        unsigned sample_rate) {
+  const size_t block = std::max<size_t>(1, static_cast<size_t>(
+      sample_rate * kLevelBlockSecs));
+  const size_t blocks = samples.size() / block;
+
+  float loudest = 0;
+  for (size_t index = 0; index < blocks; index++) {
+    loudest = std::max(loudest, Rms(&samples[index * block], block));
+  }
+  if (loudest < kMinSpeechLevel) {
+    return 0;
+  }
+
+  const float threshold = loudest * std::pow(10.0f, -kSpeechRangeDb / 20);
+  for (size_t index = blocks; index > 0; index--) {
+    if (Rms(&samples[(index - 1) * block], block) >= threshold) {
+      return static_cast<double>(index * block) / sample_rate;
+    }
+  }
+  return 0;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,204 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/speech_gate.h>
+#include <screamy-ball/voice_control.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace screamy_ball {
+
+// how quickly the noise floor follows louder blocks, outside of and during
+// speech, and quieter blocks
+const float kNoiseRise = 0.02f;
+const float kNoiseRiseInSpeech = 0.002f;
+const float kNoiseFall = 0.5f;
+
+/**
+ * Rounds a capacity up to a power of two, so positions wrap with a mask.
+ * @param capacity the smallest capacity.
+ * @return the capacity.
+ */
+size_t RingCapacity(size_t capacity) {
+  size_t rounded = 1;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+  return rounded;
+}
+
+/**
+ * Creates an empty ring buffer.
+ * @param capacity the number of samples it holds, rounded up to a power of
+ * two.
+ */
+AudioRing::AudioRing(size_t capacity) :
+    samples_(RingCapacity(capacity), 0.0f),
+    kMask(samples_.size() - 1),
+    written_(0),
+    read_(0),
+    dropped_(0) {}
+
+/**
+ * Adds a block of samples, from the writing thread.
+ * @param samples the samples.
+ * @param count the number of samples.
+ * @return true if they were added, or false if they didn't fit and were
+ * dropped.
+ */
+bool AudioRing::Write(const float* samples, size_t count) {
+  const size_t written = written_.load(std::memory_order_relaxed);
+  const size_t read = read_.load(std::memory_order_acquire);
+  if (samples_.size() - (written - read) < count) {
+    dropped_.fetch_add(count, std::memory_order_relaxed);
+    return false;
+  }
+  for (size_t index = 0; index < count; index++) {
+    samples_[(written + index) & kMask] = samples[index];
+  }
+  written_.store(written + count, std::memory_order_release);
+  return true;
+}
+
+/**
+ * Takes the oldest samples, from the reading thread.
+ * @param samples where the samples are copied to.
+ * @param max_count the most samples to take.
+ * @return the number of samples taken.
+ */
+size_t AudioRing::Read(float* samples, size_t max_count) {
+  const size_t read = read_.load(std::memory_order_relaxed);
+  const size_t written = written_.load(std::memory_order_acquire);
+  const size_t count = std::min(max_count, written - read);
+  for (size_t index = 0; index < count; index++) {
+    samples[index] = samples_[(read + index) & kMask];
+  }
+  read_.store(read + count, std::memory_order_release);
+  return count;
+}
+
+/**
+ * Gets the number of samples waiting to be read.
+ * @return the number of samples.
+ */
+size_t AudioRing::Available() const {
+  return written_.load(std::memory_order_acquire)
+      - read_.load(std::memory_order_acquire);
+}
+
+/**
+ * Gets the number of samples that can be written without being dropped,
+ * from the writing thread.
+ * @return the number of samples.
+ */
+size_t AudioRing::Space() const {
+  return samples_.size() - (written_.load(std::memory_order_relaxed)
+                            - read_.load(std::memory_order_acquire));
+}
+
+/**
+ * Gets the number of samples that were dropped because the ring was full.
+ * @return the number of samples.
+ */
+size_t AudioRing::Dropped() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+/**
+ * Creates a closed gate, allocating everything it needs up front.
+ * @param sample_rate the samples' rate.
+ * @param max_block the most samples a block can have; any more are cut off.
+ * @param parameters the gate's thresholds.
+ */
+SpeechGate::SpeechGate(unsigned sample_rate, size_t max_block,
+                       const GateParameters& parameters) :
+    kParameters(parameters),
+    kSampleRate(static_cast<float>(sample_rate)),
+    kMaxBlock(max_block),
+    preroll_(std::max<size_t>(1, static_cast<size_t>(
+        parameters.preroll_secs * kSampleRate)), 0.0f),
+    preroll_next_(0),
+    preroll_filled_(0),
+    output_(preroll_.size() + max_block, 0.0f),
+    noise_db_(parameters.quiet_db),
+    quiet_secs_(0),
+    is_open_(false) {}
+
+/**
+ * Decides whether a block of samples is speech. When the gate opens, the
+ * output starts with the audio just before the block.
+ * @param samples the block's mono samples, between -1 and 1.
+ * @param count the number of samples.
+ * @return the number of samples in Output() to pass on to the recognizer,
+ * or 0 if the gate is closed.
+ */
+size_t SpeechGate::Process(const float* samples, size_t count) {
+  count = std::min(count, kMaxBlock);
+  const float block_secs = static_cast<float>(count) / kSampleRate;
+  const float level_db = 20 * std::log10(std::max(1e-6f,
+                                                  Rms(samples, count)));
+  const bool is_speech = level_db >= kParameters.quiet_db
+      && level_db - noise_db_ >= kParameters.open_db;
+
+  size_t output_count = 0;
+  if (is_speech) {
+    if (!is_open_) {
+      // the pre-roll, oldest first
+      const size_t oldest = (preroll_next_ + preroll_.size()
+                             - preroll_filled_) % preroll_.size();
+      for (size_t index = 0; index < preroll_filled_; index++) {
+        output_[index] = preroll_[(oldest + index) % preroll_.size()];
+      }
+      output_count = preroll_filled_;
+      is_open_ = true;
+    }
+    quiet_secs_ = 0;
+  } else if (is_open_) {
+    quiet_secs_ += block_secs;
+    is_open_ = quiet_secs_ < kParameters.hangover_secs;
+  }
+
+  if (is_open_) {
+    std::copy(samples, samples + count, output_.begin()
+              + static_cast<long>(output_count));
+    output_count += count;
+  }
+
+  noise_db_ += (level_db - noise_db_) * (level_db < noise_db_ ? kNoiseFall
+      : is_speech ? kNoiseRiseInSpeech : kNoiseRise);
+
+  for (size_t index = 0; index < count; index++) {
+    preroll_[preroll_next_] = samples[index];
+    preroll_next_ = (preroll_next_ + 1) % preroll_.size();
+  }
+  preroll_filled_ = std::min(preroll_.size(), preroll_filled_ + count);
+  return output_count;
+}
+
+/**
+ * Gets the samples the last block let through.
+ * @return the samples.
+ */
+const float* SpeechGate::Output() const {
+  return output_.data();
+}
+
+/**
+ * Checks if the gate is letting speech through.
+ * @return true if it's open.
+ */
+bool SpeechGate::IsOpen() const {
+  return is_open_;
+}
+
+/**
+ * Closes the gate and forgets the recent audio, when listening stops.
+ */
+void SpeechGate::Reset() {
+  preroll_next_ = 0;
+  preroll_filled_ = 0;
+  quiet_secs_ = 0;
+  is_open_ = false;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,293 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/task_graph.h>
+#include <screamy-ball/tracer.h>
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+namespace screamy_ball {
+
+/**
+ * Creates an empty graph. Nothing runs until Start() is called.
+ * @param threads the number of threads in the pool.
+ */
+TaskGraph::TaskGraph(size_t threads) :
+    kThreads(std::max<size_t>(1, threads)),
+    unfinished_(0),
+    is_stopping_(false) {}
+
+/**
+ * Waits for the tasks that are running on the pool, and drops the rest.
+ */
+TaskGraph::~TaskGraph() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  changed_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+/**
+ * Adds a task that runs on the pool.
+ * @param name the task's name, which must be a string literal.
+ * @param task the task.
+ * @param dependencies the tasks that must finish first, which must already
+ * have been added.
+ * @return the task's id.
+ */
+TaskGraph::TaskId TaskGraph::Add(const char* name, std::function<void()> task,
+                                 const std::vector<TaskId>& dependencies) {
+  return AddTask(name, std::move(task), dependencies, false);
+}
+
+/**
+ * Adds a task that runs on the main thread, in RunMainThreadTasks().
+ * @param name the task's name, which must be a string literal.
+ * @param task the task.
+ * @param dependencies the tasks that must finish first, which must already
+ * have been added.
+ * @return the task's id.
+ */
+TaskGraph::TaskId TaskGraph::AddOnMainThread(
+    const char* name, std::function<void()> task,
+    const std::vector<TaskId>& dependencies) {
+  return AddTask(name, std::move(task), dependencies, true);
+}
+
+TaskGraph::TaskId TaskGraph::AddTask(const char* name,
+                                     std::function<void()> task,
+                                     const std::vector<TaskId>& dependencies,
+                                     bool on_main_thread) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!workers_.empty()) {
+    throw std::logic_error("Tasks can't be added once the graph has started");
+  }
+  const TaskId id = tasks_.size();
+  for (TaskId dependency : dependencies) {
+    if (dependency >= id) {
+      throw std::invalid_argument("A task can only depend on earlier tasks");
+    }
+    tasks_[dependency].dependents.push_back(id);
+  }
+  tasks_.push_back({ std::move(task), {}, dependencies.size(), State::kWaiting,
+                     { name, on_main_thread, 0, 0, false, "" } });
+  unfinished_++;
+  return id;
+}
+
+/**
+ * Starts running the tasks that don't depend on any others.
+ */
+void TaskGraph::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  start_ = Clock::now();
+  for (TaskId task = 0; task < tasks_.size(); task++) {
+    if (tasks_[task].remaining_dependencies == 0) {
+      MakeReady(task);
+    }
+  }
+  for (size_t thread = 0; thread < kThreads; thread++) {
+    workers_.emplace_back(&TaskGraph::RunWorker, this);
+  }
+}
+
+/**
+ * Queues a task whose dependencies have finished. The lock must be held.
+ * @param task the task.
+ */
+void TaskGraph::MakeReady(TaskId task) {
+  tasks_[task].state = State::kReady;
+  if (tasks_[task].timing.on_main_thread) {
+    main_thread_ready_.push_back(task);
+  } else {
+    ready_.push_back(task);
+  }
+  changed_.notify_all();
+}
+
+/**
+ * Runs the main-thread tasks that are ready, including any that become ready
+ * while they run.
+ * @return the number of tasks that were run.
+ */
+size_t TaskGraph::RunMainThreadTasks() {
+  size_t count = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!main_thread_ready_.empty()) {
+    const TaskId task = main_thread_ready_.front();
+    main_thread_ready_.pop_front();
+    lock.unlock();
+    Run(task);
+    count++;
+    lock.lock();
+  }
+  return count;
+}
+
+/**
+ * Runs tasks on the main thread until every task has finished.
+ */
+void TaskGraph::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (unfinished_ > 0) {
+    changed_.wait(lock, [this]() {
+      return unfinished_ == 0 || !main_thread_ready_.empty();
+    });
+    lock.unlock();
+    RunMainThreadTasks();
+    lock.lock();
+  }
+}
+
+/**
+ * Runs a task, and records how it went.
+ * @param task the task.
+ */
+void TaskGraph::Run(TaskId task) {
+  std::function<void()> function;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_[task].state = State::kRunning;
+    tasks_[task].timing.start_secs = std::chrono::duration<double>(
+        Clock::now() - start_).count();
+    function = std::move(tasks_[task].function);
+  }
+
+  std::string error;
+  {
+    TraceScope trace(tasks_[task].timing.name, "startup");
+    try {
+      function();
+    } catch (const std::exception& exception) {
+      error = exception.what();
+    } catch (...) {
+      error = "unknown error";
+    }
+  }
+  Finish(task, error);
+}
+
+/**
+ * Marks a task as finished, and readies the tasks that were waiting on it,
+ * or fails them if it failed.
+ * @param task the task.
+ * @param error why the task failed, or empty if it succeeded.
+ */
+void TaskGraph::Finish(TaskId task, const std::string& error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Timing& timing = tasks_[task].timing;
+  timing.secs = std::chrono::duration<double>(Clock::now() - start_).count()
+      - timing.start_secs;
+
+  // fail the task and everything that depends on it, or ready its dependents
+  std::vector<std::pair<TaskId, std::string>> finished = { { task, error } };
+  while (!finished.empty()) {
+    const TaskId current = finished.back().first;
+    const std::string current_error = finished.back().second;
+    finished.pop_back();
+
+    Task& finished_task = tasks_[current];
+    finished_task.state = current_error.empty() ? State::kDone
+                                                : State::kFailed;
+    finished_task.timing.failed = !current_error.empty();
+    finished_task.timing.error = current_error;
+    unfinished_--;
+
+    for (TaskId dependent : finished_task.dependents) {
+      if (tasks_[dependent].state != State::kWaiting) {
+        continue;
+      }
+      if (!current_error.empty()) {
+        finished.emplace_back(dependent, std::string("skipped, since ")
+            + finished_task.timing.name + " failed");
+      } else if (--tasks_[dependent].remaining_dependencies == 0) {
+        MakeReady(dependent);
+      }
+    }
+  }
+  changed_.notify_all();
+}
+
+/**
+ * A pool thread's loop, which runs ready tasks until there are none left.
+ */
+void TaskGraph::RunWorker() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    changed_.wait(lock, [this]() {
+      return is_stopping_ || unfinished_ == 0 || !ready_.empty();
+    });
+    if (is_stopping_ || ready_.empty()) {
+      return;
+    }
+    const TaskId task = ready_.front();
+    ready_.pop_front();
+    lock.unlock();
+    Run(task);
+    lock.lock();
+  }
+}
+
+/**
+ * Checks if a task has finished successfully.
+ * @param task the task.
+ * @return true if it has.
+ */
+bool TaskGraph::IsDone(TaskId task) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_[task].state == State::kDone;
+}
+
+/**
+ * Checks if a task failed, or was skipped because a dependency failed.
+ * @param task the task.
+ * @return true if it did.
+ */
+bool TaskGraph::HasFailed(TaskId task) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_[task].state == State::kFailed;
+}
+
+/**
+ * Checks if every task has finished, successfully or not.
+ * @return true if they have.
+ */
+bool TaskGraph::IsFinished() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return unfinished_ == 0;
+}
+
+/**
+ * Lists the tasks that haven't finished, to show what's still loading.
+ * @return the tasks' names, separated by commas.
+ */
+std::string TaskGraph::Pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string pending;
+  for (const Task& task : tasks_) {
+    if (task.state != State::kDone && task.state != State::kFailed) {
+      pending += (pending.empty() ? "" : ", ") + std::string(task.timing.name);
+    }
+  }
+  return pending;
+}
+
+/**
+ * Gets when every task ran, in the order they were added.
+ * @return the tasks' timings.
+ */
+std::vector<TaskGraph::Timing> TaskGraph::Timings() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Timing> timings;
+  for (const Task& task : tasks_) {
+    timings.push_back(task.timing);
+  }
+  return timings;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,251 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/tracer.h>
+
+#include <iomanip>
+
+namespace screamy_ball {
+
+using std::chrono::steady_clock;
+
+thread_local Tracer::ThreadBuffer* Tracer::thread_buffer_ = nullptr;
+
+/**
+ * Gets the tracer shared by the whole program, so that any module can record
+ * events without being handed a tracer.
+ * @return the tracer.
+ */
+Tracer& Tracer::Get() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer() :
+    kFlushInterval(50),
+    enabled_(false),
+    dropped_(0),
+    has_events_(false),
+    is_stopping_(false) {}
+
+Tracer::~Tracer() {
+  Stop();
+}
+
+/**
+ * Starts recording events, and starts the thread that writes them to a file.
+ * @param path the path of the trace file, which is overwritten.
+ * @return true if the file could be opened, false otherwise.
+ */
+bool Tracer::Start(const std::string& path) {
+  Stop();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_.open(path, std::ios::out | std::ios::trunc);
+  if (!file_) {
+    return false;
+  }
+  // timestamps are written in microseconds, to the nanosecond
+  file_ << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+  // anything recorded since the last trace is thrown away
+  for (auto& buffer : buffers_) {
+    buffer->read.store(buffer->written.load(std::memory_order_acquire),
+                       std::memory_order_release);
+    buffer->named = false;
+  }
+  has_events_ = false;
+  is_stopping_ = false;
+  dropped_.store(0);
+  start_ = steady_clock::now();
+  flusher_ = std::thread(&Tracer::RunFlusher, this);
+  enabled_.store(true, std::memory_order_release);
+  return true;
+}
+
+/**
+ * Stops recording events, writes the rest of them, and closes the file.
+ */
+void Tracer::Stop() {
+  if (!enabled_.exchange(false)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  stopping_.notify_all();
+  flusher_.join();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Flush();
+  file_ << "\n]}\n";
+  file_.close();
+}
+
+/**
+ * Checks if events are being recorded.
+ * @return true if tracing has started, false otherwise.
+ */
+bool Tracer::IsEnabled() const {
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+/**
+ * Names the calling thread in the trace.
+ * @param name the thread's name, which must be a string literal.
+ */
+void Tracer::NameThread(const char* name) {
+  CurrentThreadBuffer()->thread_name.store(name, std::memory_order_release);
+}
+
+/**
+ * Records an event from the calling thread, if tracing has started.
+ * @param name the event's name, which must be a string literal.
+ * @param category the event's category, which must be a string literal.
+ * @param phase the trace-event phase: 'X' for a complete event, or 'i' for an
+ * instant event.
+ * @param start when the event started.
+ * @param duration how long the event took.
+ */
+void Tracer::Record(const char* name, const char* category, char phase,
+                    steady_clock::time_point start,
+                    steady_clock::duration duration) {
+  if (!IsEnabled()) {
+    return;
+  }
+
+  ThreadBuffer* buffer = CurrentThreadBuffer();
+  const size_t written = buffer->written.load(std::memory_order_relaxed);
+  if (written - buffer->read.load(std::memory_order_acquire)
+      >= ThreadBuffer::kCapacity) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  buffer->events[written % ThreadBuffer::kCapacity] =
+      { name, category, phase, start, duration };
+  buffer->written.store(written + 1, std::memory_order_release);
+}
+
+/**
+ * Counts the events that were dropped because a buffer was full.
+ * @return the number of events dropped since tracing started.
+ */
+size_t Tracer::Dropped() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+/**
+ * Gets the calling thread's buffer, creating it the first time. This is the
+ * only time recording takes the lock.
+ * @return the calling thread's buffer.
+ */
+Tracer::ThreadBuffer* Tracer::CurrentThreadBuffer() {
+  if (thread_buffer_ == nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.emplace_back(new ThreadBuffer());
+    thread_buffer_ = buffers_.back().get();
+    thread_buffer_->thread_id = buffers_.size();
+  }
+  return thread_buffer_;
+}
+
+/**
+ * Writes every buffer's new events to the file. The lock must be held.
+ */
+void Tracer::Flush() {
+  for (auto& buffer : buffers_) {
+    FlushBuffer(buffer.get());
+  }
+  file_.flush();
+}
+
+/**
+ * Writes a buffer's new events to the file, and the thread's name the first
+ * time it's known. The lock must be held.
+ * @param buffer the buffer to write.
+ */
+void Tracer::FlushBuffer(ThreadBuffer* buffer) {
+  const char* thread_name =
+      buffer->thread_name.load(std::memory_order_acquire);
+  if (thread_name != nullptr && !buffer->named) {
+    file_ << (has_events_ ? ",\n" : "\n")
+          << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+          << buffer->thread_id << ",\"args\":{\"name\":\"" << thread_name
+          << "\"}}";
+    buffer->named = true;
+    has_events_ = true;
+  }
+
+  const size_t read = buffer->read.load(std::memory_order_relaxed);
+  const size_t written = buffer->written.load(std::memory_order_acquire);
+  for (size_t index = read; index < written; index++) {
+    const Event& event = buffer->events[index % ThreadBuffer::kCapacity];
+    const std::chrono::duration<double, std::micro> start =
+        event.start - start_;
+    const std::chrono::duration<double, std::micro> duration =
+        event.duration;
+
+    file_ << (has_events_ ? ",\n" : "\n")
+          << "{\"name\":\"" << event.name << "\",\"cat\":\""
+          << event.category << "\",\"ph\":\"" << event.phase
+          << "\",\"ts\":" << start.count() << ",\"pid\":1,\"tid\":"
+          << buffer->thread_id;
+    if (event.phase == 'X') {
+      file_ << ",\"dur\":" << duration.count();
+    } else {
+      file_ << ",\"s\":\"t\"";
+    }
+    file_ << "}";
+    has_events_ = true;
+  }
+  buffer->read.store(written, std::memory_order_release);
+}
+
+/**
+ * The background thread's loop, which flushes the buffers every
+ * kFlushInterval until tracing stops.
+ */
+void Tracer::RunFlusher() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!is_stopping_) {
+    stopping_.wait_for(lock, kFlushInterval);
+    Flush();
+  }
+}
+
+/**
+ * Starts timing an event, if tracing has started.
+ * @param name the event's name, which must be a string literal.
+ * @param category the event's category, which must be a string literal.
+ */
+TraceScope::TraceScope(const char* name, const char* category) :
+    kName(name),
+    kCategory(category),
+    kEnabled(Tracer::Get().IsEnabled()) {
+  if (kEnabled) {
+    start_ = steady_clock::now();
+  }
+}
+
+TraceScope::~TraceScope() {
+  if (kEnabled) {
+    Tracer::Get().Record(kName, kCategory, 'X', start_,
+                         steady_clock::now() - start_);
+  }
+}
+
+/**
+ * Records an event that happens at a single moment, if tracing has started.
+ * @param name the event's name, which must be a string literal.
+ * @param category the event's category, which must be a string literal.
+ */
+void TraceInstant(const char* name, const char* category) {
+  Tracer& tracer = Tracer::Get();
+  if (tracer.IsEnabled()) {
+    tracer.Record(name, category, 'i', steady_clock::now(),
+                  steady_clock::duration::zero());
+  }
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,236 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/voice_control.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCREAMY_BALL_SSE2
+#endif
+
+namespace screamy_ball {
+
+// the quietest level, so that silence doesn't take the log of 0
+const float kMinLevelDb = -120;
+// how quickly the background level follows louder and quieter blocks
+const float kBackgroundRise = 0.1f;
+const float kBackgroundFall = 0.5f;
+
+/**
+ * Calculates the root mean square of some samples, four at a time with SSE2
+ * when it's available.
+ * @param samples the samples.
+ * @param count the number of samples.
+ * @return the RMS, or 0 if there are no samples.
+ */
+float Rms(const float* samples, size_t count) {
+  if (count == 0) {
+    return 0;
+  }
+  return std::sqrt(SumSquaredDifference(samples, nullptr, count)
+                   / static_cast<float>(count));
+}
+
+/**
+ * Sums the squared differences between two runs of samples, four at a time
+ * with SSE2 when it's available.
+ * @param lhs the first samples.
+ * @param rhs the second samples, or nullptr to sum the squares of lhs.
+ * @param count the number of samples in each run.
+ * @return the sum of (lhs[i] - rhs[i])^2.
+ */
+float SumSquaredDifference(const float* lhs, const float* rhs, size_t count) {
+  size_t index = 0;
+  float sum = 0;
+
+#ifdef SCREAMY_BALL_SSE2
+  __m128 sums = _mm_setzero_ps();
+  for (; index + 4 <= count; index += 4) {
+    __m128 difference = _mm_loadu_ps(lhs + index);
+    if (rhs != nullptr) {
+      difference = _mm_sub_ps(difference, _mm_loadu_ps(rhs + index));
+    }
+    sums = _mm_add_ps(sums, _mm_mul_ps(difference, difference));
+  }
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, sums);
+  sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+  for (; index < count; index++) {
+    const float difference = lhs[index] - (rhs != nullptr ? rhs[index] : 0);
+    sum += difference * difference;
+  }
+  return sum;
+}
+
+/**
+ * Creates an analyzer, allocating everything it needs up front.
+ * @param sample_rate the microphone's sample rate.
+ * @param parameters the analyzer's thresholds.
+ */
+VoiceAnalyzer::VoiceAnalyzer(unsigned sample_rate,
+                             const VoiceParameters& parameters) :
+    kParameters(parameters),
+    kSampleRate(static_cast<float>(sample_rate)),
+    kMinLag(std::max<size_t>(2, static_cast<size_t>(
+        kSampleRate / parameters.max_pitch_hz))),
+    kMaxLag(std::max<size_t>(3, static_cast<size_t>(
+        kSampleRate / parameters.min_pitch_hz))),
+    history_(2 * kMaxLag, 0.0f),
+    history_filled_(0),
+    difference_(kMaxLag + 1, 0.0f),
+    level_db_(kMinLevelDb),
+    background_db_(parameters.quiet_db),
+    pitch_hz_(0),
+    low_tone_secs_(0),
+    no_tone_secs_(0),
+    cooldown_secs_(0),
+    is_ducking_(false) {}
+
+/**
+ * Analyzes the next block of samples. Blocks of around 10ms work best: they
+ * are long enough to measure loudness, and short enough to react quickly.
+ * @param samples the block's mono samples, between -1 and 1.
+ * @param count the number of samples.
+ * @return the command the block finishes, if any.
+ */
+VoiceEvent VoiceAnalyzer::Process(const float* samples, size_t count) {
+  const float block_secs = static_cast<float>(count) / kSampleRate;
+  AddToHistory(samples, count);
+
+  level_db_ = std::max(kMinLevelDb, 20 * std::log10(std::max(
+      1e-6f, Rms(samples, count))));
+  cooldown_secs_ = std::max(0.0f, cooldown_secs_ - block_secs);
+
+  VoiceEvent event = { VoiceCommand::kNone, 0 };
+
+  // a scream jumps higher the closer it is to full scale
+  const bool is_onset = level_db_ >= kParameters.scream_db
+      && level_db_ - background_db_ >= kParameters.onset_db;
+  if (is_onset && cooldown_secs_ <= 0) {
+    const float loudness = std::min(1.0f, std::max(0.0f,
+        (level_db_ - kParameters.scream_db) / -kParameters.scream_db));
+    event = { VoiceCommand::kJump,
+              50 + static_cast<int>(std::lround(loudness * 50)) };
+    cooldown_secs_ = kParameters.jump_cooldown_secs;
+  }
+
+  background_db_ += (level_db_ - background_db_)
+      * (level_db_ > background_db_ ? kBackgroundRise : kBackgroundFall);
+
+  pitch_hz_ = level_db_ > kParameters.quiet_db ? DetectPitch() : 0;
+  const bool is_low_tone = pitch_hz_ > 0
+      && pitch_hz_ < kParameters.low_tone_hz;
+  if (is_low_tone) {
+    low_tone_secs_ += block_secs;
+    no_tone_secs_ = 0;
+  } else {
+    no_tone_secs_ += block_secs;
+    low_tone_secs_ = 0;
+  }
+
+  if (event.command != VoiceCommand::kNone) {
+    is_ducking_ = false;
+  } else if (!is_ducking_ && low_tone_secs_ >= kParameters.duck_hold_secs) {
+    is_ducking_ = true;
+    event = { VoiceCommand::kDuck, 0 };
+  } else if (is_ducking_ && no_tone_secs_ >= kParameters.release_secs) {
+    is_ducking_ = false;
+    event = { VoiceCommand::kRelease, 0 };
+  }
+  return event;
+}
+
+/**
+ * Keeps the most recent samples, for pitch detection.
+ * @param samples the new samples.
+ * @param count the number of new samples.
+ */
+void VoiceAnalyzer::AddToHistory(const float* samples, size_t count) {
+  const size_t size = history_.size();
+  if (count >= size) {
+    std::copy(samples + count - size, samples + count, history_.begin());
+  } else {
+    std::copy(history_.begin() + static_cast<long>(count), history_.end(),
+              history_.begin());
+    std::copy(samples, samples + count,
+              history_.end() - static_cast<long>(count));
+  }
+  history_filled_ = std::min(size, history_filled_ + count);
+}
+
+/**
+ * Finds the pitch of the most recent samples with the YIN method: the
+ * shortest lag whose cumulative mean normalized difference is below the
+ * threshold, refined to the bottom of its dip. Lags shorter than the highest
+ * pitch's period are searched too, so that a higher sound isn't mistaken for
+ * one an octave below it.
+ * @return the pitch, in Hz, or 0 if the sound isn't pitched or is out of
+ * range.
+ */
+float VoiceAnalyzer::DetectPitch() {
+  if (history_filled_ < history_.size()) {
+    return 0;
+  }
+
+  const float* window = history_.data();
+  float running_sum = 0;
+  difference_[0] = 1;
+  for (size_t lag = 1; lag <= kMaxLag; lag++) {
+    const float difference = SumSquaredDifference(window, window + lag,
+                                                  kMaxLag);
+    running_sum += difference;
+    difference_[lag] = running_sum > 0
+        ? difference * static_cast<float>(lag) / running_sum : 1;
+  }
+
+  for (size_t lag = 2; lag < kMaxLag; lag++) {
+    if (difference_[lag] < kParameters.pitch_threshold) {
+      while (lag + 1 < kMaxLag && difference_[lag + 1] < difference_[lag]) {
+        lag++;
+      }
+      if (lag < kMinLag) {
+        return 0;
+      }
+
+      // fit a parabola through the dip, for a pitch between two lags
+      const float before = difference_[lag - 1];
+      const float at = difference_[lag];
+      const float after = difference_[lag + 1];
+      const float curvature = before - 2 * at + after;
+      const float offset = curvature > 0
+          ? (before - after) / (2 * curvature) : 0;
+      return kSampleRate / (static_cast<float>(lag) + offset);
+    }
+  }
+  return 0;
+}
+
+/**
+ * Gets the last block's loudness.
+ * @return the level, in dB relative to full scale.
+ */
+float VoiceAnalyzer::LevelDb() const {
+  return level_db_;
+}
+
+/**
+ * Gets the last block's pitch.
+ * @return the pitch, in Hz, or 0 if the block wasn't pitched.
+ */
+float VoiceAnalyzer::PitchHz() const {
+  return pitch_hz_;
+}
+
+/**
+ * Checks if the player is holding a low tone to duck.
+ * @return true if the ball should be ducking.
+ */
+bool VoiceAnalyzer::IsDucking() const {
+  return is_ducking_;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,237 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/wav.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace screamy_ball {
+
+const uint16_t kPcmFormat = 1;
+const uint16_t kFloatFormat = 3;
+const float kPcm16Scale = 32768.0f;
+
+/**
+ * Reads a little-endian unsigned integer of `bytes` bytes.
+ */
+uint32_t ReadUnsigned(std::istream& input, size_t bytes) {
+  uint32_t value = 0;
+  for (size_t byte = 0; byte < bytes; byte++) {
+    const int next = input.get();
+    if (next == std::char_traits<char>::eof()) {
+      throw std::invalid_argument("The WAV file ends too early");
+    }
+    value |= static_cast<uint32_t>(next & 0xff) << (8 * byte);
+  }
+  return value;
+}
+
+/**
+ * Writes a little-endian unsigned integer of `bytes` bytes.
+ */
+void WriteUnsigned(std::ostream& output, uint32_t value, size_t bytes) {
+  for (size_t byte = 0; byte < bytes; byte++) {
+    output.put(static_cast<char>((value >> (8 * byte)) & 0xff));
+  }
+}
+
+/**
+ * Reads a WAV file with 16-bit integer or 32-bit float samples.
+ * @param input the file, opened in binary mode.
+ * @return the file's audio, with samples between -1 and 1.
+ * @throws std::invalid_argument if the file isn't a WAV file in one of those
+ * formats, or has no channels or sample rate.
+ */
+WavData ReadWav(std::istream& input) {
+  char id[4];
+  if (!input.read(id, 4) || std::memcmp(id, "RIFF", 4) != 0) {
+    throw std::invalid_argument("Not a WAV file");
+  }
+  ReadUnsigned(input, 4);
+  if (!input.read(id, 4) || std::memcmp(id, "WAVE", 4) != 0) {
+    throw std::invalid_argument("Not a WAV file");
+  }
+
+  WavData wav = { 0, 0, {} };
+  uint16_t format = 0;
+  uint16_t bits = 0;
+  while (input.read(id, 4)) {
+    const uint32_t size = ReadUnsigned(input, 4);
+
+    if (std::memcmp(id, "fmt ", 4) == 0) {
+      if (size < 16) {
+        throw std::invalid_argument("The WAV file's format is too short");
+      }
+      format = static_cast<uint16_t>(ReadUnsigned(input, 2));
+      wav.channels = ReadUnsigned(input, 2);
+      wav.sample_rate = ReadUnsigned(input, 4);
+      ReadUnsigned(input, 6);
+      bits = static_cast<uint16_t>(ReadUnsigned(input, 2));
+      if (wav.channels == 0 || wav.sample_rate == 0) {
+        throw std::invalid_argument("The WAV file has no channels or no "
+                                    "sample rate");
+      }
+      input.ignore(size - 16 + size % 2);
+    } else if (std::memcmp(id, "data", 4) == 0) {
+      if (wav.channels == 0) {
+        throw std::invalid_argument("The WAV file's data comes before its "
+                                    "format");
+      }
+      if (format == kPcmFormat && bits == 16) {
+        wav.samples.resize(size / 2);
+        for (float& sample : wav.samples) {
+          sample = static_cast<float>(static_cast<int16_t>(
+              ReadUnsigned(input, 2))) / kPcm16Scale;
+        }
+      } else if (format == kFloatFormat && bits == 32) {
+        wav.samples.resize(size / 4);
+        for (float& sample : wav.samples) {
+          const uint32_t bits_of_sample = ReadUnsigned(input, 4);
+          std::memcpy(&sample, &bits_of_sample, sizeof(sample));
+        }
+      } else {
+        throw std::invalid_argument("WAV files must have 16-bit integer or "
+                                    "32-bit float samples");
+      }
+      return wav;
+    } else {
+      input.ignore(size + size % 2);
+    }
+  }
+  throw std::invalid_argument("The WAV file has no data");
+}
+
+/**
+ * Writes audio to a WAV file, with 16-bit integer samples.
+ * @param output the file, opened in binary mode.
+ * @param wav the audio, with samples between -1 and 1.
+ */
+void WriteWav(std::ostream& output, const WavData& wav) {
+  const uint32_t data_size = static_cast<uint32_t>(wav.samples.size() * 2);
+
+  output.write("RIFF", 4);
+  WriteUnsigned(output, 36 + data_size, 4);
+  output.write("WAVEfmt ", 8);
+  WriteUnsigned(output, 16, 4);
+  WriteUnsigned(output, kPcmFormat, 2);
+  WriteUnsigned(output, wav.channels, 2);
+  WriteUnsigned(output, wav.sample_rate, 4);
+  WriteUnsigned(output, wav.sample_rate * wav.channels * 2, 4);
+  WriteUnsigned(output, wav.channels * 2, 2);
+  WriteUnsigned(output, 16, 2);
+  output.write("data", 4);
+  WriteUnsigned(output, data_size, 4);
+
+  for (float sample : wav.samples) {
+    const float clamped = std::min(1.0f, std::max(-1.0f, sample));
+    const auto value = static_cast<int16_t>(std::min(32767.0f,
+                                                     clamped * kPcm16Scale));
+    WriteUnsigned(output, static_cast<uint16_t>(value), 2);
+  }
+}
+
+/**
+ * Averages the channels of some audio.
+ * @param wav the audio.
+ * @return one sample for every frame of the audio.
+ */
+std::vector<float> MixToMono(const WavData& wav) {
+  const size_t channels = std::max(1u, wav.channels);
+  std::vector<float> mono(wav.samples.size() / channels);
+  for (size_t frame = 0; frame < mono.size(); frame++) {
+    float sum = 0;
+    for (size_t channel = 0; channel < channels; channel++) {
+      sum += wav.samples[frame * channels + channel];
+    }
+    mono[frame] = sum / static_cast<float>(channels);
+  }
+  return mono;
+}
+
+/**
+ * Splits the channels of some audio, so that every channel's frames come one
+ * after another, the way Cinder's audio buffers store them.
+ * @param wav the audio.
+ * @return the first channel's frames, then the second's, and so on.
+ */
+std::vector<float> Deinterleave(const WavData& wav) {
+  const size_t channels = std::max(1u, wav.channels);
+  const size_t frames = wav.samples.size() / channels;
+  std::vector<float> planar(frames * channels);
+  for (size_t frame = 0; frame < frames; frame++) {
+    for (size_t channel = 0; channel < channels; channel++) {
+      planar[channel * frames + frame] = wav.samples[frame * channels + channel];
+    }
+  }
+  return planar;
+}
+
+/**
+ * Changes mono audio's sample rate, interpolating linearly between samples.
+ * @param samples the audio's samples.
+ * @param from_rate the audio's sample rate.
+ * @param to_rate the new sample rate.
+ * @return the resampled audio.
+ * @throws std::invalid_argument if either rate is 0.
+ */
+std::vector<float> Resample(const std::vector<float>& samples,
+                            unsigned from_rate, unsigned to_rate) {
+  if (from_rate == 0 || to_rate == 0) {
+    throw std::invalid_argument("Audio can't be resampled to or from a "
+                                "sample rate of 0");
+  }
+  if (from_rate == to_rate || samples.empty()) {
+    return samples;
+  }
+  const size_t count = static_cast<size_t>(
+      static_cast<unsigned long long>(samples.size()) * to_rate / from_rate);
+  const double step = static_cast<double>(from_rate) / to_rate;
+
+  std::vector<float> resampled(count);
+  for (size_t index = 0; index < count; index++) {
+    const double position = static_cast<double>(index) * step;
+    const size_t before = std::min(static_cast<size_t>(position),
+                                   samples.size() - 1);
+    const size_t after = std::min(before + 1, samples.size() - 1);
+    const auto fraction = static_cast<float>(
+        position - static_cast<double>(before));
+    resampled[index] = samples[before]
+        + (samples[after] - samples[before]) * fraction;
+  }
+  return resampled;
+}
+
+/**
+ * Changes the sample rate of audio whose channels are stored one after
+ * another, resampling each channel on its own.
+ * @param samples the audio's samples, as Deinterleave() returns them.
+ * @param channels the number of channels.
+ * @param from_rate the audio's sample rate.
+ * @param to_rate the new sample rate.
+ * @return the resampled audio, with its channels still one after another.
+ * @throws std::invalid_argument if either rate is 0.
+ */
+std::vector<float> ResamplePlanar(const std::vector<float>& samples,
+                                  unsigned channels, unsigned from_rate,
+                                  unsigned to_rate) {
+  if (from_rate == to_rate || channels <= 1) {
+    return Resample(samples, from_rate, to_rate);
+  }
+  const size_t frames = samples.size() / channels;
+  std::vector<float> resampled;
+  for (size_t channel = 0; channel < channels; channel++) {
+    const auto start = samples.begin()
+        + static_cast<std::ptrdiff_t>(channel * frames);
+    const std::vector<float> converted = Resample(
+        std::vector<float>(start, start + static_cast<std::ptrdiff_t>(frames)),
+        from_rate, to_rate);
+    resampled.insert(resampled.end(), converted.begin(), converted.end());
+  }
+  return resampled;
+}
+
+}  // namespace screamy_ball
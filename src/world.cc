@@ -0,0 +1,214 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/world.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace screamy_ball {
+
+/**
+ * Creates a camera at the start of the world.
+ * @param width the width of the view, in tiles.
+ * @param height the height of the view, in tiles.
+ */
+Camera::Camera(double width, double height) :
+    kWidth(width),
+    kHeight(height),
+    left_(0) {}
+
+/**
+ * Moves the camera along the world.
+ * @param left the world position of the view's left edge, in tiles.
+ */
+void Camera::MoveTo(double left) {
+  left_ = left;
+}
+
+/**
+ * Gets the world position of the view's left edge.
+ * @return the position, in tiles.
+ */
+double Camera::Left() const {
+  return left_;
+}
+
+/**
+ * Gets the world position of the view's right edge.
+ * @return the position, in tiles.
+ */
+double Camera::Right() const {
+  return left_ + kWidth;
+}
+
+/**
+ * Gets the height of the view.
+ * @return the height, in tiles.
+ */
+double Camera::Height() const {
+  return kHeight;
+}
+
+/**
+ * Converts a world position to a position in the view.
+ * @param world_x the world position, in tiles.
+ * @param parallax how fast the position's layer scrolls, from 0 for one
+ * that never moves to 1 for the board itself.
+ * @return the position from the view's left edge, in tiles.
+ */
+double Camera::ToScreen(double world_x, double parallax) const {
+  return world_x - left_ * parallax;
+}
+
+/**
+ * Checks whether any of a span of the world can be seen.
+ * @param left the span's left edge, in tiles.
+ * @param right the span's right edge, in tiles.
+ * @param parallax how fast the span's layer scrolls.
+ * @return true if part of the span is in the view.
+ */
+bool Camera::IsVisible(double left, double right, double parallax) const {
+  const double view_left = left_ * parallax;
+  return right > view_left && left < view_left + kWidth;
+}
+
+/**
+ * Finds the first of a row of evenly spaced things in a layer that can be
+ * seen, so a layer only draws the things in the view, however long it is.
+ * @param spacing the distance between the things, in tiles, which must be
+ * at least as wide as each of them.
+ * @param parallax how fast the layer scrolls.
+ * @return the index of the first thing, where thing i is at i * spacing.
+ */
+long long Camera::FirstVisible(double spacing, double parallax) const {
+  return static_cast<long long>(std::floor(left_ * parallax / spacing));
+}
+
+/**
+ * Creates an empty ring of chunks, starting at the start of the world.
+ * @param chunk_tiles the width of a chunk, in tiles, which is also the
+ * widest an obstacle can be.
+ * @param resident_chunks how many chunks are kept at once.
+ * @param chunk_capacity the most obstacles a chunk can hold.
+ * @throws std::invalid_argument if any of them is 0.
+ */
+ObstacleChunks::ObstacleChunks(int chunk_tiles, size_t resident_chunks,
+                               size_t chunk_capacity) :
+    kChunkWidth(static_cast<long long>(chunk_tiles) * kSubTiles),
+    kResidentChunks(resident_chunks),
+    kChunkCapacity(chunk_capacity),
+    obstacles_(resident_chunks * chunk_capacity),
+    counts_(resident_chunks),
+    first_chunk_(0),
+    size_(0) {
+  if (chunk_tiles <= 0 || resident_chunks == 0 || chunk_capacity == 0) {
+    throw std::invalid_argument("Obstacle chunks must have a width, and "
+                                "room for at least one obstacle");
+  }
+}
+
+/**
+ * Adds an obstacle to the chunk it starts in, keeping the chunk in order.
+ * @param obstacle the obstacle.
+ * @return false if its chunk isn't resident or is full, or it's wider than
+ * a chunk, in which case it isn't added.
+ */
+bool ObstacleChunks::Add(const WorldObstacle& obstacle) {
+  const long long chunk = ChunkOf(Start(obstacle));
+  if (chunk < first_chunk_ || chunk >= EndChunk()
+      || End(obstacle) - Start(obstacle) > kChunkWidth) {
+    return false;
+  }
+  const size_t slot = Slot(chunk);
+  if (counts_[slot] == kChunkCapacity) {
+    return false;
+  }
+
+  WorldObstacle* first = &obstacles_[slot * kChunkCapacity];
+  WorldObstacle* end = first + counts_[slot];
+  WorldObstacle* position = std::upper_bound(first, end, obstacle,
+      [](const WorldObstacle& lhs, const WorldObstacle& rhs) {
+        return lhs.x < rhs.x; });
+  std::copy_backward(position, end, end + 1);
+  *position = obstacle;
+  counts_[slot]++;
+  size_++;
+  return true;
+}
+
+/**
+ * Releases the chunks before a chunk, which frees their slots for the
+ * chunks after the last resident one.
+ * @param first_chunk the first chunk to keep. Chunks are never brought back,
+ * so an earlier chunk than the first resident one does nothing.
+ */
+void ObstacleChunks::Release(long long first_chunk) {
+  if (first_chunk <= first_chunk_) {
+    return;
+  }
+  const long long end = std::min(first_chunk, EndChunk());
+  for (long long chunk = first_chunk_; chunk < end; chunk++) {
+    size_ -= counts_[Slot(chunk)];
+    counts_[Slot(chunk)] = 0;
+  }
+  first_chunk_ = first_chunk;
+}
+
+/**
+ * Removes every obstacle, and moves the ring back to the start of the world.
+ */
+void ObstacleChunks::Clear() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  first_chunk_ = 0;
+  size_ = 0;
+}
+
+/**
+ * Finds the chunk a world position is in.
+ * @param x the position, in sub-tiles.
+ * @return the chunk, rounded down, so positions before the start of the
+ * world are in negative chunks.
+ */
+long long ObstacleChunks::ChunkOf(long long x) const {
+  return x >= 0 ? x / kChunkWidth : -((-x + kChunkWidth - 1) / kChunkWidth);
+}
+
+/**
+ * Gets the first resident chunk.
+ * @return the chunk.
+ */
+long long ObstacleChunks::FirstChunk() const {
+  return first_chunk_;
+}
+
+/**
+ * Gets the chunk after the last resident one.
+ * @return the chunk.
+ */
+long long ObstacleChunks::EndChunk() const {
+  return first_chunk_ + static_cast<long long>(kResidentChunks);
+}
+
+/**
+ * Counts the obstacles in the resident chunks.
+ * @return the number of obstacles.
+ */
+size_t ObstacleChunks::Size() const {
+  return size_;
+}
+
+size_t ObstacleChunks::Slot(long long chunk) const {
+  const auto chunks = static_cast<long long>(kResidentChunks);
+  return static_cast<size_t>((chunk % chunks + chunks) % chunks);
+}
+
+long long ObstacleChunks::Start(const WorldObstacle& obstacle) const {
+  return obstacle.x - kSubTiles;
+}
+
+long long ObstacleChunks::End(const WorldObstacle& obstacle) const {
+  return obstacle.x + static_cast<long long>(obstacle.length - 1) * kSubTiles;
+}
+
+}  // namespace screamy_ball
@@ -0,0 +1,201 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/autoplayer.h>
+#include <screamy-ball/collision.h>
+#include <screamy-ball/engine.h>
+#include <screamy-ball/music_stream.h>
+#include <screamy-ball/particles.h>
+#include <screamy-ball/profiler.h>
+#include <screamy-ball/sample_player.h>
+#include <screamy-ball/shared_env.h>
+#include <screamy-ball/speech_gate.h>
+#include <screamy-ball/voice_control.h>
+
+#include "temp_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Counts every allocation made by the tests, so that the game loop can be
+// checked to never allocate.
+static std::atomic<size_t> allocation_count(0);
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* memory = std::malloc(size == 0 ? 1 : size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+  std::free(memory);
+}
+
+using namespace screamy_ball;
+
+/**
+ * A silent track, for streaming.
+ */
+class SilentTrack : public MusicSource {
+ public:
+  size_t Channels() const override {
+    return 2;
+  }
+
+  size_t Frames() const override {
+    return 44100;
+  }
+
+  size_t Read(float* samples, size_t frames) override {
+    std::fill(samples, samples + frames * 2, 0.0f);
+    return frames;
+  }
+
+  void Seek(size_t) override {}
+};
+
+TEST_CASE("The game loop doesn't allocate", "[allocation]") {
+  const int ticks = 1000;
+  Engine engine({2, 14}, 16, 16, 0);
+  EngineParameters constant_speed;
+  constant_speed.ramp_ticks = 0;
+  Engine bot_engine({2, 14}, 16, 16, 0, constant_speed);
+  Autoplayer autoplayer(12);
+
+  SECTION("Running the engine") {
+    const size_t start = allocation_count.load();
+    for (int tick = 0; tick < ticks; tick++) {
+      engine.Run();
+      if (engine.state_ == BallState::kCollided) {
+        engine.Reset();
+      }
+    }
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Autoplaying the engine") {
+    const size_t start = allocation_count.load();
+    for (int tick = 0; tick < ticks; tick++) {
+      Autoplayer::Apply(&bot_engine, autoplayer.Decide(bot_engine));
+      bot_engine.Run();
+    }
+    REQUIRE(bot_engine.state_ != BallState::kCollided);
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Checking for collisions") {
+    TriangleBatch spikes;
+    const size_t start = allocation_count.load();
+    for (int index = 0; index < ticks; index++) {
+      spikes.Clear();
+      spikes.Add({ 3, 14, 2, 14, 2.5f, 12 });
+      spikes.Add({ 4, 14, 3, 14, 3.5f, 12 });
+      Intersects({ 2.5f, 13.5f, 0.5f, 0.5f }, spikes);
+    }
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Profiling frames") {
+    FrameProfiler profiler;
+    const size_t start = allocation_count.load();
+    for (int frame = 0; frame < ticks; frame++) {
+      profiler.BeginFrame();
+      ScopedTimer timer(&profiler, 0);
+    }
+    profiler.Percentile(0, 0.99);
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Triggering and mixing samples") {
+    SamplePlayer player(std::vector<float>(4096, 0.5f), 2, 8);
+    std::vector<float> output(2 * 512);
+    const size_t start = allocation_count.load();
+    for (int block = 0; block < ticks; block++) {
+      player.Trigger();
+      player.Mix(output.data(), 2, 512);
+    }
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Gating speech into the recognizer's ring buffer") {
+    SpeechGate gate(16000, 160);
+    AudioRing ring(16000);
+    std::vector<float> block(160, 0.25f);
+    std::vector<float> read(160);
+    const size_t start = allocation_count.load();
+    for (int tick = 0; tick < ticks; tick++) {
+      block[0] = tick % 50 < 25 ? 0.25f : 0;
+      const size_t count = gate.Process(block.data(), block.size());
+      ring.Write(gate.Output(), count);
+      ring.Read(read.data(), read.size());
+    }
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Streaming music, in the audio callback and the worker") {
+    LoopPoints loop;
+    loop.crossfade = 4410;
+    MusicStreamer streamer(std::unique_ptr<MusicSource>(new SilentTrack()),
+                           44100, loop);
+    std::vector<float> output(512 * 2);
+    streamer.Fill();
+    const size_t start = allocation_count.load();
+    for (int block = 0; block < ticks; block++) {
+      streamer.Mix(output.data(), 2, 512);
+      streamer.Fill();
+    }
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Emitting, moving and drawing particles, even when full") {
+    ParticleSystem particles(1000, 0);
+    std::vector<float> instances(
+        particles.Capacity() * ParticleSystem::kInstanceFloats);
+    const Burst sparks = { 2, 14, 300, 1, 4, 1.57f, 1.57f, 0.5f, 20, 0 };
+    const size_t start = allocation_count.load();
+    for (int tick = 0; tick < ticks; tick++) {
+      particles.Emit(sparks);
+      particles.Update(1.0f / 60);
+      particles.WriteInstances(instances.data());
+    }
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Stepping and resetting shared environments") {
+    const TempFile file("allocation_test.env");
+    SharedEnvServer server(file.Path(), 64, 4, 16, 16, 0, 50);
+    SharedEnvClient client(file.Path());
+    const size_t start = allocation_count.load();
+    for (int tick = 0; tick < ticks; tick++) {
+      client.SetAllActions(tick % 100 == 0
+          ? kResetAction : static_cast<uint8_t>(tick % 3));
+      client.Submit();
+      server.ServeBatch(0);
+      client.Wait(0);
+    }
+    REQUIRE(client.Batch() == ticks);
+    REQUIRE(allocation_count.load() == start);
+  }
+
+  SECTION("Analyzing the microphone's samples") {
+    VoiceAnalyzer analyzer(16000);
+    std::vector<float> block(160, 0.25f);
+    const size_t start = allocation_count.load();
+    for (int tick = 0; tick < ticks; tick++) {
+      block[static_cast<size_t>(tick) % block.size()] = -0.25f;
+      analyzer.Process(block.data(), block.size());
+    }
+    REQUIRE(allocation_count.load() == start);
+  }
+}
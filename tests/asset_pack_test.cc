@@ -0,0 +1,124 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/asset_pack.h>
+#include <screamy-ball/wav.h>
+
+#include "temp_file.h"
+
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using screamy_ball::AssetPack;
+using screamy_ball::AssetPackWriter;
+using screamy_ball::Deinterleave;
+using screamy_ball::kPackAlignment;
+using screamy_ball::PackedAsset;
+using screamy_ball::ResamplePlanar;
+
+// removed once the tests are done
+const TempFile kPackFile("asset_pack_test.pack");
+
+/**
+ * Writes a pack to the test's file.
+ * @param writer the pack.
+ */
+void WritePack(const AssetPackWriter& writer) {
+  std::ofstream output(kPackFile.Path(), std::ios::binary);
+  writer.Write(output);
+}
+
+TEST_CASE("Asset packs", "[asset_pack]") {
+  AssetPackWriter writer;
+  writer.AddFile("help.txt", "Help: Screamy Ball\nDodge the spikes.\n");
+  writer.AddFile("empty.txt", "");
+  // two channels of three frames, one channel after the other
+  writer.AddPcm("scream.wav", { 0.1f, 0.2f, 0.3f, -0.1f, -0.2f, -0.3f },
+                44100, 2);
+  WritePack(writer);
+
+  SECTION("Files read back as they were written") {
+    const AssetPack pack(kPackFile.Path());
+    const PackedAsset* help = pack.Find("help.txt");
+    REQUIRE(help != nullptr);
+    REQUIRE_FALSE(help->is_pcm);
+    REQUIRE(std::string(help->data, help->size)
+            == "Help: Screamy Ball\nDodge the spikes.\n");
+    REQUIRE(pack.Find("empty.txt")->size == 0);
+  }
+
+  SECTION("Decoded audio is split into its channels") {
+    const AssetPack pack(kPackFile.Path());
+    const PackedAsset* scream = pack.Find("scream.wav");
+    REQUIRE(scream->is_pcm);
+    REQUIRE(scream->sample_rate == 44100);
+    REQUIRE(scream->channels == 2);
+    REQUIRE(scream->Frames() == 3);
+    REQUIRE(scream->Samples(0)[2] == Approx(0.3f));
+    REQUIRE(scream->Samples(1)[0] == Approx(-0.1f));
+  }
+
+  SECTION("Every asset starts on its own page") {
+    const AssetPack pack(kPackFile.Path());
+    const char* start = pack.Find("help.txt")->data;
+    for (const std::string& name : pack.Names()) {
+      const auto offset = static_cast<size_t>(pack.Find(name)->data - start);
+      REQUIRE(offset % kPackAlignment == 0);
+    }
+    REQUIRE(pack.Names() == std::vector<std::string>(
+        { "empty.txt", "help.txt", "scream.wav" }));
+  }
+
+  SECTION("Missing assets aren't found") {
+    const AssetPack pack(kPackFile.Path());
+    REQUIRE(pack.Find("music.mp3") == nullptr);
+  }
+
+  SECTION("Audio that can't be split into channels is rejected") {
+    REQUIRE_THROWS_AS(writer.AddPcm("odd.wav", { 0, 0, 0 }, 44100, 2),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("Invalid asset packs", "[asset_pack]") {
+  SECTION("A missing pack can't be opened") {
+    REQUIRE_THROWS_AS(AssetPack("no_such_pack.pack"), std::runtime_error);
+  }
+
+  SECTION("Anything that isn't a pack is rejected") {
+    std::ofstream(kPackFile.Path(), std::ios::binary) << "RIFF, not a pack at all";
+    REQUIRE_THROWS_AS(AssetPack(kPackFile.Path()), std::invalid_argument);
+  }
+
+  SECTION("A truncated pack is rejected") {
+    AssetPackWriter writer;
+    writer.AddFile("help.txt", std::string(kPackAlignment * 2, 'x'));
+    std::ofstream output(kPackFile.Path(), std::ios::binary);
+    writer.Write(output);
+    output.close();
+
+    std::ifstream input(kPackFile.Path(), std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(input)),
+                      std::istreambuf_iterator<char>());
+    input.close();
+    std::ofstream(kPackFile.Path(), std::ios::binary).write(
+        bytes.data(), static_cast<std::streamsize>(kPackAlignment * 2));
+    REQUIRE_THROWS_AS(AssetPack(kPackFile.Path()), std::invalid_argument);
+  }
+}
+
+TEST_CASE("Decoded audio for packs", "[asset_pack]") {
+  SECTION("Interleaved frames are split into channels") {
+    const screamy_ball::WavData wav = { 44100, 2, { 1, -1, 2, -2, 3, -3 } };
+    REQUIRE(Deinterleave(wav) == std::vector<float>({ 1, 2, 3, -1, -2, -3 }));
+  }
+
+  SECTION("Each channel is resampled on its own") {
+    const std::vector<float> resampled = ResamplePlanar(
+        { 0, 1, 2, 3, 10, 11, 12, 13 }, 2, 2, 1);
+    REQUIRE(resampled == std::vector<float>({ 0, 2, 10, 12 }));
+  }
+}
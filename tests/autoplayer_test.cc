@@ -0,0 +1,60 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/autoplayer.h>
+#include <screamy-ball/engine.h>
+
+#include <catch2/catch.hpp>
+
+using namespace screamy_ball;
+
+TEST_CASE("Autoplayer applies actions like a player", "[autoplayer]") {
+  Engine engine({2, 14}, 16, 16, 0);
+
+  SECTION("The ball can't duck mid-air") {
+    engine.state_ = BallState::kJumping;
+    REQUIRE_FALSE(Autoplayer::Apply(&engine, Action::kDuck));
+    REQUIRE(engine.state_ == BallState::kJumping);
+  }
+
+  SECTION("The ball stops ducking by rolling") {
+    REQUIRE(Autoplayer::Apply(&engine, Action::kDuck));
+    REQUIRE(Autoplayer::Apply(&engine, Action::kRoll));
+    REQUIRE(engine.state_ == BallState::kRolling);
+  }
+}
+
+TEST_CASE("Autoplayer avoids obstacles", "[autoplayer]") {
+  Location loc = {2, 14};
+  Engine engine(loc, 16, 16, 0);
+  Autoplayer autoplayer(12);
+
+  SECTION("Jumps over a low obstacle") {
+    engine.obstacle_.type = ObstacleType::kLow;
+    engine.obstacle_.location = { loc.Row() + 6, loc.Col() };
+
+    bool has_jumped = false;
+    for (int tick = 0; tick < 12; tick++) {
+      const Action action = autoplayer.Decide(engine);
+      has_jumped |= action == Action::kJump;
+      Autoplayer::Apply(&engine, action);
+      engine.Run();
+      REQUIRE(engine.state_ != BallState::kCollided);
+    }
+    REQUIRE(has_jumped);
+  }
+
+  SECTION("Ducks from a high obstacle") {
+    engine.obstacle_.type = ObstacleType::kHigh;
+    engine.obstacle_.location = { loc.Row() + 1, loc.Col() - 3 };
+    REQUIRE(autoplayer.Decide(engine) == Action::kDuck);
+  }
+
+  SECTION("Survives a seeded game") {
+    for (int tick = 0; tick < 1000; tick++) {
+      Autoplayer::Apply(&engine, autoplayer.Decide(engine));
+      engine.Run();
+      REQUIRE(engine.state_ != BallState::kCollided);
+    }
+    REQUIRE(autoplayer.Decisions() == 1000);
+  }
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/collision.h>
+
+#include <catch2/catch.hpp>
+#include <random>
+
+using namespace screamy_ball;
+
+TEST_CASE("Ellipse and triangle intersection", "[collision]") {
+  const Triangle spike = { 1, 2, 0, 2, 0.5f, 0 };
+
+  SECTION("A circle around the spike's tip intersects it") {
+    REQUIRE(Intersects({ 0.5f, -0.25f, 0.5f, 0.5f }, spike));
+  }
+
+  SECTION("A circle inside the spike intersects it") {
+    REQUIRE(Intersects({ 0.5f, 1.5f, 0.1f, 0.1f }, spike));
+  }
+
+  SECTION("A circle beside the spike's slope doesn't intersect it") {
+    REQUIRE_FALSE(Intersects({ 1.2f, 0.5f, 0.3f, 0.3f }, spike));
+  }
+
+  SECTION("A flat ellipse under the spike's tip doesn't intersect it") {
+    const Triangle high_spike = { 1, 0, 0, 0, 0.5f, 1.5f };
+    REQUIRE_FALSE(Intersects({ 0.5f, 1.875f, 0.5f, 0.125f }, high_spike));
+    REQUIRE(Intersects({ 0.5f, 1.5f, 0.5f, 0.5f }, high_spike));
+  }
+}
+
+TEST_CASE("Batched intersection matches single intersection", "[collision]") {
+  std::minstd_rand rng(0);
+  std::uniform_real_distribution<float> coordinate(-3, 3);
+  std::uniform_real_distribution<float> radius(0.1f, 1);
+
+  for (int trial = 0; trial < 1000; trial++) {
+    const Ellipse ellipse = { coordinate(rng), coordinate(rng), radius(rng),
+                              radius(rng) };
+    TriangleBatch batch;
+    bool any_intersects = false;
+
+    // odd sizes exercise both the SIMD path and the remainder
+    const int size = trial % 11 + 1;
+    for (int index = 0; index < size; index++) {
+      const Triangle triangle = { coordinate(rng), coordinate(rng),
+                                  coordinate(rng), coordinate(rng),
+                                  coordinate(rng), coordinate(rng) };
+      batch.Add(triangle);
+      any_intersects |= Intersects(ellipse, triangle);
+    }
+    REQUIRE(Intersects(ellipse, batch) == any_intersects);
+  }
+}
@@ -5,6 +5,7 @@
 #include <screamy-ball/engine.h>
 
 #include <catch2/catch.hpp>
+#include <limits>
 
 using namespace screamy_ball;
 
@@ -29,15 +30,37 @@ TEST_CASE("Jump test", "[jump]") {
       REQUIRE(engine.ball_.location == Location(loc.Row(), loc.Col() - 1));
     }
 
-    SECTION("Ball has reached max height") {
-      Location initial_loc(loc.Row(), engine.kMaxHeight + 1);
-      engine.ball_.location = initial_loc;
-      engine.Run();
+    SECTION("Ball rises to its max height and falls back down") {
+      EngineParameters parameters;
+      for (int tick = 0; tick < parameters.jump_ticks; tick++) {
+        REQUIRE(engine.ball_.location.Col() > engine.kMaxHeight);
+        engine.Run();
+      }
       REQUIRE(engine.ball_.location == Location(loc.Row(),
           engine.kMaxHeight));
 
-      engine.Run();
-      REQUIRE(engine.ball_.location == initial_loc);
+      int ticks_to_land = 0;
+      while (engine.state_ == BallState::kJumping) {
+        engine.Run();
+        ticks_to_land++;
+      }
+      REQUIRE(engine.ball_.location == loc);
+      REQUIRE(ticks_to_land == parameters.jump_ticks + 1);
+    }
+
+    SECTION("A weaker jump peaks lower but lasts as long") {
+      EngineParameters parameters;
+      engine.SetJumpStrength(50);
+      int peak = loc.Col();
+      int ticks = 0;
+      while (engine.state_ == BallState::kJumping) {
+        engine.Run();
+        peak = std::min(peak, engine.ball_.location.Col());
+        ticks++;
+      }
+      REQUIRE(peak > engine.kMaxHeight);
+      REQUIRE(peak < loc.Col() - 1);
+      REQUIRE(ticks == 2 * parameters.jump_ticks + 1);
     }
   }
 }
@@ -117,4 +140,302 @@ TEST_CASE("Collision test", "[collision]") {
       REQUIRE(engine.state_ == BallState::kCollided);
     }
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Seeded engine test", "[seed]") {
+  Location loc = {2, 14};
+  Engine engine(loc, kWidth, kHeight, 42);
+  Engine same_seed(loc, kWidth, kHeight, 42);
+
+  for (int tick = 0; tick < 100; tick++) {
+    engine.Run();
+    same_seed.Run();
+    REQUIRE(engine.obstacle_.location == same_seed.obstacle_.location);
+    REQUIRE(engine.obstacle_.length == same_seed.obstacle_.length);
+  }
+}
+
+TEST_CASE("Engine parameters test", "[parameters]") {
+  Location loc = {2, 14};
+  EngineParameters parameters;
+  parameters.jump_height = 3;
+  parameters.obstacle_height = 1;
+  parameters.min_obstacle_length = 5;
+  parameters.max_obstacle_length = 5;
+  Engine engine(loc, kWidth, kHeight, 0, parameters);
+
+  REQUIRE(engine.kMaxHeight == loc.Col() - 3);
+
+  SECTION("Obstacles are generated from the parameters") {
+    engine.obstacle_.location = { -(engine.obstacle_.length), loc.Col() };
+    engine.Run();
+    REQUIRE(engine.obstacle_.length == 5);
+  }
+
+  SECTION("Low obstacles are as high as the parameters say") {
+    engine.obstacle_.type = ObstacleType::kLow;
+    engine.obstacle_.location = { loc.Row() + 1, loc.Col() };
+    engine.state_ = BallState::kJumping;
+    engine.ball_.location = { loc.Row(), loc.Col() - 2 };
+    engine.Run();
+    REQUIRE(engine.state_ != BallState::kCollided);
+  }
+}
+
+TEST_CASE("Specialized engine test", "[specialized]") {
+  Location loc = {2, 14};
+  Engine engine(loc, kWidth, kHeight, 7);
+  DefaultEngine default_engine(loc, DefaultGeometry(), 7);
+
+  REQUIRE(default_engine.kMaxHeight == engine.kMaxHeight);
+  REQUIRE(default_engine.kMinHeight == engine.kMinHeight);
+
+  SECTION("Both engines play the same game") {
+    for (int tick = 0; tick < 100; tick++) {
+      if (tick % 20 == 0) {
+        engine.state_ = BallState::kJumping;
+        default_engine.state_ = BallState::kJumping;
+      }
+      engine.Run();
+      default_engine.Run();
+      REQUIRE(engine.state_ == default_engine.state_);
+      REQUIRE(engine.ball_.location == default_engine.ball_.location);
+      REQUIRE(engine.obstacle_.location == default_engine.obstacle_.location);
+    }
+  }
+}
+
+TEST_CASE("Speed curve test", "[speed]") {
+  Location loc = {2, 14};
+  EngineParameters parameters;
+  parameters.ramp_ticks = 100;
+  parameters.max_speed = 2;
+  Engine engine(loc, kWidth, kHeight, 0, parameters);
+
+  SECTION("Obstacles start at one tile per tick") {
+    engine.Run();
+    REQUIRE(engine.obstacle_.x == (kWidth - 1) * kSubTiles);
+  }
+
+  SECTION("Obstacles speed up by a fraction of a tile") {
+    engine.obstacle_.location = { 1000, loc.Col() };
+    for (int tick = 0; tick < 50; tick++) {
+      engine.Run();
+    }
+    REQUIRE(engine.obstacle_.velocity > kSubTiles);
+    REQUIRE(engine.obstacle_.velocity < 2 * kSubTiles);
+
+    engine.Reset();
+    engine.Run();
+    REQUIRE(engine.obstacle_.velocity == kSubTiles);
+  }
+
+  SECTION("Obstacles stop speeding up at the max speed") {
+    engine.obstacle_.location = { 100000, loc.Col() };
+    for (int tick = 0; tick < 500; tick++) {
+      engine.Run();
+    }
+    REQUIRE(engine.obstacle_.velocity == 2 * kSubTiles);
+  }
+
+  SECTION("Fast obstacles leave room for a whole jump between them") {
+    engine.obstacle_.location = { 100000, loc.Col() };
+    for (int tick = 0; tick < 500; tick++) {
+      engine.Run();
+    }
+    engine.obstacle_.location = { -engine.obstacle_.length - 1, loc.Col() };
+    engine.Run();
+
+    // a jump is 11 ticks in the air, which is 22 tiles at this speed, so the
+    // next obstacle can't start at the edge of the board
+    REQUIRE(engine.obstacle_.x > kWidth * kSubTiles);
+  }
+}
+
+TEST_CASE("Fast obstacle test", "[collision]") {
+  Location loc = {2, 14};
+  EngineParameters parameters;
+  parameters.min_obstacle_length = 1;
+  parameters.max_obstacle_length = 1;
+  parameters.ramp_ticks = 1;
+  parameters.max_speed = 4;
+  Engine engine(loc, kWidth, kHeight, 0, parameters);
+  engine.obstacle_.location = { 100000, loc.Col() };
+  for (int tick = 0; tick < 10; tick++) {
+    engine.Run();
+  }
+  REQUIRE(engine.obstacle_.velocity == 4 * kSubTiles);
+
+  SECTION("An obstacle can't skip over the ball in a single tick") {
+    // the spike ends the tick a tile behind the ball, having passed it
+    engine.obstacle_.type = ObstacleType::kLow;
+    engine.obstacle_.length = 1;
+    engine.obstacle_.location = { loc.Row() + 3, loc.Col() };
+    engine.Run();
+    REQUIRE(engine.state_ == BallState::kCollided);
+    REQUIRE(engine.obstacle_.location.Row() == loc.Row() + 1);
+  }
+}
+
+TEST_CASE("World scrolling test", "[world]") {
+  Location loc = {2, 14};
+  EngineParameters parameters;
+  parameters.ramp_ticks = 100;
+  Engine engine(loc, kWidth, kHeight, 0, parameters);
+
+  SECTION("The board scrolls as far as the obstacle moves") {
+    const long long start = engine.ObstacleWorldX();
+    for (int tick = 0; tick < 5; tick++) {
+      engine.Run();
+    }
+    REQUIRE(engine.Scroll() > 5 * kSubTiles);
+    REQUIRE(engine.ObstacleWorldX() == start);
+  }
+
+  SECTION("A new obstacle is further along the world") {
+    const long long first = engine.ObstacleWorldX();
+    engine.obstacle_.location = { -engine.obstacle_.length - 1, loc.Col() };
+    engine.Run();
+    REQUIRE(engine.ObstacleWorldX() > first);
+  }
+
+  SECTION("Resetting goes back to the start of the world") {
+    engine.Run();
+    engine.Reset();
+    REQUIRE(engine.Scroll() == 0);
+    REQUIRE(engine.ObstacleWorldX() == kWidth * kSubTiles);
+  }
+}
+
+/**
+ * A source with a few obstacles, like a short level.
+ */
+class ListedObstacles : public ObstacleSource {
+ public:
+  bool Next(long long /* earliest_x */, ObstacleCursor* cursor,
+            WorldObstacle* obstacle) const override {
+    const WorldObstacle obstacles[] = {
+        { 30 * kSubTiles, ObstacleType::kHigh, 3 },
+        { 0, ObstacleType::kLow, 5 } };
+    if (cursor->index == 2) {
+      return false;
+    }
+    *obstacle = obstacles[cursor->index++];
+    return true;
+  }
+};
+
+/**
+ * Runs an engine until it takes its next obstacle.
+ * @param engine the engine.
+ */
+void RunToNextObstacle(Engine* engine) {
+  const long long obstacle_x = engine->ObstacleWorldX();
+  while (engine->ObstacleWorldX() == obstacle_x) {
+    engine->obstacle_.location = { -engine->obstacle_.length - 1,
+                                   engine->obstacle_.location.Col() };
+    engine->Run();
+  }
+}
+
+TEST_CASE("Obstacle source test", "[world]") {
+  Location loc = {2, 14};
+  Engine engine(loc, kWidth, kHeight, 0);
+  const ListedObstacles source;
+  engine.SetObstacleSource(&source);
+
+  SECTION("Obstacles are placed where the source puts them") {
+    RunToNextObstacle(&engine);
+    REQUIRE(engine.ObstacleWorldX() == 30 * kSubTiles);
+    REQUIRE(engine.obstacle_.type == ObstacleType::kHigh);
+    REQUIRE(engine.obstacle_.length == 3);
+  }
+
+  SECTION("Obstacles are never placed before the edge of the board") {
+    RunToNextObstacle(&engine);
+    RunToNextObstacle(&engine);
+    REQUIRE(engine.obstacle_.x == kWidth * kSubTiles);
+    REQUIRE(engine.obstacle_.length == 5);
+  }
+
+  SECTION("Random obstacles follow once the source runs out") {
+    Engine random(loc, kWidth, kHeight, 0);
+    RunToNextObstacle(&random);
+    for (int obstacle = 0; obstacle < 3; obstacle++) {
+      RunToNextObstacle(&engine);
+    }
+    REQUIRE(engine.obstacle_.x == kWidth * kSubTiles);
+    REQUIRE(engine.obstacle_.type == random.obstacle_.type);
+    REQUIRE(engine.obstacle_.length == random.obstacle_.length);
+  }
+
+  SECTION("Resetting starts the source again") {
+    RunToNextObstacle(&engine);
+    engine.Reset();
+    RunToNextObstacle(&engine);
+    REQUIRE(engine.ObstacleWorldX() == 30 * kSubTiles);
+  }
+}
+
+/**
+ * A source whose one obstacle is further away than an int of sub-tiles
+ * reaches, like one after a long gap in a sparse level.
+ */
+class FarObstacle : public ObstacleSource {
+ public:
+  bool Next(long long /* earliest_x */, ObstacleCursor* cursor,
+            WorldObstacle* obstacle) const override {
+    if (cursor->index++ > 0) {
+      return false;
+    }
+    *obstacle = { 1LL << 40, ObstacleType::kLow, 2 };
+    return true;
+  }
+};
+
+TEST_CASE("Obstacles far beyond the board are brought closer",
+          "[world]") {
+  Engine engine({2, 14}, kWidth, kHeight, 0);
+  const FarObstacle source;
+  engine.SetObstacleSource(&source);
+  RunToNextObstacle(&engine);
+  REQUIRE(engine.obstacle_.x > kWidth * kSubTiles);
+  REQUIRE(engine.obstacle_.x <= std::numeric_limits<int>::max() / 2);
+  REQUIRE(engine.obstacle_.location.Row() == engine.obstacle_.x / kSubTiles);
+
+  engine.Run();
+  REQUIRE(engine.obstacle_.x > kWidth * kSubTiles);
+}
+
+TEST_CASE("Precise collision test", "[collision]") {
+  Location loc = {2, 14};
+  Engine engine(loc, kWidth, kHeight, 0);
+  engine.obstacle_.type = ObstacleType::kLow;
+  engine.obstacle_.location = { loc.Row() + 2, loc.Col() };
+  engine.Run();
+
+  SECTION("A spike right under the ball collides") {
+    engine.obstacle_.x = (loc.Row() + 1) * kSubTiles;
+    engine.obstacle_.location = { loc.Row() + 1, loc.Col() };
+    engine.Run();
+    REQUIRE(engine.state_ == BallState::kCollided);
+  }
+
+  SECTION("A spike that only overlaps the ball's tile at a corner doesn't "
+          "collide") {
+    engine.obstacle_.x = (loc.Row() + 2) * kSubTiles - 1;
+    engine.obstacle_.location = { loc.Row() + 1, loc.Col() };
+    engine.Run();
+    REQUIRE(engine.state_ != BallState::kCollided);
+  }
+
+  SECTION("A ball above a spike's slope doesn't collide") {
+    // the ball's tile reaches into the spikes' top tile, but the ball
+    // itself is still clear of the slope
+    engine.obstacle_.x = (loc.Row() + 2) * kSubTiles - kSubTiles / 10;
+    engine.obstacle_.location = { loc.Row() + 1, loc.Col() };
+    engine.ball_.y = 123 * kSubTiles / 10;
+    engine.ball_.location = { loc.Row(), 13 };
+    engine.Run();
+    REQUIRE(engine.state_ != BallState::kCollided);
+  }
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/level.h>
+
+#include "temp_file.h"
+
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+using screamy_ball::kSubTiles;
+using screamy_ball::Level;
+using screamy_ball::LevelWriter;
+using screamy_ball::ObstacleCursor;
+using screamy_ball::ObstacleType;
+using screamy_ball::WorldObstacle;
+
+// removed once the tests are done
+const TempFile kLevelFile("level_test.level");
+
+/**
+ * Writes a level to the test's file.
+ * @param writer the level.
+ */
+void WriteLevel(const LevelWriter& writer) {
+  std::ofstream output(kLevelFile.Path(), std::ios::binary);
+  writer.Write(output);
+}
+
+TEST_CASE("Levels", "[level]") {
+  // chunks of 16 tiles, with an empty chunk between the second and the last
+  LevelWriter writer(16);
+  writer.Add({ 40 * kSubTiles, ObstacleType::kHigh, 3 });
+  writer.Add({ 20 * kSubTiles, ObstacleType::kLow, 2 });
+  writer.Add({ 70 * kSubTiles + 5, ObstacleType::kLow, 1 });
+  writer.Add({ 3 * kSubTiles, ObstacleType::kLow, 4 });
+  WriteLevel(writer);
+
+  SECTION("Obstacles read back in order, at their positions") {
+    const Level level(kLevelFile.Path());
+    REQUIRE(level.Size() == 4);
+    REQUIRE(level.Chunks() == 5);
+    REQUIRE(level.ChunkTiles() == 16);
+    REQUIRE(level.LongestObstacle() == 4);
+    REQUIRE(level.At(0).x == 3 * kSubTiles);
+    REQUIRE(level.At(0).length == 4);
+    REQUIRE(level.At(2).type == ObstacleType::kHigh);
+    REQUIRE(level.At(3).x == 70 * kSubTiles + 5);
+  }
+
+  SECTION("Taking obstacles moves the cursor, until the level runs out") {
+    const Level level(kLevelFile.Path());
+    ObstacleCursor cursor = { 0, std::minstd_rand(0) };
+    WorldObstacle obstacle = {};
+    for (size_t index = 0; index < level.Size(); index++) {
+      REQUIRE(level.Next(0, &cursor, &obstacle));
+      REQUIRE(obstacle.x == level.At(index).x);
+    }
+    REQUIRE(cursor.index == 4);
+    REQUIRE_FALSE(level.Next(0, &cursor, &obstacle));
+  }
+
+  SECTION("Only the chunks around the camera are streamed in") {
+    Level level(kLevelFile.Path());
+    level.Stream(0);
+    REQUIRE(level.FirstResidentChunk() == 0);
+    REQUIRE(level.EndResidentChunk() == 1 + Level::kChunksAhead);
+
+    level.Stream(50 * kSubTiles);
+    REQUIRE(level.FirstResidentChunk() == 3 - Level::kChunksBehind);
+    REQUIRE(level.EndResidentChunk() == level.Chunks());
+    // obstacles can still be read from chunks that have been let go
+    REQUIRE(level.At(0).x == 3 * kSubTiles);
+  }
+
+  SECTION("An empty level has no chunks") {
+    WriteLevel(LevelWriter(16));
+    Level level(kLevelFile.Path());
+    level.Stream(100 * kSubTiles);
+    REQUIRE(level.Size() == 0);
+    REQUIRE(level.Chunks() == 0);
+  }
+
+  SECTION("Obstacles that can't be stored are turned away") {
+    REQUIRE_THROWS_AS(writer.Add({ -1, ObstacleType::kLow, 2 }),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(writer.Add({ 0, ObstacleType::kLow, 0 }),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(writer.Add({ 0, ObstacleType::kLow, 256 }),
+                      std::invalid_argument);
+    // longer than a chunk, which it can't be tracked in
+    REQUIRE_THROWS_AS(writer.Add({ 0, ObstacleType::kLow, 17 }),
+                      std::invalid_argument);
+  }
+
+  SECTION("Files that aren't levels are rejected") {
+    {
+      std::ofstream output(kLevelFile.Path(), std::ios::binary);
+      output << "SBPACK01 is an asset pack, not a level";
+    }
+    REQUIRE_THROWS_AS(Level(kLevelFile.Path()), std::invalid_argument);
+  }
+
+  SECTION("Levels whose index is cut off are rejected") {
+    std::ifstream input(kLevelFile.Path(), std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(input)),
+                      std::istreambuf_iterator<char>());
+    input.close();
+    std::ofstream output(kLevelFile.Path(), std::ios::binary);
+    output.write(bytes.data(),
+                 static_cast<std::streamsize>(bytes.size() - 10));
+    output.close();
+    REQUIRE_THROWS_AS(Level(kLevelFile.Path()), std::invalid_argument);
+  }
+
+  SECTION("Levels with obstacles longer than their chunks are rejected") {
+    std::fstream file(kLevelFile.Path(),
+                      std::ios::binary | std::ios::in | std::ios::out);
+    // the last chunk's longest obstacle ends the file
+    file.seekp(-4, std::ios::end);
+    const char longest[4] = { 17, 0, 0, 0 };
+    file.write(longest, sizeof(longest));
+    file.close();
+    REQUIRE_THROWS_AS(Level(kLevelFile.Path()), std::invalid_argument);
+  }
+
+  SECTION("Missing levels can't be opened") {
+    REQUIRE_THROWS_AS(Level("no_such_level.level"), std::runtime_error);
+  }
+}
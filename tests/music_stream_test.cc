@@ -0,0 +1,146 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/music_stream.h>
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using screamy_ball::LoopPoints;
+using screamy_ball::MusicSource;
+using screamy_ball::MusicStreamer;
+
+/**
+ * A track whose every sample is its frame's index, with the second channel
+ * negated, so it's easy to tell where a frame came from.
+ */
+class RampSource : public MusicSource {
+ public:
+  RampSource(size_t frames, size_t channels) :
+      kFrames(frames), kChannels(channels), position_(0) {}
+
+  size_t Channels() const override {
+    return kChannels;
+  }
+
+  size_t Frames() const override {
+    return kFrames;
+  }
+
+  size_t Read(float* samples, size_t frames) override {
+    const size_t count = std::min(frames, kFrames - position_);
+    for (size_t frame = 0; frame < count; frame++) {
+      for (size_t channel = 0; channel < kChannels; channel++) {
+        const auto value = static_cast<float>(position_ + frame);
+        samples[frame * kChannels + channel] = channel == 0 ? value : -value;
+      }
+    }
+    position_ += count;
+    return count;
+  }
+
+  void Seek(size_t frame) override {
+    position_ = frame;
+  }
+
+ private:
+  const size_t kFrames;
+  const size_t kChannels;
+  size_t position_;
+};
+
+/**
+ * Creates a streamer over a ramp.
+ */
+std::unique_ptr<MusicStreamer> StreamRamp(size_t frames, size_t channels,
+                                          const LoopPoints& loop) {
+  return std::unique_ptr<MusicStreamer>(new MusicStreamer(
+      std::unique_ptr<MusicSource>(new RampSource(frames, channels)), 1000,
+      loop, 0.1f));
+}
+
+TEST_CASE("Streamed music", "[music_stream]") {
+  std::vector<float> output(20);
+
+  SECTION("The track plays once, then loops without a gap") {
+    LoopPoints loop;
+    loop.start = 4;
+    loop.end = 8;
+    const auto streamer = StreamRamp(10, 1, loop);
+    streamer->Fill();
+    streamer->Mix(output.data(), 1, 14);
+    REQUIRE(std::vector<float>(output.begin(), output.begin() + 14)
+            == std::vector<float>({ 0, 1, 2, 3, 4, 5, 6, 7,
+                                    4, 5, 6, 7, 4, 5 }));
+    REQUIRE(streamer->Underruns() == 0);
+    REQUIRE(streamer->Loops() > 0);
+  }
+
+  SECTION("The whole track loops by default") {
+    const auto streamer = StreamRamp(3, 1, LoopPoints());
+    streamer->Fill();
+    streamer->Mix(output.data(), 1, 7);
+    REQUIRE(std::vector<float>(output.begin(), output.begin() + 7)
+            == std::vector<float>({ 0, 1, 2, 0, 1, 2, 0 }));
+  }
+
+  SECTION("The end of the loop is crossfaded into its start") {
+    LoopPoints loop;
+    loop.start = 2;
+    loop.end = 8;
+    loop.crossfade = 2;
+    const auto streamer = StreamRamp(8, 1, loop);
+    streamer->Fill();
+    streamer->Mix(output.data(), 1, 12);
+
+    const float first_out = std::cos(0.25f * 1.5708f);
+    const float first_in = std::sin(0.25f * 1.5708f);
+    REQUIRE(output[5] == Approx(5));
+    REQUIRE(output[6] == Approx(6 * first_out + 2 * first_in));
+    // after the crossfade, the loop carries on from just after its start
+    REQUIRE(output[8] == Approx(4));
+    REQUIRE(output[9] == Approx(5));
+    REQUIRE(output[10] == Approx(6 * first_out + 2 * first_in));
+  }
+
+  SECTION("Channels are split, and repeated to fill the output") {
+    const auto streamer = StreamRamp(4, 2, LoopPoints());
+    streamer->Fill();
+    streamer->Mix(output.data(), 3, 2);
+    REQUIRE(std::vector<float>(output.begin(), output.begin() + 6)
+            == std::vector<float>({ 0, 1, 0, -1, 0, 1 }));
+  }
+
+  SECTION("Nothing decoded yet is silence") {
+    const auto streamer = StreamRamp(10, 1, LoopPoints());
+    output.assign(output.size(), 1);
+    streamer->Mix(output.data(), 1, 5);
+    REQUIRE(output[0] == 0);
+    REQUIRE(output[4] == 0);
+    REQUIRE(streamer->Underruns() == 5);
+  }
+
+  SECTION("The worker keeps the music playing") {
+    const auto streamer = StreamRamp(50, 1, LoopPoints());
+    streamer->Start();
+    const auto deadline = std::chrono::steady_clock::now()
+        + std::chrono::seconds(5);
+    while (streamer->Loops() < 10
+           && std::chrono::steady_clock::now() < deadline) {
+      streamer->Mix(output.data(), 1, 10);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(streamer->Loops() >= 10);
+  }
+
+  SECTION("A loop that doesn't fit in the track is rejected") {
+    LoopPoints loop;
+    loop.start = 20;
+    REQUIRE_THROWS_AS(StreamRamp(10, 1, loop), std::invalid_argument);
+  }
+}
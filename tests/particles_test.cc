@@ -0,0 +1,121 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/particles.h>
+
+#include <catch2/catch.hpp>
+#include <vector>
+
+using screamy_ball::Burst;
+using screamy_ball::ParticleSystem;
+
+const float kPi = 3.14159265f;
+
+/**
+ * Creates a burst that throws every particle the same way.
+ * @param count the number of particles.
+ * @param speed how fast they go, in tiles a second.
+ * @param angle which way they go.
+ * @return the burst, from (2, 14), lasting a second, without gravity.
+ */
+Burst StraightBurst(size_t count, float speed, float angle) {
+  return { 2, 14, count, speed, speed, angle, 0, 1, 0, 1 };
+}
+
+TEST_CASE("Particles move and die", "[particles]") {
+  ParticleSystem particles(10, 0);
+  std::vector<float> instances(
+      particles.Capacity() * ParticleSystem::kInstanceFloats);
+
+  SECTION("A burst's particles start where it is") {
+    REQUIRE(particles.Emit(StraightBurst(3, 1, 0)) == 3);
+    REQUIRE(particles.WriteInstances(instances.data()) == 3);
+    REQUIRE(std::vector<float>(instances.begin(), instances.begin() + 4)
+            == std::vector<float>({ 2, 14, 1, 1 }));
+  }
+
+  SECTION("Particles move along their angle, with y growing downwards") {
+    particles.Emit(StraightBurst(5, 2, kPi / 2));
+    particles.Update(0.5f);
+    particles.WriteInstances(instances.data());
+    // five particles cover both the SIMD lanes and the remainder
+    for (size_t particle = 0; particle < 5; particle++) {
+      const float* instance = &instances[particle * 4];
+      REQUIRE(instance[0] == Approx(2).margin(1e-5));
+      REQUIRE(instance[1] == Approx(13));
+      REQUIRE(instance[2] == Approx(0.5f));
+    }
+  }
+
+  SECTION("Gravity pulls particles down") {
+    Burst burst = StraightBurst(1, 0, 0);
+    burst.gravity = 10;
+    particles.Emit(burst);
+    particles.Update(0.1f);
+    particles.WriteInstances(instances.data());
+    REQUIRE(instances[1] > 14);
+  }
+
+  SECTION("Drag slows particles down") {
+    particles.Emit(StraightBurst(1, 1, 0));
+    particles.Update(0.25f);
+    particles.WriteInstances(instances.data());
+    const float first = instances[0] - 2;
+    particles.Update(0.25f);
+    particles.WriteInstances(instances.data());
+    REQUIRE(instances[0] - 2 - first < first);
+  }
+
+  SECTION("Particles die at the end of their lives") {
+    particles.Emit(StraightBurst(2, 1, 0));
+    Burst longer = StraightBurst(3, 1, 0);
+    longer.life_secs = 2;
+    longer.kind = 7;
+    particles.Emit(longer);
+    particles.Update(1.5f);
+    REQUIRE(particles.Size() == 3);
+    particles.WriteInstances(instances.data());
+    for (size_t particle = 0; particle < 3; particle++) {
+      REQUIRE(instances[particle * 4 + 3] == 7);
+    }
+    particles.Update(1);
+    REQUIRE(particles.Size() == 0);
+  }
+
+  SECTION("Clearing removes every particle") {
+    particles.Emit(StraightBurst(4, 1, 0));
+    particles.Clear();
+    REQUIRE(particles.Size() == 0);
+  }
+}
+
+TEST_CASE("Full particle pools thin out bursts", "[particles]") {
+  ParticleSystem particles(100, 0);
+
+  SECTION("Bursts are whole until the pool is half full") {
+    REQUIRE(particles.Emit(StraightBurst(50, 1, 0)) == 50);
+    REQUIRE(particles.Dropped() == 0);
+  }
+
+  SECTION("Past that, bursts shrink with the room that's left") {
+    particles.Emit(StraightBurst(75, 1, 0));
+    REQUIRE(particles.Size() == 75);
+    // a quarter of the pool is left, which is half of the half past the
+    // soft limit
+    REQUIRE(particles.Emit(StraightBurst(20, 1, 0)) == 10);
+    REQUIRE(particles.Dropped() == 10);
+  }
+
+  SECTION("The pool never holds more than its capacity") {
+    for (int burst = 0; burst < 100; burst++) {
+      particles.Emit(StraightBurst(30, 1, 0));
+    }
+    REQUIRE(particles.Size() <= particles.Capacity());
+    REQUIRE(particles.Size() > 90);
+  }
+
+  SECTION("Bursts without a life aren't emitted") {
+    Burst burst = StraightBurst(10, 1, 0);
+    burst.life_secs = 0;
+    REQUIRE(particles.Emit(burst) == 0);
+  }
+}
@@ -0,0 +1,15 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/player.h>
+
+#include <catch2/catch.hpp>
+
+using screamy_ball::PrettyPrintElapsedTime;
+
+TEST_CASE("Elapsed times are pretty printed", "[player]") {
+  REQUIRE(PrettyPrintElapsedTime(0) == "00:00:00");
+  REQUIRE(PrettyPrintElapsedTime(59.9) == "00:00:59");
+  REQUIRE(PrettyPrintElapsedTime(61) == "00:01:01");
+  REQUIRE(PrettyPrintElapsedTime(3 * 3600 + 25 * 60 + 7) == "03:25:07");
+  REQUIRE(PrettyPrintElapsedTime(100 * 3600) == "100:00:00");
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/profiler.h>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+
+using namespace screamy_ball;
+using std::chrono::milliseconds;
+
+TEST_CASE("Frame profiler records phases", "[profiler]") {
+  FrameProfiler profiler;
+
+  SECTION("No frames have finished before the second frame starts") {
+    REQUIRE(profiler.Frames() == 0);
+    profiler.BeginFrame();
+    profiler.AddTime(0, milliseconds(1));
+    REQUIRE(profiler.Frames() == 0);
+    REQUIRE(profiler.Percentile(0, 0.5) == 0);
+  }
+
+  SECTION("A phase's times add up within a frame") {
+    profiler.BeginFrame();
+    profiler.AddTime(1, milliseconds(2));
+    profiler.AddTime(1, milliseconds(3));
+    profiler.BeginFrame();
+
+    REQUIRE(profiler.Frames() == 1);
+    REQUIRE(profiler.Secs(1, 0) == Approx(0.005));
+    REQUIRE(profiler.Secs(0, 0) == 0);
+    REQUIRE(profiler.Secs(FrameProfiler::kFrame, 0) >= 0);
+  }
+
+  SECTION("Scoped timers add their time to their phase") {
+    profiler.BeginFrame();
+    {
+      ScopedTimer timer(&profiler, 2);
+    }
+    profiler.BeginFrame();
+    REQUIRE(profiler.Secs(2, 0) >= 0);
+    REQUIRE(profiler.Secs(2, 0) <= profiler.Secs(FrameProfiler::kFrame, 0));
+  }
+}
+
+TEST_CASE("Frame profiler calculates percentiles", "[profiler]") {
+  FrameProfiler profiler;
+
+  // frame n takes n milliseconds in phase 0
+  profiler.BeginFrame();
+  for (int frame = 1; frame <= 100; frame++) {
+    profiler.AddTime(0, milliseconds(frame));
+    profiler.BeginFrame();
+  }
+
+  REQUIRE(profiler.Frames() == 100);
+  REQUIRE(profiler.Secs(0, 0) == Approx(0.1));
+  REQUIRE(profiler.Percentile(0, 0.5) == Approx(0.05));
+  REQUIRE(profiler.Percentile(0, 0.99) == Approx(0.099));
+  REQUIRE(profiler.Percentile(0, 1) == Approx(0.1));
+
+  SECTION("Old frames are overwritten") {
+    for (size_t frame = 0; frame < FrameProfiler::kFrames; frame++) {
+      profiler.AddTime(0, milliseconds(1));
+      profiler.BeginFrame();
+    }
+    REQUIRE(profiler.Frames() == FrameProfiler::kFrames - 1);
+    REQUIRE(profiler.Percentile(0, 1) == Approx(0.001));
+  }
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/quality.h>
+
+#include <catch2/catch.hpp>
+#include <stdexcept>
+
+using screamy_ball::QualityController;
+
+const double kTarget = 1.0 / 60;
+
+/**
+ * Adds a window of frames that all take the same time.
+ * @param quality the controller.
+ * @param frame_secs how long each frame takes.
+ * @param work_secs how long each frame's work takes.
+ * @return whether the level changed at the end of the window.
+ */
+bool AddWindow(QualityController* quality, double frame_secs,
+               double work_secs) {
+  bool changed = false;
+  for (size_t frame = 0; frame < QualityController::kWindowFrames; frame++) {
+    changed = quality->AddFrame(frame_secs, work_secs);
+  }
+  return changed;
+}
+
+TEST_CASE("Quality levels follow the frame time", "[quality]") {
+  QualityController quality(4, kTarget);
+
+  SECTION("Missing the target steps the level down after a window") {
+    for (size_t frame = 1; frame < QualityController::kWindowFrames;
+         frame++) {
+      REQUIRE_FALSE(quality.AddFrame(kTarget * 2, kTarget * 2));
+    }
+    REQUIRE(quality.AddFrame(kTarget * 2, kTarget * 2));
+    REQUIRE(quality.Level() == 1);
+    REQUIRE(quality.FrameSecs() == Approx(kTarget * 2));
+  }
+
+  SECTION("A few slow frames don't change the level") {
+    for (size_t frame = 0; frame < QualityController::kWindowFrames;
+         frame++) {
+      quality.AddFrame(frame % 20 == 0 ? kTarget * 3 : kTarget, kTarget / 2);
+    }
+    REQUIRE(quality.Level() == 0);
+  }
+
+  SECTION("The level never goes past the cheapest one") {
+    for (int window = 0; window < 10; window++) {
+      AddWindow(&quality, kTarget * 3, kTarget * 3);
+    }
+    REQUIRE(quality.Level() == 3);
+  }
+
+  SECTION("Headroom steps the level back up, but only once it lasts") {
+    AddWindow(&quality, kTarget * 2, kTarget * 2);
+    REQUIRE_FALSE(AddWindow(&quality, kTarget, kTarget / 4));
+    REQUIRE(AddWindow(&quality, kTarget, kTarget / 4));
+    REQUIRE(quality.Level() == 0);
+  }
+
+  SECTION("Vsynced frames without headroom keep the level") {
+    AddWindow(&quality, kTarget * 2, kTarget * 2);
+    for (int window = 0; window < 10; window++) {
+      REQUIRE_FALSE(AddWindow(&quality, kTarget, kTarget * 0.8));
+    }
+    REQUIRE(quality.Level() == 1);
+  }
+
+  SECTION("A level that fails right after stepping up is held off longer") {
+    AddWindow(&quality, kTarget * 2, kTarget * 2);
+    AddWindow(&quality, kTarget, kTarget / 4);
+    AddWindow(&quality, kTarget, kTarget / 4);
+    REQUIRE(quality.Level() == 0);
+    REQUIRE(AddWindow(&quality, kTarget * 2, kTarget * 2));
+
+    // it now takes four windows of headroom instead of two
+    for (int window = 0; window < 3; window++) {
+      REQUIRE_FALSE(AddWindow(&quality, kTarget, kTarget / 4));
+    }
+    REQUIRE(AddWindow(&quality, kTarget, kTarget / 4));
+    REQUIRE(quality.Level() == 0);
+  }
+
+  SECTION("A held off level is tried sooner once the frames settle") {
+    AddWindow(&quality, kTarget * 2, kTarget * 2);
+    AddWindow(&quality, kTarget, kTarget / 4);
+    AddWindow(&quality, kTarget, kTarget / 4);
+    REQUIRE(AddWindow(&quality, kTarget * 2, kTarget * 2));
+
+    // without headroom, but without missing either, for long enough that
+    // the wait goes back to two windows
+    for (size_t window = 0; window < QualityController::kSettleWindows;
+         window++) {
+      REQUIRE_FALSE(AddWindow(&quality, kTarget, kTarget * 0.8));
+    }
+    REQUIRE_FALSE(AddWindow(&quality, kTarget, kTarget / 4));
+    REQUIRE(AddWindow(&quality, kTarget, kTarget / 4));
+    REQUIRE(quality.Level() == 0);
+  }
+
+  SECTION("Discarded frames aren't judged") {
+    for (size_t frame = 1; frame < QualityController::kWindowFrames;
+         frame++) {
+      quality.AddFrame(kTarget * 2, kTarget * 2);
+    }
+    quality.Discard();
+    REQUIRE_FALSE(quality.AddFrame(kTarget, kTarget));
+    REQUIRE_FALSE(AddWindow(&quality, kTarget, kTarget));
+    REQUIRE(quality.Level() == 0);
+  }
+
+  SECTION("A set level is clamped to the cheapest one") {
+    quality.SetLevel(10);
+    REQUIRE(quality.Level() == 3);
+  }
+}
+
+TEST_CASE("Quality controllers need levels and a target", "[quality]") {
+  REQUIRE_THROWS_AS(QualityController(0, kTarget), std::invalid_argument);
+  REQUIRE_THROWS_AS(QualityController(3, 0), std::invalid_argument);
+}
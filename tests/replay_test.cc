@@ -0,0 +1,41 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/replay.h>
+
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <stdexcept>
+
+using namespace screamy_ball;
+
+TEST_CASE("Replays are parsed", "[replay]") {
+  SECTION("Events are ordered by frame") {
+    std::istringstream input("# a comment\n"
+                             "\n"
+                             "120 help   # trailing comment\n"
+                             "0 start\n"
+                             "120 menu\n");
+    const auto events = ParseReplay(input);
+
+    REQUIRE(events.size() == 3);
+    REQUIRE(events[0].frame == 0);
+    REQUIRE(events[0].action == "start");
+    REQUIRE(events[1].frame == 120);
+    REQUIRE(events[1].action == "help");
+    REQUIRE(events[2].action == "menu");
+  }
+
+  SECTION("Malformed lines are rejected") {
+    std::istringstream missing_action("10\n");
+    REQUIRE_THROWS_AS(ParseReplay(missing_action), std::invalid_argument);
+
+    std::istringstream negative_frame("-1 jump\n");
+    REQUIRE_THROWS_AS(ParseReplay(negative_frame), std::invalid_argument);
+
+    std::istringstream extra_field("1 jump now\n");
+    REQUIRE_THROWS_AS(ParseReplay(extra_field), std::invalid_argument);
+
+    std::istringstream huge_frame("99999999999999999999999 jump\n");
+    REQUIRE_THROWS_AS(ParseReplay(huge_frame), std::invalid_argument);
+  }
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/resampler.h>
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using screamy_ball::StreamResampler;
+
+/**
+ * Makes a second of a sine wave, at full volume.
+ */
+std::vector<float> SineWave(float frequency, unsigned rate) {
+  std::vector<float> samples(rate);
+  for (size_t index = 0; index < samples.size(); index++) {
+    samples[index] = static_cast<float>(std::sin(
+        2.0 * 3.14159265358979323846 * frequency * index / rate));
+  }
+  return samples;
+}
+
+/**
+ * Gets the root mean square of the samples, skipping the first tenth, where
+ * the filter is still filling up.
+ */
+float RootMeanSquare(const std::vector<float>& samples) {
+  double sum = 0.0;
+  const size_t start = samples.size() / 10;
+  for (size_t index = start; index < samples.size(); index++) {
+    sum += samples[index] * samples[index];
+  }
+  return static_cast<float>(std::sqrt(sum / (samples.size() - start)));
+}
+
+/**
+ * Resamples audio a chunk at a time.
+ */
+std::vector<float> ResampleInChunks(StreamResampler* resampler,
+                                    const std::vector<float>& samples,
+                                    size_t chunk) {
+  std::vector<float> resampled;
+  std::vector<float> output(resampler->MaxOutput());
+  for (size_t start = 0; start < samples.size(); start += chunk) {
+    const size_t count = std::min(chunk, samples.size() - start);
+    const size_t written = resampler->Process(samples.data() + start, count,
+                                              output.data());
+    REQUIRE(written <= output.size());
+    resampled.insert(resampled.end(), output.begin(),
+                     output.begin() + static_cast<std::ptrdiff_t>(written));
+  }
+  return resampled;
+}
+
+TEST_CASE("Streamed resampling", "[resampler]") {
+  StreamResampler resampler(48000, 16000, 1536);
+
+  SECTION("Speech frequencies go through unchanged") {
+    const std::vector<float> resampled = ResampleInChunks(
+        &resampler, SineWave(1000.0f, 48000), 1536);
+    REQUIRE(resampled.size() == Approx(16000).margin(2));
+    REQUIRE(RootMeanSquare(resampled)
+            == Approx(std::sqrt(0.5f)).epsilon(0.05));
+  }
+
+  SECTION("What's too high for the new rate is filtered out") {
+    const std::vector<float> resampled = ResampleInChunks(
+        &resampler, SineWave(12000.0f, 48000), 1536);
+    REQUIRE(RootMeanSquare(resampled) < 0.02f);
+  }
+
+  SECTION("Chunks of any size give the same audio") {
+    const std::vector<float> tone = SineWave(440.0f, 48000);
+    const std::vector<float> whole = ResampleInChunks(&resampler, tone, 1536);
+    StreamResampler chunked(48000, 16000, 1536);
+    const std::vector<float> pieces = ResampleInChunks(&chunked, tone, 77);
+    REQUIRE(pieces.size() == whole.size());
+    for (size_t index = 0; index < whole.size(); index++) {
+      REQUIRE(pieces[index] == Approx(whole[index]).margin(1e-5));
+    }
+  }
+
+  SECTION("Resetting starts a new stream") {
+    const std::vector<float> tone = SineWave(440.0f, 48000);
+    const std::vector<float> first = ResampleInChunks(&resampler, tone, 1000);
+    resampler.Reset();
+    REQUIRE(ResampleInChunks(&resampler, tone, 1000) == first);
+  }
+
+  SECTION("A chunk bigger than the maximum is refused") {
+    std::vector<float> samples(1537);
+    std::vector<float> output(resampler.MaxOutput());
+    REQUIRE_THROWS_AS(resampler.Process(samples.data(), samples.size(),
+                                        output.data()),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("Streamed resampling up in rate", "[resampler]") {
+  StreamResampler resampler(8000, 16000, 256);
+  const std::vector<float> resampled = ResampleInChunks(
+      &resampler, SineWave(1000.0f, 8000), 256);
+  REQUIRE(resampled.size() == Approx(16000).margin(2));
+  REQUIRE(RootMeanSquare(resampled)
+          == Approx(std::sqrt(0.5f)).epsilon(0.05));
+}
+
+TEST_CASE("Audio can't be streamed from a rate of 0", "[resampler]") {
+  REQUIRE_THROWS_AS(StreamResampler(0, 16000, 256), std::invalid_argument);
+  REQUIRE_THROWS_AS(StreamResampler(16000, 0, 256), std::invalid_argument);
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/sample_player.h>
+
+#include <catch2/catch.hpp>
+#include <vector>
+
+using screamy_ball::SamplePlayer;
+
+TEST_CASE("Sample player mixes its voices", "[sample_player]") {
+  // a mono clip of 4 frames
+  SamplePlayer player({ 1, 2, 3, 4 }, 1, 2);
+  std::vector<float> output(2 * 2, -1);
+
+  SECTION("Nothing plays until it's triggered") {
+    player.Mix(output.data(), 2, 2);
+    REQUIRE(output == std::vector<float>({ 0, 0, 0, 0 }));
+    REQUIRE(player.ActiveVoices() == 0);
+  }
+
+  SECTION("A triggered clip plays to the end on every channel") {
+    player.Trigger();
+    player.Mix(output.data(), 2, 2);
+    REQUIRE(output == std::vector<float>({ 1, 2, 1, 2 }));
+    player.Mix(output.data(), 2, 2);
+    REQUIRE(output == std::vector<float>({ 3, 4, 3, 4 }));
+    REQUIRE(player.ActiveVoices() == 0);
+    player.Mix(output.data(), 2, 2);
+    REQUIRE(output == std::vector<float>({ 0, 0, 0, 0 }));
+  }
+
+  SECTION("Overlapping triggers play on separate voices") {
+    player.Trigger();
+    player.Mix(output.data(), 1, 2);
+    player.Trigger();
+    player.Mix(output.data(), 1, 2);
+    // the first voice plays 3, 4 while the second plays 1, 2
+    REQUIRE(output[0] == 4);
+    REQUIRE(output[1] == 6);
+    REQUIRE(player.ActiveVoices() == 1);
+  }
+
+  SECTION("The oldest voice is stolen when every voice is busy") {
+    player.Trigger();
+    player.Mix(output.data(), 1, 1);
+    player.Trigger();
+    player.Mix(output.data(), 1, 1);
+    player.Trigger();
+    player.Mix(output.data(), 1, 1);
+    // the first voice restarted, and the second is on its second frame
+    REQUIRE(output[0] == 1 + 2);
+    REQUIRE(player.ActiveVoices() == 2);
+  }
+
+  SECTION("Latency is measured from the trigger to the mix") {
+    player.Trigger();
+    player.Mix(output.data(), 1, 2);
+    REQUIRE(player.Triggers() == 1);
+    REQUIRE(player.MeanLatencySecs() >= 0);
+    REQUIRE(player.MaxLatencySecs() >= player.MeanLatencySecs());
+  }
+}
@@ -0,0 +1,188 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/shared_env.h>
+
+#include "temp_file.h"
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using screamy_ball::Action;
+using screamy_ball::Autoplayer;
+using screamy_ball::BallState;
+using screamy_ball::Engine;
+using screamy_ball::EnvObservation;
+using screamy_ball::kEpisodeCollided;
+using screamy_ball::kEpisodeTruncated;
+using screamy_ball::kResetAction;
+using screamy_ball::SharedEnvClient;
+using screamy_ball::SharedEnvServer;
+
+// removed once the tests are done
+const TempFile kEnvFile("shared_env_test.env");
+
+TEST_CASE("Shared environments are stepped in batches", "[shared_env]") {
+  SharedEnvServer server(kEnvFile.Path(), 5, 4, 16, 16, 7, 100000);
+  SharedEnvClient client(kEnvFile.Path());
+  REQUIRE(client.Envs() == 5);
+  REQUIRE(client.Ring() == 4);
+
+  SECTION("Each environment plays its own seeded game") {
+    // the environments are stepped on this thread, one batch at a time
+    Engine engine({2, 14}, 16, 16, 9);
+    for (int tick = 0; tick < 20; tick++) {
+      const Action action = tick % 7 == 0 ? Action::kJump : Action::kRoll;
+      client.SetAction(2, action);
+      client.Submit();
+      REQUIRE(server.ServeBatch(0));
+      REQUIRE(client.Wait(0));
+
+      Autoplayer::Apply(&engine, action);
+      engine.Run();
+      if (engine.state_ == BallState::kCollided) {
+        engine.Reset();
+      }
+      const EnvObservation& observation = client.Observations()[2];
+      REQUIRE(observation.batch == client.Batch());
+      REQUIRE(observation.ball_y == engine.ball_.y);
+      REQUIRE(observation.obstacle_x == engine.obstacle_.x);
+      REQUIRE(observation.ball_state == static_cast<uint8_t>(engine.state_));
+    }
+  }
+
+  SECTION("Collisions end the episode, and restart the environment") {
+    bool collided = false;
+    for (int tick = 0; tick < 100 && !collided; tick++) {
+      client.Submit();
+      server.ServeBatch(0);
+      client.Wait(0);
+      const EnvObservation& observation = client.Observations()[0];
+      if (observation.done != 0) {
+        collided = true;
+        REQUIRE(observation.done == kEpisodeCollided);
+        REQUIRE(observation.reward == Approx(0));
+        REQUIRE(observation.episode_ticks == 0);
+        REQUIRE(client.Observations(1)[0].episode_ticks > 0);
+      } else {
+        REQUIRE(observation.reward == Approx(1));
+      }
+    }
+    REQUIRE(collided);
+  }
+
+  SECTION("Resetting restarts every episode, and goes back to rolling") {
+    client.Submit();
+    server.ServeBatch(0);
+    client.Wait(0);
+    client.SetAllActions(kResetAction);
+    client.Submit();
+    server.ServeBatch(0);
+    REQUIRE(client.Wait(0));
+    for (size_t env = 0; env < client.Envs(); env++) {
+      REQUIRE(client.Observations()[env].episode_ticks == 0);
+    }
+  }
+
+  SECTION("Batches are served from another thread") {
+    std::atomic<bool> stop(false);
+    std::thread serving([&server, &stop]() { server.Serve(stop); });
+    REQUIRE(client.ResetAll());
+    REQUIRE(client.Actions()[4] == static_cast<uint8_t>(Action::kRoll));
+    for (int batch = 0; batch < 1000; batch++) {
+      REQUIRE(client.Step());
+    }
+    stop = true;
+    serving.join();
+    REQUIRE(server.Batches() == 1001);
+    REQUIRE(client.Observations()[3].batch == 1001);
+  }
+
+  SECTION("Waiting gives up once it times out") {
+    client.Submit();
+    REQUIRE_FALSE(client.Wait(1));
+  }
+}
+
+TEST_CASE("Episodes are truncated once they reach the tick limit",
+          "[shared_env]") {
+  // the first obstacle starts a board away, so the ball can't collide in
+  // the few ticks before the limit
+  SharedEnvServer server(kEnvFile.Path(), 2, 2, 16, 16, 0, 5);
+  SharedEnvClient client(kEnvFile.Path());
+  Engine engine({2, 14}, 16, 16, 1);
+  for (uint32_t tick = 1; tick < 5; tick++) {
+    client.Submit();
+    REQUIRE(server.ServeBatch(0));
+    REQUIRE(client.Wait(0));
+    REQUIRE(client.Observations()[1].done == 0);
+    REQUIRE(client.Observations()[1].episode_ticks == tick);
+  }
+
+  client.Submit();
+  REQUIRE(server.ServeBatch(0));
+  REQUIRE(client.Wait(0));
+  const EnvObservation& observation = client.Observations()[1];
+  REQUIRE(observation.done == kEpisodeTruncated);
+  REQUIRE(observation.reward == Approx(1));
+  REQUIRE(observation.episode_ticks == 0);
+  for (int tick = 0; tick < 5; tick++) {
+    engine.Run();
+  }
+  engine.Reset();
+  REQUIRE(observation.ball_y == engine.ball_.y);
+  REQUIRE(observation.obstacle_x == engine.obstacle_.x);
+}
+
+TEST_CASE("Clients notice when the server has gone", "[shared_env]") {
+  auto server = std::make_unique<SharedEnvServer>(kEnvFile.Path(), 1, 1, 16,
+                                                  16, 0, 100000);
+  SharedEnvClient client(kEnvFile.Path());
+  std::thread closing([&server]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    server.reset();
+  });
+  REQUIRE_FALSE(client.Step());
+  closing.join();
+}
+
+TEST_CASE("Files that aren't shared environments are rejected",
+          "[shared_env]") {
+  {
+    std::ofstream output(kEnvFile.Path(), std::ios::binary);
+    output << std::string(1024, 'x');
+  }
+  REQUIRE_THROWS_AS(SharedEnvClient(kEnvFile.Path()), std::invalid_argument);
+  REQUIRE_THROWS_AS(SharedEnvClient("no_such_file.env"), std::runtime_error);
+  REQUIRE_THROWS_AS(SharedEnvServer(kEnvFile.Path(), 0, 1, 16, 16, 0, 1),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(SharedEnvServer(kEnvFile.Path(), 1, 1, 16, 16, 0, 0),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Boards too small to play on are rejected", "[shared_env]") {
+  REQUIRE_THROWS_AS(SharedEnvServer(kEnvFile.Path(), 1, 1, 16, 2, 0, 1),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(SharedEnvServer(kEnvFile.Path(), 1, 1, 16, 6, 0, 1),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(SharedEnvServer(kEnvFile.Path(), 1, 1, 3, 16, 0, 1),
+                    std::invalid_argument);
+  SharedEnvServer server(kEnvFile.Path(), 1, 1, 4, 7, 0, 1);
+  REQUIRE(server.Envs() == 1);
+}
+
+TEST_CASE("The ring of observations has a power of two batches",
+          "[shared_env]") {
+  // otherwise the batch counter wrapping round would jump to another slot
+  REQUIRE_THROWS_AS(SharedEnvServer(kEnvFile.Path(), 1, 0, 16, 16, 0, 1),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(SharedEnvServer(kEnvFile.Path(), 1, 3, 16, 16, 0, 1),
+                    std::invalid_argument);
+  SharedEnvServer server(kEnvFile.Path(), 1, 8, 16, 16, 0, 1);
+  REQUIRE(SharedEnvClient(kEnvFile.Path()).Ring() == 8);
+}
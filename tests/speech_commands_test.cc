@@ -0,0 +1,108 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/speech_commands.h>
+#include <screamy-ball/wav.h>
+
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <vector>
+
+using screamy_ball::CommandGrammar;
+using screamy_ball::CommandTrigger;
+using screamy_ball::CorpusEntry;
+using screamy_ball::KeywordList;
+using screamy_ball::ParseEarlyCommand;
+using screamy_ball::ParseCorpus;
+using screamy_ball::ParseSpeechCommand;
+using screamy_ball::Resample;
+using screamy_ball::SpeechCommand;
+using screamy_ball::UtteranceEndSecs;
+
+TEST_CASE("Spoken commands", "[speech_commands]") {
+  SECTION("Phrases are commands") {
+    REQUIRE(ParseSpeechCommand("HIGHER") == SpeechCommand::kJump);
+    REQUIRE(ParseSpeechCommand("LOWER") == SpeechCommand::kDuck);
+    REQUIRE(ParseSpeechCommand("PAUSE GAME") == SpeechCommand::kPause);
+    REQUIRE(ParseSpeechCommand("RESET") == SpeechCommand::kReset);
+    REQUIRE(ParseSpeechCommand("MUTE SOUNDS") == SpeechCommand::kMute);
+    REQUIRE(ParseSpeechCommand("MENU") == SpeechCommand::kMenu);
+    REQUIRE(ParseSpeechCommand("INSTRUCTIONS") == SpeechCommand::kHelp);
+  }
+
+  SECTION("Words that are recognized randomly aren't commands") {
+    REQUIRE(ParseSpeechCommand("PAUSE") == SpeechCommand::kNone);
+    REQUIRE(ParseSpeechCommand("MUTE") == SpeechCommand::kNone);
+    REQUIRE(ParseSpeechCommand("") == SpeechCommand::kNone);
+  }
+}
+
+TEST_CASE("Recognizer modes", "[speech_commands]") {
+  SECTION("The grammar accepts every phrase") {
+    const std::string grammar = CommandGrammar();
+    REQUIRE(grammar.find("#JSGF V1.0;") == 0);
+    REQUIRE(grammar.find("public <command> = HIGHER | LOWER | PAUSE GAME")
+            != std::string::npos);
+    REQUIRE(grammar.find("INSTRUCTIONS;") != std::string::npos);
+  }
+
+  SECTION("Every phrase is a keyword with its own threshold") {
+    const std::string keywords = KeywordList();
+    REQUIRE(keywords.find("HIGHER /1e-15/\n") == 0);
+    REQUIRE(keywords.find("INSTRUCTIONS /1e-30/\n") != std::string::npos);
+  }
+
+  SECTION("Only certain partial hypotheses trigger early") {
+    REQUIRE(ParseEarlyCommand("HIGHER") == SpeechCommand::kJump);
+    // "RESET GAME" resets too
+    REQUIRE(ParseEarlyCommand("RESET") == SpeechCommand::kReset);
+    REQUIRE(ParseEarlyCommand("MAIN") == SpeechCommand::kNone);
+    REQUIRE(ParseEarlyCommand("PAUSE") == SpeechCommand::kNone);
+  }
+
+  SECTION("An utterance triggers its command once") {
+    CommandTrigger trigger;
+    REQUIRE(trigger.OnPartial("HIGH") == SpeechCommand::kNone);
+    REQUIRE(trigger.OnPartial("HIGHER") == SpeechCommand::kJump);
+    REQUIRE(trigger.OnPartial("HIGHER") == SpeechCommand::kNone);
+    REQUIRE(trigger.OnFinal("HIGHER") == SpeechCommand::kNone);
+    // the next utterance is only recognized at its end
+    REQUIRE(trigger.OnPartial("MAIN") == SpeechCommand::kNone);
+    REQUIRE(trigger.OnFinal("MAIN MENU") == SpeechCommand::kMenu);
+  }
+}
+
+TEST_CASE("Speech corpora", "[speech_commands]") {
+  SECTION("Each line is a recording and its words") {
+    std::istringstream input("# a corpus\n"
+                             "higher/1.wav higher\n"
+                             "\n"
+                             "menu/2.wav Main Menu  # the whole phrase\n"
+                             "noise/3.wav\n");
+    const std::vector<CorpusEntry> entries = ParseCorpus(input);
+    REQUIRE(entries.size() == 3);
+    REQUIRE(entries[0].wav_path == "higher/1.wav");
+    REQUIRE(entries[0].transcript == "HIGHER");
+    REQUIRE(entries[1].transcript == "MAIN MENU");
+    REQUIRE(entries[2].transcript.empty());
+  }
+
+  SECTION("An utterance ends after its last loud block") {
+    std::vector<float> samples(16000, 0);
+    for (size_t index = 4000; index < 8000; index++) {
+      samples[index] = index % 2 == 0 ? 0.5f : -0.5f;
+    }
+    REQUIRE(UtteranceEndSecs(samples, 16000) == Approx(0.5));
+  }
+
+  SECTION("Silence has no utterance") {
+    REQUIRE(UtteranceEndSecs(std::vector<float>(16000, 0), 16000) == 0);
+  }
+
+  SECTION("Recordings are resampled for the recognizer") {
+    const std::vector<float> samples = { 0, 1, 2, 3, 4, 5 };
+    REQUIRE(Resample(samples, 48000, 16000)
+            == std::vector<float>({ 0, 3 }));
+    REQUIRE(Resample(samples, 16000, 32000).size() == 12);
+    REQUIRE(Resample(samples, 16000, 32000)[1] == Approx(0.5f));
+  }
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/speech_gate.h>
+
+#include <catch2/catch.hpp>
+#include <vector>
+
+using screamy_ball::AudioRing;
+using screamy_ball::SpeechGate;
+
+TEST_CASE("Audio ring buffer", "[speech_gate]") {
+  AudioRing ring(6);
+  std::vector<float> samples(8);
+
+  SECTION("Samples are read in the order they were written") {
+    REQUIRE(ring.Write(std::vector<float>({ 1, 2, 3 }).data(), 3));
+    REQUIRE(ring.Read(samples.data(), 2) == 2);
+    REQUIRE(ring.Write(std::vector<float>({ 4, 5, 6, 7 }).data(), 4));
+    REQUIRE(ring.Available() == 5);
+    REQUIRE(ring.Read(samples.data(), 8) == 5);
+    REQUIRE(std::vector<float>(samples.begin(), samples.begin() + 5)
+            == std::vector<float>({ 3, 4, 5, 6, 7 }));
+  }
+
+  SECTION("A block that doesn't fit is dropped whole") {
+    // the capacity is rounded up to 8
+    REQUIRE(ring.Write(samples.data(), 5));
+    REQUIRE_FALSE(ring.Write(samples.data(), 4));
+    REQUIRE(ring.Dropped() == 4);
+    REQUIRE(ring.Available() == 5);
+    REQUIRE(ring.Space() == 3);
+  }
+}
+
+TEST_CASE("Speech gate", "[speech_gate]") {
+  // 10ms blocks at 1kHz, with a 20ms pre-roll and a 30ms hangover
+  screamy_ball::GateParameters parameters;
+  parameters.preroll_secs = 0.02f;
+  parameters.hangover_secs = 0.03f;
+  SpeechGate gate(1000, 10, parameters);
+  const std::vector<float> silence(10, 0);
+  const std::vector<float> speech(10, 0.5f);
+
+  SECTION("Silence is never let through") {
+    for (int block = 0; block < 100; block++) {
+      REQUIRE(gate.Process(silence.data(), silence.size()) == 0);
+    }
+    REQUIRE_FALSE(gate.IsOpen());
+  }
+
+  SECTION("Speech opens the gate with the audio before it") {
+    std::vector<float> before(10, 0.001f);
+    gate.Process(silence.data(), silence.size());
+    gate.Process(before.data(), before.size());
+    REQUIRE(gate.Process(speech.data(), speech.size()) == 30);
+    REQUIRE(gate.Output()[0] == 0);
+    REQUIRE(gate.Output()[10] == 0.001f);
+    REQUIRE(gate.Output()[29] == 0.5f);
+    REQUIRE(gate.Process(speech.data(), speech.size()) == 10);
+  }
+
+  SECTION("The gate closes after the hangover") {
+    gate.Process(speech.data(), speech.size());
+    REQUIRE(gate.Process(silence.data(), silence.size()) == 10);
+    REQUIRE(gate.Process(silence.data(), silence.size()) == 10);
+    REQUIRE(gate.Process(silence.data(), silence.size()) == 0);
+    REQUIRE_FALSE(gate.IsOpen());
+  }
+
+  SECTION("A steady background becomes the noise floor") {
+    const std::vector<float> hum(10, 0.05f);
+    size_t passed = 0;
+    for (int block = 0; block < 1000; block++) {
+      passed = gate.Process(hum.data(), hum.size());
+    }
+    REQUIRE(passed == 0);
+  }
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/task_graph.h>
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using screamy_ball::TaskGraph;
+
+TEST_CASE("Task graph", "[task_graph]") {
+  TaskGraph graph(4);
+
+  SECTION("Tasks run after their dependencies") {
+    std::atomic<int> loaded(0);
+    int seen = -1;
+    const auto first = graph.Add("first", [&]() { loaded++; });
+    const auto second = graph.Add("second", [&]() { loaded++; });
+    const auto both = graph.Add("both", [&]() { seen = loaded; },
+                                { first, second });
+    graph.Start();
+    graph.Wait();
+    REQUIRE(seen == 2);
+    REQUIRE(graph.IsDone(both));
+    REQUIRE(graph.IsFinished());
+    REQUIRE(graph.Pending().empty());
+  }
+
+  SECTION("Main-thread tasks only run on the main thread") {
+    const std::thread::id main_thread = std::this_thread::get_id();
+    std::thread::id ran_on;
+    const auto load = graph.Add("load", []() {});
+    const auto show = graph.AddOnMainThread("show", [&]() {
+      ran_on = std::this_thread::get_id(); }, { load });
+    graph.Start();
+    while (!graph.IsDone(load)) {
+      std::this_thread::yield();
+    }
+    REQUIRE_FALSE(graph.IsDone(show));
+    REQUIRE(graph.Pending() == "show");
+    REQUIRE(graph.RunMainThreadTasks() == 1);
+    REQUIRE(ran_on == main_thread);
+    REQUIRE(graph.IsFinished());
+  }
+
+  SECTION("A failed task skips the tasks that depend on it") {
+    bool ran = false;
+    const auto load = graph.Add("load", []() {
+      throw std::runtime_error("missing file"); });
+    const auto use = graph.Add("use", [&]() { ran = true; }, { load });
+    const auto show = graph.AddOnMainThread("show", [&]() { ran = true; },
+                                            { use });
+    const auto other = graph.Add("other", []() {});
+    graph.Start();
+    graph.Wait();
+    REQUIRE_FALSE(ran);
+    REQUIRE(graph.HasFailed(load));
+    REQUIRE(graph.HasFailed(show));
+    REQUIRE(graph.IsDone(other));
+
+    const std::vector<TaskGraph::Timing> timings = graph.Timings();
+    REQUIRE(timings[load].error == "missing file");
+    REQUIRE(timings[show].error == "skipped, since use failed");
+  }
+
+  SECTION("Tasks can only depend on earlier tasks") {
+    REQUIRE_THROWS_AS(graph.Add("task", []() {}, { 0 }),
+                      std::invalid_argument);
+  }
+}
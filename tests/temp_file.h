@@ -0,0 +1,43 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#ifndef FINALPROJECT_TESTS_TEMP_FILE_H_
+#define FINALPROJECT_TESTS_TEMP_FILE_H_
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/**
+ * A file in the system's temporary directory, for a test to write to, which
+ * is removed once the test is done with it, so that running the tests
+ * doesn't leave files behind wherever they were run from.
+ */
+class TempFile {
+ public:
+  explicit TempFile(const std::string& name) : path_(Directory() + name) {}
+  ~TempFile() {
+    std::remove(path_.c_str());
+  }
+  TempFile(const TempFile&) = delete;
+  TempFile& operator=(const TempFile&) = delete;
+
+  const char* Path() const {
+    return path_.c_str();
+  }
+
+ private:
+  static std::string Directory() {
+#if defined(_WIN32)
+    const char* directory = std::getenv("TEMP");
+    return directory != nullptr ? std::string(directory) + "\\" : "";
+#else
+    const char* directory = std::getenv("TMPDIR");
+    return directory != nullptr && *directory != '\0'
+        ? std::string(directory) + "/" : "/tmp/";
+#endif
+  }
+
+  std::string path_;
+};
+
+#endif  // FINALPROJECT_TESTS_TEMP_FILE_H_
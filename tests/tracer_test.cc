@@ -0,0 +1,85 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/tracer.h>
+
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace screamy_ball;
+
+/**
+ * Counts how many times a pattern appears in some text.
+ */
+size_t CountOccurrences(const std::string& text, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + pattern.size())) {
+    count++;
+  }
+  return count;
+}
+
+/**
+ * Reads a whole file into a string.
+ */
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+TEST_CASE("Tracer writes a Chrome trace", "[tracer]") {
+  const std::string path = "tracer_test.json";
+  Tracer& tracer = Tracer::Get();
+
+  SECTION("Nothing is recorded while tracing is off") {
+    REQUIRE_FALSE(tracer.IsEnabled());
+    TraceScope scope("ignored", "test");
+    TraceInstant("ignored", "test");
+  }
+
+  SECTION("Events from every thread are written") {
+    REQUIRE(tracer.Start(path));
+    REQUIRE(tracer.IsEnabled());
+    tracer.NameThread("main");
+
+    for (int event = 0; event < 100; event++) {
+      TraceScope scope("tick", "engine");
+    }
+    std::thread other([]() {
+      Tracer::Get().NameThread("other");
+      for (int event = 0; event < 100; event++) {
+        TraceInstant("scream", "audio");
+      }
+    });
+    other.join();
+    tracer.Stop();
+    REQUIRE_FALSE(tracer.IsEnabled());
+
+    const std::string trace = ReadFile(path);
+    REQUIRE(trace.find("{\"traceEvents\":[") == 0);
+    REQUIRE(trace.find("]}") == trace.size() - 3);
+    REQUIRE(CountOccurrences(trace, "\"name\":\"tick\"") == 100);
+    REQUIRE(CountOccurrences(trace, "\"name\":\"scream\"") == 100);
+    REQUIRE(CountOccurrences(trace, "\"ph\":\"M\"") == 2);
+    REQUIRE(CountOccurrences(trace, "\"dur\":") == 100);
+    REQUIRE(tracer.Dropped() == 0);
+  }
+
+  SECTION("Events past a full buffer are dropped") {
+    REQUIRE(tracer.Start(path));
+    // flushing happens in the background, so a burst can outrun it
+    for (int event = 0; event < 100000; event++) {
+      TraceInstant("burst", "test");
+    }
+    tracer.Stop();
+
+    const std::string trace = ReadFile(path);
+    REQUIRE(CountOccurrences(trace, "\"name\":\"burst\"")
+            + tracer.Dropped() == 100000);
+  }
+}
@@ -0,0 +1,173 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/voice_control.h>
+#include <screamy-ball/wav.h>
+
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using screamy_ball::MixToMono;
+using screamy_ball::ReadWav;
+using screamy_ball::Resample;
+using screamy_ball::Rms;
+using screamy_ball::VoiceAnalyzer;
+using screamy_ball::VoiceCommand;
+using screamy_ball::VoiceEvent;
+using screamy_ball::WavData;
+using screamy_ball::WriteWav;
+
+namespace {
+
+const unsigned kSampleRate = 16000;
+// 10ms blocks
+const size_t kBlock = 160;
+const float kPi = 3.14159265f;
+
+/**
+ * Generates a sine wave.
+ */
+std::vector<float> Tone(float hz, float amplitude, float secs) {
+  std::vector<float> samples(static_cast<size_t>(secs * kSampleRate));
+  for (size_t index = 0; index < samples.size(); index++) {
+    samples[index] = amplitude * std::sin(
+        2 * kPi * hz * static_cast<float>(index) / kSampleRate);
+  }
+  return samples;
+}
+
+/**
+ * Feeds samples to the analyzer in blocks, and keeps every command.
+ */
+std::vector<VoiceEvent> Feed(VoiceAnalyzer* analyzer,
+                             const std::vector<float>& samples) {
+  std::vector<VoiceEvent> events;
+  for (size_t start = 0; start + kBlock <= samples.size(); start += kBlock) {
+    const VoiceEvent event = analyzer->Process(&samples[start], kBlock);
+    if (event.command != VoiceCommand::kNone) {
+      events.push_back(event);
+    }
+  }
+  return events;
+}
+
+}  // namespace
+
+TEST_CASE("RMS levels", "[voice_control]") {
+  SECTION("The vectorized RMS matches the definition") {
+    std::vector<float> samples;
+    double squares = 0;
+    for (int index = 0; index < 103; index++) {
+      samples.push_back(static_cast<float>(index % 7) - 3);
+      squares += samples.back() * samples.back();
+    }
+    REQUIRE(Rms(samples.data(), samples.size())
+            == Approx(std::sqrt(squares / samples.size())));
+  }
+
+  SECTION("No samples have no level") {
+    REQUIRE(Rms(nullptr, 0) == 0);
+  }
+}
+
+TEST_CASE("Voice commands", "[voice_control]") {
+  VoiceAnalyzer analyzer(kSampleRate);
+
+  SECTION("Silence doesn't do anything") {
+    REQUIRE(Feed(&analyzer, std::vector<float>(kSampleRate, 0)).empty());
+    REQUIRE(analyzer.PitchHz() == 0);
+  }
+
+  SECTION("A sudden loud sound jumps, louder sounds jumping higher") {
+    std::vector<float> samples(kSampleRate / 2, 0);
+    const std::vector<float> quiet_scream = Tone(900, 0.1f, 0.05f);
+    const std::vector<float> loud_scream = Tone(900, 0.9f, 0.05f);
+    samples.insert(samples.end(), quiet_scream.begin(), quiet_scream.end());
+    samples.insert(samples.end(), kSampleRate / 2, 0);
+    samples.insert(samples.end(), loud_scream.begin(), loud_scream.end());
+
+    const std::vector<VoiceEvent> events = Feed(&analyzer, samples);
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].command == VoiceCommand::kJump);
+    REQUIRE(events[1].command == VoiceCommand::kJump);
+    REQUIRE(events[0].strength >= 50);
+    REQUIRE(events[0].strength < events[1].strength);
+    REQUIRE(events[1].strength <= 100);
+  }
+
+  SECTION("A held scream only jumps once") {
+    std::vector<float> samples(kSampleRate / 2, 0);
+    const std::vector<float> scream = Tone(900, 0.5f, 1);
+    samples.insert(samples.end(), scream.begin(), scream.end());
+    REQUIRE(Feed(&analyzer, samples).size() == 1);
+  }
+
+  SECTION("A low hum ducks until it stops") {
+    std::vector<float> samples = Tone(120, 0.02f, 0.5f);
+    samples.insert(samples.end(), kSampleRate / 4, 0);
+
+    const std::vector<VoiceEvent> events = Feed(&analyzer, samples);
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].command == VoiceCommand::kDuck);
+    REQUIRE(events[1].command == VoiceCommand::kRelease);
+    REQUIRE_FALSE(analyzer.IsDucking());
+  }
+
+  SECTION("The hum's pitch is detected") {
+    Feed(&analyzer, Tone(120, 0.02f, 0.2f));
+    REQUIRE(analyzer.PitchHz() == Approx(120).epsilon(0.02));
+    REQUIRE(analyzer.IsDucking());
+  }
+
+  SECTION("A high whistle doesn't duck") {
+    REQUIRE(Feed(&analyzer, Tone(1000, 0.02f, 0.5f)).empty());
+    REQUIRE(analyzer.PitchHz() == 0);
+  }
+}
+
+TEST_CASE("WAV files", "[voice_control]") {
+  const WavData wav = { kSampleRate, 2, { 0.5f, -0.5f, 0.25f, 0 } };
+
+  SECTION("A written file reads back") {
+    std::stringstream file;
+    WriteWav(file, wav);
+    const WavData read = ReadWav(file);
+    REQUIRE(read.sample_rate == kSampleRate);
+    REQUIRE(read.channels == 2);
+    REQUIRE(read.samples.size() == 4);
+    REQUIRE(read.samples[0] == Approx(0.5f).margin(1e-4));
+    REQUIRE(read.samples[1] == Approx(-0.5f).margin(1e-4));
+  }
+
+  SECTION("Channels are mixed down to mono") {
+    REQUIRE(MixToMono(wav) == std::vector<float>({ 0, 0.125f }));
+  }
+
+  SECTION("Audio can't be resampled from a rate of 0") {
+    REQUIRE_THROWS_AS(Resample(wav.samples, 0, kSampleRate),
+                      std::invalid_argument);
+  }
+
+  SECTION("Anything that isn't a WAV file is rejected") {
+    std::stringstream file("not a wav file");
+    REQUIRE_THROWS_AS(ReadWav(file), std::invalid_argument);
+  }
+
+  SECTION("A file without a sample rate is rejected") {
+    std::stringstream file;
+    WriteWav(file, { 0, 2, wav.samples });
+    REQUIRE_THROWS_AS(ReadWav(file), std::invalid_argument);
+  }
+
+  SECTION("A format too short to hold the sample rate is rejected") {
+    std::stringstream written;
+    WriteWav(written, wav);
+    std::string bytes = written.str();
+    // the format's size follows "RIFF", the file's size and "WAVEfmt "
+    bytes[16] = 12;
+    std::stringstream file(bytes);
+    REQUIRE_THROWS_AS(ReadWav(file), std::invalid_argument);
+  }
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/world.h>
+
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <vector>
+
+using screamy_ball::Camera;
+using screamy_ball::kSubTiles;
+using screamy_ball::ObstacleChunks;
+using screamy_ball::ObstacleType;
+using screamy_ball::WorldObstacle;
+
+/**
+ * Creates a low obstacle whose first spike ends at a tile.
+ * @param tile the tile its first spike ends at.
+ * @param length the number of spikes.
+ * @return the obstacle.
+ */
+WorldObstacle LowObstacle(long long tile, int length = 2) {
+  return { tile * kSubTiles, ObstacleType::kLow, length };
+}
+
+/**
+ * Lists the tiles of the obstacles that overlap part of the world.
+ * @param chunks the chunks.
+ * @param left the part's left edge, in tiles.
+ * @param right the part's right edge, in tiles.
+ * @return the tile each obstacle's first spike ends at.
+ */
+std::vector<long long> TilesIn(const ObstacleChunks& chunks, long long left,
+                               long long right) {
+  std::vector<long long> tiles;
+  chunks.ForEachIn(left * kSubTiles, right * kSubTiles,
+                   [&tiles](const WorldObstacle& obstacle) {
+                     tiles.push_back(obstacle.x / kSubTiles); });
+  return tiles;
+}
+
+TEST_CASE("Obstacles are bucketed into chunks", "[world]") {
+  // four chunks of 16 tiles, with room for three obstacles each
+  ObstacleChunks chunks(16, 4, 3);
+
+  SECTION("Only the obstacles in view are visited, in order") {
+    REQUIRE(chunks.Add(LowObstacle(40)));
+    REQUIRE(chunks.Add(LowObstacle(5)));
+    REQUIRE(chunks.Add(LowObstacle(20)));
+    REQUIRE(chunks.Add(LowObstacle(10)));
+    REQUIRE(TilesIn(chunks, 0, 16) == std::vector<long long>({ 5, 10 }));
+    REQUIRE(TilesIn(chunks, 8, 41) == std::vector<long long>({ 10, 20, 40 }));
+    REQUIRE(chunks.Size() == 4);
+  }
+
+  SECTION("An obstacle that starts in an earlier chunk is still visited") {
+    REQUIRE(chunks.Add(LowObstacle(15, 4)));
+    REQUIRE(chunks.ChunkOf(15 * kSubTiles) == 0);
+    REQUIRE(TilesIn(chunks, 17, 20) == std::vector<long long>({ 15 }));
+    REQUIRE(TilesIn(chunks, 18, 20).empty());
+  }
+
+  SECTION("Released chunks are reused for the chunks ahead") {
+    chunks.Add(LowObstacle(5));
+    chunks.Add(LowObstacle(20));
+    REQUIRE_FALSE(chunks.Add(LowObstacle(70)));
+
+    chunks.Release(1);
+    REQUIRE(chunks.Size() == 1);
+    REQUIRE(TilesIn(chunks, 0, 80) == std::vector<long long>({ 20 }));
+    REQUIRE(chunks.Add(LowObstacle(70)));
+    REQUIRE(TilesIn(chunks, 0, 80) == std::vector<long long>({ 20, 70 }));
+    REQUIRE_FALSE(chunks.Add(LowObstacle(5)));
+  }
+
+  SECTION("Full chunks and obstacles wider than a chunk are turned away") {
+    for (int tile = 1; tile <= 3; tile++) {
+      REQUIRE(chunks.Add(LowObstacle(tile)));
+    }
+    REQUIRE_FALSE(chunks.Add(LowObstacle(4)));
+    REQUIRE_FALSE(chunks.Add(LowObstacle(20, 18)));
+  }
+
+  SECTION("Positions before the world's start are in negative chunks") {
+    REQUIRE(chunks.ChunkOf(-1) == -1);
+    REQUIRE(chunks.ChunkOf(-16 * kSubTiles) == -1);
+    REQUIRE(chunks.ChunkOf(-16 * kSubTiles - 1) == -2);
+  }
+
+  SECTION("Clearing moves back to the start of the world") {
+    chunks.Add(LowObstacle(5));
+    chunks.Release(3);
+    chunks.Clear();
+    REQUIRE(chunks.Size() == 0);
+    REQUIRE(chunks.FirstChunk() == 0);
+    REQUIRE(chunks.Add(LowObstacle(5)));
+  }
+
+  SECTION("Chunks need a width and room") {
+    REQUIRE_THROWS_AS(ObstacleChunks(0, 4, 3), std::invalid_argument);
+    REQUIRE_THROWS_AS(ObstacleChunks(16, 0, 3), std::invalid_argument);
+  }
+}
+
+TEST_CASE("The camera looks onto part of the world", "[world]") {
+  Camera camera(16, 16);
+  camera.MoveTo(100);
+
+  SECTION("World positions are moved into the view") {
+    REQUIRE(camera.ToScreen(104) == Approx(4));
+    REQUIRE(camera.Right() == Approx(116));
+  }
+
+  SECTION("Only spans in the view are visible") {
+    REQUIRE(camera.IsVisible(99, 101));
+    REQUIRE(camera.IsVisible(115, 120));
+    REQUIRE_FALSE(camera.IsVisible(90, 100));
+    REQUIRE_FALSE(camera.IsVisible(116, 120));
+  }
+
+  SECTION("Distant layers scroll more slowly") {
+    REQUIRE(camera.ToScreen(60, 0.5f) == Approx(10));
+    REQUIRE(camera.IsVisible(50, 51, 0.5f));
+    REQUIRE_FALSE(camera.IsVisible(100, 101, 0.5f));
+  }
+
+  SECTION("The first visible thing in a layer is found without a search") {
+    REQUIRE(camera.FirstVisible(3, 1) == 33);
+    REQUIRE(camera.FirstVisible(8, 0.25f) == 3);
+  }
+}
@@ -0,0 +1,393 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/autoplayer.h>
+#include <screamy-ball/engine.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using screamy_ball::Action;
+using screamy_ball::Autoplayer;
+using screamy_ball::BallState;
+using screamy_ball::Engine;
+using screamy_ball::EngineParameters;
+using screamy_ball::Location;
+using screamy_ball::ObstacleType;
+using std::string;
+using std::vector;
+
+DEFINE_uint32(width, 16, "the number of tiles in each row");
+DEFINE_uint32(height, 16, "the number of tiles in each column");
+DEFINE_string(jump_heights, "4,5,6", "the jump heights to sweep over");
+DEFINE_string(obstacle_heights, "1,2,3", "the spike heights to sweep over");
+DEFINE_string(min_lengths, "2", "the minimum obstacle lengths to sweep over");
+DEFINE_string(max_lengths, "3,4,5",
+              "the maximum obstacle lengths to sweep over");
+DEFINE_string(delays, "0.1,0.05", "the tick delays (in seconds) to sweep over");
+DEFINE_uint32(games, 1000, "the number of seeded games per cell and player");
+DEFINE_uint32(max_ticks, 3000, "the tick at which a game is stopped");
+DEFINE_uint32(curve_step, 100, "the number of ticks between points on the "
+                               "survival curves");
+DEFINE_uint32(lookahead, 12, "the number of ticks the autoplayer searches");
+DEFINE_double(reaction_secs, 0.25, "the reaction time of the scripted player");
+DEFINE_uint32(threads, 0, "the number of threads, or 0 to use every core");
+DEFINE_string(summary_csv, "summary.csv", "where to write the summary");
+DEFINE_string(curve_csv, "survival.csv", "where to write the survival curves");
+
+namespace screamyball_analyzer {
+
+enum class PlayerType { kScripted, kBot };
+const PlayerType kPlayerTypes[] = { PlayerType::kScripted, PlayerType::kBot };
+const size_t kNumPlayerTypes = 2;
+
+/**
+ * A single point on the parameter grid.
+ */
+struct Cell {
+  EngineParameters parameters;
+  double delay_secs;
+};
+
+/**
+ * The results of every game played in a cell by one type of player.
+ */
+struct Results {
+  size_t games = 0;
+  size_t total_ticks = 0;
+  size_t deaths = 0;
+  size_t obstacles = 0;
+  // deaths_per_step[i] is the number of games that ended in the i-th step
+  vector<size_t> deaths_per_step;
+};
+
+/**
+ * A player that reacts to what it saw `reaction_ticks` ago: it jumps when a
+ * low obstacle looks close enough to clear, and ducks when a high obstacle is
+ * overhead. It knows how slow it is, so it aims early, but it still lets go
+ * of duck late. This stands in for a practiced human with a fixed reaction
+ * time.
+ */
+class ScriptedPlayer {
+ public:
+  ScriptedPlayer(size_t reaction_ticks, const EngineParameters& parameters) :
+      kJumpLead(parameters.jump_height + 1
+                + static_cast<int>(reaction_ticks)),
+      seen_(reaction_ticks + 1, Sight()),
+      next_(0) {}
+
+  Action Decide(const Engine& engine) {
+    seen_[next_] = { engine.obstacle_.type,
+                     engine.obstacle_.location.Row()
+                     - engine.ball_.location.Row(),
+                     engine.obstacle_.length };
+    next_ = (next_ + 1) % seen_.size();
+    // the oldest sight is the one the player is reacting to now
+    const Sight& sight = seen_[next_];
+
+    const bool is_near = sight.distance <= kJumpLead
+        && sight.distance > -sight.length;
+    if (!is_near) {
+      return Action::kRoll;
+    }
+    return sight.type == ObstacleType::kLow ? Action::kJump : Action::kDuck;
+  }
+
+ private:
+  struct Sight {
+    ObstacleType type = ObstacleType::kLow;
+    int distance = 0;
+    int length = 0;
+  };
+
+  const int kJumpLead;
+  vector<Sight> seen_;
+  size_t next_;
+};
+
+/**
+ * Parses a comma-separated list of numbers.
+ * @param list the list to parse.
+ * @return the numbers in the list.
+ */
+template <typename T>
+vector<T> ParseList(const string& list) {
+  vector<T> values;
+  std::stringstream stream(list);
+  string value;
+  while (std::getline(stream, value, ',')) {
+    std::stringstream value_stream(value);
+    T parsed;
+    value_stream >> parsed;
+    values.push_back(parsed);
+  }
+  return values;
+}
+
+/**
+ * Builds the grid of parameters to sweep over, skipping any cell whose
+ * obstacle lengths don't form a range.
+ * @return the cells of the grid.
+ */
+vector<Cell> BuildGrid() {
+  vector<Cell> grid;
+  for (int jump_height : ParseList<int>(FLAGS_jump_heights)) {
+    for (int obstacle_height : ParseList<int>(FLAGS_obstacle_heights)) {
+      for (int min_length : ParseList<int>(FLAGS_min_lengths)) {
+        for (int max_length : ParseList<int>(FLAGS_max_lengths)) {
+          if (min_length > max_length) {
+            continue;
+          }
+          for (double delay_secs : ParseList<double>(FLAGS_delays)) {
+            Cell cell;
+            cell.parameters.jump_height = jump_height;
+            cell.parameters.obstacle_height = obstacle_height;
+            cell.parameters.min_obstacle_length = min_length;
+            cell.parameters.max_obstacle_length = max_length;
+            cell.delay_secs = delay_secs;
+            grid.push_back(cell);
+          }
+        }
+      }
+    }
+  }
+  return grid;
+}
+
+/**
+ * Plays a single seeded game and adds its outcome to `results`.
+ * @param cell the parameters of the game.
+ * @param type the type of player.
+ * @param seed the seed of the game's obstacles.
+ * @param results where to record the outcome.
+ */
+void PlayGame(const Cell& cell, PlayerType type, unsigned seed,
+              Results* results) {
+  const int width = static_cast<int>(FLAGS_width);
+  Engine engine({2, static_cast<int>(FLAGS_height - 2)}, width,
+                static_cast<int>(FLAGS_height), seed, cell.parameters);
+  Autoplayer autoplayer(FLAGS_lookahead);
+  const size_t reaction_ticks = static_cast<size_t>(
+      std::ceil(FLAGS_reaction_secs / cell.delay_secs));
+  ScriptedPlayer scripted(reaction_ticks, cell.parameters);
+  // the Engine starts with an obstacle already on its way
+  results->obstacles++;
+
+  size_t tick = 0;
+  bool has_collided = false;
+  long long obstacle_x = engine.ObstacleWorldX();
+  for (; tick < FLAGS_max_ticks; tick++) {
+    const Action action = type == PlayerType::kBot
+        ? autoplayer.Decide(engine)
+        : scripted.Decide(engine);
+    Autoplayer::Apply(&engine, action);
+
+    engine.Run();
+    if (engine.state_ == BallState::kCollided) {
+      has_collided = true;
+      break;
+    }
+    // an obstacle stays in the same place in the world until it's replaced
+    if (engine.ObstacleWorldX() != obstacle_x) {
+      obstacle_x = engine.ObstacleWorldX();
+      results->obstacles++;
+    }
+  }
+
+  results->games++;
+  results->total_ticks += tick;
+  if (has_collided) {
+    results->deaths++;
+    results->deaths_per_step[tick / FLAGS_curve_step]++;
+  }
+}
+
+/**
+ * Plays every game on the grid, spreading the games evenly over the threads.
+ * @param grid the cells to play games in.
+ * @return the results of each cell and player type, merged over threads.
+ */
+vector<Results> PlayGrid(const vector<Cell>& grid) {
+  const size_t steps = FLAGS_max_ticks / FLAGS_curve_step + 1;
+  const size_t num_results = grid.size() * kNumPlayerTypes;
+  const size_t num_games = num_results * FLAGS_games;
+
+  size_t num_threads = FLAGS_threads;
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  Results empty;
+  empty.deaths_per_step.assign(steps, 0);
+  vector<vector<Results>> thread_results(num_threads,
+                                         vector<Results>(num_results, empty));
+
+  // games are handed out one at a time, so fast and slow cells mix evenly
+  std::atomic<size_t> next_game(0);
+  vector<std::thread> threads;
+  for (size_t index = 0; index < num_threads; index++) {
+    threads.emplace_back([&, index]() {
+      for (size_t game = next_game++; game < num_games; game = next_game++) {
+        const size_t result = game / FLAGS_games;
+        const unsigned seed = static_cast<unsigned>(game % FLAGS_games);
+        PlayGame(grid[result / kNumPlayerTypes],
+                 kPlayerTypes[result % kNumPlayerTypes], seed,
+                 &thread_results[index][result]);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  vector<Results> merged(num_results, empty);
+  for (const vector<Results>& results : thread_results) {
+    for (size_t result = 0; result < num_results; result++) {
+      merged[result].games += results[result].games;
+      merged[result].total_ticks += results[result].total_ticks;
+      merged[result].deaths += results[result].deaths;
+      merged[result].obstacles += results[result].obstacles;
+      for (size_t step = 0; step < steps; step++) {
+        merged[result].deaths_per_step[step] +=
+            results[result].deaths_per_step[step];
+      }
+    }
+  }
+  return merged;
+}
+
+/**
+ * Divides two counts.
+ * @return the fraction `count / total`.
+ */
+double Fraction(size_t count, size_t total) {
+  return static_cast<double>(count) / static_cast<double>(total);
+}
+
+/**
+ * Calculates how long games lasted on average, in seconds.
+ * @param cell the cell the games were played in.
+ * @param results the results of the games.
+ * @return the mean survival time.
+ */
+double MeanSecs(const Cell& cell, const Results& results) {
+  return cell.delay_secs * Fraction(results.total_ticks, results.games);
+}
+
+/**
+ * Writes a cell's parameters as the first columns of a CSV row.
+ * @param os the stream to write to.
+ * @param cell the cell to write.
+ */
+void WriteCell(std::ostream& os, const Cell& cell) {
+  os << cell.parameters.jump_height << ','
+     << cell.parameters.obstacle_height << ','
+     << cell.parameters.min_obstacle_length << ','
+     << cell.parameters.max_obstacle_length << ',' << cell.delay_secs << ',';
+}
+
+/**
+ * Writes one row per cell: the mean survival of both players, and the
+ * fraction of obstacles that even the bot couldn't get past. The bot only
+ * searches `lookahead` ticks ahead, and assumes it's safe past that, so a
+ * death means its search fell short, not that the sequence was impossible.
+ * @param grid the cells that were played.
+ * @param results the results of each cell and player type.
+ */
+void WriteSummary(const vector<Cell>& grid, const vector<Results>& results) {
+  std::ofstream os(FLAGS_summary_csv);
+  os << "jump_height,obstacle_height,min_length,max_length,delay_secs,"
+        "scripted_mean_secs,bot_mean_secs,bot_failure_fraction\n";
+
+  for (size_t cell = 0; cell < grid.size(); cell++) {
+    const Results& scripted = results[cell * kNumPlayerTypes];
+    const Results& bot = results[cell * kNumPlayerTypes + 1];
+
+    WriteCell(os, grid[cell]);
+    os << MeanSecs(grid[cell], scripted) << ',' << MeanSecs(grid[cell], bot)
+       << ',' << Fraction(bot.deaths, bot.obstacles)
+       << '\n';
+  }
+}
+
+/**
+ * Writes the survival curves: the fraction of games still going at every
+ * `curve_step` ticks, for each cell and player type.
+ * @param grid the cells that were played.
+ * @param results the results of each cell and player type.
+ */
+void WriteCurves(const vector<Cell>& grid, const vector<Results>& results) {
+  std::ofstream os(FLAGS_curve_csv);
+  os << "jump_height,obstacle_height,min_length,max_length,delay_secs,"
+        "player,tick,secs,alive_fraction\n";
+
+  for (size_t result = 0; result < results.size(); result++) {
+    const Cell& cell = grid[result / kNumPlayerTypes];
+    const bool is_bot = kPlayerTypes[result % kNumPlayerTypes]
+        == PlayerType::kBot;
+
+    size_t alive = results[result].games;
+    for (size_t step = 0; step < results[result].deaths_per_step.size();
+         step++) {
+      const size_t tick = step * FLAGS_curve_step;
+      WriteCell(os, cell);
+      os << (is_bot ? "bot" : "scripted") << ',' << tick << ','
+         << cell.delay_secs * static_cast<double>(tick) << ','
+         << Fraction(alive, results[result].games) << '\n';
+      alive -= results[result].deaths_per_step[step];
+    }
+  }
+}
+
+}  // namespace screamyball_analyzer
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Sweeps a grid of Screamy Ball's parameters, and measures how hard "
+      "each point on the grid is.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if (FLAGS_games == 0 || FLAGS_curve_step == 0) {
+    std::cerr << "--games and --curve_step must be positive" << std::endl;
+    return 1;
+  }
+  for (int jump_height :
+       screamyball_analyzer::ParseList<int>(FLAGS_jump_heights)) {
+    if (jump_height <= 0) {
+      std::cerr << "--jump_heights must all be positive" << std::endl;
+      return 1;
+    }
+  }
+  // the scripted player's reaction is counted in ticks of each delay
+  for (double delay_secs :
+       screamyball_analyzer::ParseList<double>(FLAGS_delays)) {
+    if (!(delay_secs > 0)) {
+      std::cerr << "--delays must all be positive" << std::endl;
+      return 1;
+    }
+  }
+  if (!(FLAGS_reaction_secs >= 0)) {
+    std::cerr << "--reaction_secs can't be negative" << std::endl;
+    return 1;
+  }
+
+  const vector<screamyball_analyzer::Cell> grid =
+      screamyball_analyzer::BuildGrid();
+  const vector<screamyball_analyzer::Results> results =
+      screamyball_analyzer::PlayGrid(grid);
+
+  screamyball_analyzer::WriteSummary(grid, results);
+  screamyball_analyzer::WriteCurves(grid, results);
+
+  std::cout << "played " << grid.size() * screamyball_analyzer::kNumPlayerTypes
+               * FLAGS_games << " games over " << grid.size() << " cells"
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/asset_pack.h>
+#include <screamy-ball/wav.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using screamy_ball::AssetPack;
+using screamy_ball::AssetPackWriter;
+using screamy_ball::PackedAsset;
+using screamy_ball::WavData;
+
+DEFINE_string(inputs, "", "a comma-separated list of the files to pack, each "
+                          "as path or name=path. WAV files are decoded and "
+                          "stored as float samples");
+DEFINE_string(output, "screamy_ball.pack", "the pack to write");
+DEFINE_uint32(pcm_rate, 0, "the sample rate decoded audio is stored at, so it "
+                           "doesn't have to be resampled when the game "
+                           "starts; 0 keeps each file's own rate");
+
+namespace screamyball_asset_packer {
+
+/**
+ * Gets the file name at the end of a path.
+ * @param path the path.
+ * @return the file name.
+ */
+std::string FileName(const std::string& path) {
+  const size_t slash = path.find_last_of("/\\");
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/**
+ * Checks whether a path ends with the given extension.
+ */
+bool HasExtension(const std::string& path, const std::string& extension) {
+  return path.size() >= extension.size()
+      && path.compare(path.size() - extension.size(), extension.size(),
+                      extension) == 0;
+}
+
+/**
+ * Adds a WAV file to the pack as float samples, one channel after another.
+ * @param writer the pack.
+ * @param name the asset's name.
+ * @param input the WAV file.
+ * @throws std::invalid_argument if the file isn't a supported WAV file.
+ */
+void AddWav(AssetPackWriter* writer, const std::string& name,
+            std::istream& input) {
+  const WavData wav = screamy_ball::ReadWav(input);
+  const unsigned channels = std::max(1u, wav.channels);
+  std::vector<float> samples = screamy_ball::Deinterleave(wav);
+  unsigned sample_rate = wav.sample_rate;
+
+  if (FLAGS_pcm_rate != 0) {
+    samples = screamy_ball::ResamplePlanar(samples, channels, sample_rate,
+                                           FLAGS_pcm_rate);
+    sample_rate = FLAGS_pcm_rate;
+  }
+  writer->AddPcm(name, samples, sample_rate, channels);
+}
+
+/**
+ * Adds one of the inputs to the pack.
+ * @param writer the pack.
+ * @param input the input, as path or name=path.
+ * @return whether it could be read.
+ */
+bool AddInput(AssetPackWriter* writer, const std::string& input) {
+  const size_t equals = input.find('=');
+  const std::string path = equals == std::string::npos
+      ? input : input.substr(equals + 1);
+  const std::string name = equals == std::string::npos
+      ? FileName(path) : input.substr(0, equals);
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    std::cerr << "Couldn't open " << path << std::endl;
+    return false;
+  }
+  if (HasExtension(path, ".wav")) {
+    try {
+      AddWav(writer, name, file);
+    } catch (const std::invalid_argument& error) {
+      std::cerr << path << ": " << error.what() << std::endl;
+      return false;
+    }
+  } else {
+    writer->AddFile(name, std::string(std::istreambuf_iterator<char>(file),
+                                      std::istreambuf_iterator<char>()));
+  }
+  return true;
+}
+
+}  // namespace screamyball_asset_packer
+
+int main(int argc, char** argv) {
+  using namespace screamyball_asset_packer;
+
+  gflags::SetUsageMessage(
+      "Packs the game's assets into one file, which the game maps into "
+      "memory instead of reading every asset on its own.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  AssetPackWriter writer;
+  std::stringstream inputs(FLAGS_inputs);
+  std::string input;
+  while (std::getline(inputs, input, ',')) {
+    if (!input.empty() && !AddInput(&writer, input)) {
+      return 1;
+    }
+  }
+
+  {
+    std::ofstream output(FLAGS_output, std::ios::binary);
+    writer.Write(output);
+    if (!output) {
+      std::cerr << "Couldn't write " << FLAGS_output << std::endl;
+      return 1;
+    }
+  }
+
+  // the pack is read back, so a broken pack fails the build instead of the
+  // game
+  try {
+    const AssetPack pack(FLAGS_output);
+    for (const std::string& name : pack.Names()) {
+      const PackedAsset* asset = pack.Find(name);
+      std::cout << name << ": " << asset->size << " bytes";
+      if (asset->is_pcm) {
+        std::cout << ", " << asset->channels << " channels at "
+                  << asset->sample_rate << "Hz";
+      }
+      std::cout << std::endl;
+    }
+    std::cout << FLAGS_output << ": " << pack.Size() << " bytes" << std::endl;
+  } catch (const std::exception& error) {
+    std::cerr << FLAGS_output << ": " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Runs the end-to-end frame-time benchmark on a machine without a GPU, using
+# Mesa's llvmpipe software renderer under a virtual X server.
+#
+# Usage: tools/benchmark.sh <path to cinder-screamy-ball> [results.json]
+set -e
+
+if [ -z "$1" ]; then
+  echo "Usage: $0 <path to cinder-screamy-ball> [results.json]" >&2
+  exit 1
+fi
+
+APP="$1"
+RESULTS="${2:-benchmark.json}"
+REPLAY="$(cd "$(dirname "$0")/../assets" && pwd)/benchmark_replay.txt"
+
+export LIBGL_ALWAYS_SOFTWARE=1
+export GALLIUM_DRIVER=llvmpipe
+
+# the app plays music, so give it a sound card that goes nowhere if there's
+# a PulseAudio server to use
+if command -v pulseaudio > /dev/null; then
+  pulseaudio --start --exit-idle-time=-1 > /dev/null 2>&1 || true
+  pactl load-module module-null-sink > /dev/null 2>&1 || true
+fi
+
+xvfb-run --auto-servernum --server-args="-screen 0 1024x1024x24" \
+    "$APP" --replay="$REPLAY" --benchmark_json="$RESULTS" --autoplay
+
+cat "$RESULTS"
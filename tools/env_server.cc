@@ -0,0 +1,120 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/shared_env.h>
+#include <gflags/gflags.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+
+using screamy_ball::Action;
+using screamy_ball::EnvObservation;
+using screamy_ball::SharedEnvClient;
+using screamy_ball::SharedEnvServer;
+
+DEFINE_string(path, "/dev/shm/screamy_ball_env",
+              "the shared file the environments are served through");
+DEFINE_uint32(envs, 256, "the number of environments stepped in a batch");
+DEFINE_uint32(ring, 4, "the number of batches of observations kept, which "
+              "must be a power of two");
+DEFINE_uint32(width, 16, "the number of tiles in each row");
+DEFINE_uint32(height, 16, "the number of tiles in each column");
+DEFINE_uint32(seed, 0, "the first environment's seed");
+DEFINE_uint32(max_episode_ticks, 100000,
+              "the most ticks an episode lasts before it's truncated and "
+              "restarted");
+DEFINE_uint32(benchmark_batches, 0,
+              "instead of serving until interrupted, step this many batches "
+              "from a client thread, and report the step rate");
+
+namespace screamyball_env_server {
+
+std::atomic<bool> stop(false);
+
+/**
+ * Stops serving on an interrupt, so the shared file is removed.
+ */
+void Stop(int) {
+  stop = true;
+}
+
+/**
+ * Steps the environments from a client in this process, through the shared
+ * file, the same way another process would, and prints how fast it went.
+ * The client plays randomly, jumping or ducking now and then.
+ * @param server the server, which is served from another thread meanwhile.
+ */
+void Benchmark(SharedEnvServer* server) {
+  std::thread serving([server]() { server->Serve(stop); });
+  SharedEnvClient client(FLAGS_path);
+  std::minstd_rand rng(FLAGS_seed);
+  std::uniform_int_distribution<int> rand_action(0, 15);
+
+  client.ResetAll();
+  size_t episodes = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (uint32_t batch = 0; batch < FLAGS_benchmark_batches; batch++) {
+    const EnvObservation* observations = client.Observations();
+    uint8_t* actions = client.Actions();
+    for (size_t env = 0; env < client.Envs(); env++) {
+      episodes += observations[env].done != 0 ? 1 : 0;
+      const int action = rand_action(rng);
+      actions[env] = static_cast<uint8_t>(action < 3 ? action : 0);
+    }
+    client.Step();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  stop = true;
+  serving.join();
+
+  const double steps = static_cast<double>(FLAGS_benchmark_batches)
+      * FLAGS_envs;
+  std::cout << "envs: " << FLAGS_envs << "\n"
+            << "batches: " << FLAGS_benchmark_batches << "\n"
+            << "seconds: " << elapsed.count() << "\n"
+            << "batches/sec: " << FLAGS_benchmark_batches / elapsed.count()
+            << "\n"
+            << "env-steps/sec: " << steps / elapsed.count() << "\n"
+            << "episodes: " << episodes << std::endl;
+}
+
+}  // namespace screamyball_env_server
+
+int main(int argc, char** argv) {
+  using namespace screamyball_env_server;
+
+  gflags::SetUsageMessage(
+      "Serves headless games of Screamy Ball to other processes through "
+      "shared memory, many environments a batch.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::unique_ptr<SharedEnvServer> server;
+  try {
+    server = std::make_unique<SharedEnvServer>(
+        FLAGS_path, FLAGS_envs, FLAGS_ring, static_cast<int>(FLAGS_width),
+        static_cast<int>(FLAGS_height), FLAGS_seed, FLAGS_max_episode_ticks);
+  } catch (const std::exception& error) {
+    std::cerr << FLAGS_path << ": " << error.what() << std::endl;
+    return 1;
+  }
+
+  if (FLAGS_benchmark_batches > 0) {
+    Benchmark(server.get());
+  } else {
+    std::signal(SIGINT, Stop);
+    std::signal(SIGTERM, Stop);
+    std::cout << "serving " << FLAGS_envs << " environments at "
+              << FLAGS_path << std::endl;
+    server->Serve(stop);
+  }
+
+  server.reset();
+  std::remove(FLAGS_path.c_str());
+  return 0;
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/leaderboard.h>
+#include <screamy-ball/player.h>
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+
+using screamy_ball::Leaderboard;
+using screamy_ball::Player;
+
+DEFINE_string(db_path, "leaderboard_bench.db",
+              "the database to benchmark, which is emptied first");
+DEFINE_uint32(scores, 2000, "the number of scores to add");
+DEFINE_uint32(queries, 2000, "the number of high score queries to run");
+DEFINE_uint32(players, 20, "the number of different player names");
+DEFINE_uint32(limit, 3, "the number of high scores each query retrieves");
+DEFINE_uint32(seed, 0, "the seed for the generated scores");
+
+namespace screamyball_leaderboard_bench {
+
+/**
+ * Generates a player with a random name and time.
+ * @param rng the random number generator.
+ * @return the player.
+ */
+Player RandomPlayer(std::minstd_rand& rng) {
+  std::uniform_int_distribution<unsigned> name(0, FLAGS_players - 1);
+  std::uniform_int_distribution<int> secs(0, 3 * 60 * 60);
+  const int time = secs(rng);
+
+  char elapsed_time[16];
+  std::snprintf(elapsed_time, sizeof(elapsed_time), "%02d:%02d:%02d",
+                time / 3600, time / 60 % 60, time % 60);
+  return { "player " + std::to_string(name(rng)), elapsed_time };
+}
+
+/**
+ * Prints how fast a batch of operations ran.
+ * @param name the name of the operation.
+ * @param count the number of operations.
+ * @param seconds how long they took.
+ */
+void PrintRate(const std::string& name, unsigned count, double seconds) {
+  std::cout << name << ": " << count << " in " << seconds << " seconds ("
+            << count / seconds << "/sec)" << std::endl;
+}
+
+}  // namespace screamyball_leaderboard_bench
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Benchmarks adding scores to and querying the leaderboard.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  using Clock = std::chrono::steady_clock;
+  Leaderboard leaderboard(FLAGS_db_path);
+  leaderboard.Reset();
+  std::minstd_rand rng(FLAGS_seed);
+
+  const auto insert_start = Clock::now();
+  for (unsigned score = 0; score < FLAGS_scores; score++) {
+    leaderboard.AddScoreToLeaderboard(
+        screamyball_leaderboard_bench::RandomPlayer(rng));
+  }
+  const std::chrono::duration<double> insert_secs =
+      Clock::now() - insert_start;
+
+  // half the queries are for the top players, and half for one player's best
+  size_t retrieved = 0;
+  const auto query_start = Clock::now();
+  for (unsigned query = 0; query < FLAGS_queries; query++) {
+    if (query % 2 == 0) {
+      retrieved += leaderboard.RetrieveHighScores(FLAGS_limit).size();
+    } else {
+      retrieved += leaderboard.RetrieveHighScores(
+          screamyball_leaderboard_bench::RandomPlayer(rng),
+          FLAGS_limit).size();
+    }
+  }
+  const std::chrono::duration<double> query_secs = Clock::now() - query_start;
+
+  screamyball_leaderboard_bench::PrintRate("inserts", FLAGS_scores,
+                                           insert_secs.count());
+  screamyball_leaderboard_bench::PrintRate("queries", FLAGS_queries,
+                                           query_secs.count());
+  std::cout << "scores retrieved: " << retrieved << std::endl;
+  return 0;
+}
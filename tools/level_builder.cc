@@ -0,0 +1,164 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/level.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using screamy_ball::kSubTiles;
+using screamy_ball::Level;
+using screamy_ball::LevelWriter;
+using screamy_ball::ObstacleType;
+using screamy_ball::WorldObstacle;
+
+DEFINE_string(input, "", "the course to build, with one obstacle a line, as "
+                         "its tile, high or low, and its number of spikes. "
+                         "Anything after a # is a comment");
+DEFINE_string(output, "course.level", "the level to write");
+DEFINE_int32(chunk_tiles, 64, "the width of the level's chunks, which are "
+                              "streamed in and out as the game goes");
+DEFINE_uint32(repeat, 1, "the number of times the course is played, one "
+                         "after another, to make a longer level");
+DEFINE_int32(width, 16, "the width of the board the level is played on, in "
+                        "tiles, which no obstacle can be longer than");
+
+namespace screamyball_level_builder {
+
+/**
+ * Reads a course: one obstacle a line, as its tile, high or low, and its
+ * number of spikes. The tile is where the obstacle's first spike ends, and
+ * can be fractional.
+ * @param input the course.
+ * @param end set to the end of the course, in sub-tiles, which is the end
+ * of its last obstacle.
+ * @return the obstacles, in the order they were written.
+ * @throws std::invalid_argument if a line can't be read.
+ */
+std::vector<WorldObstacle> ReadCourse(std::istream& input, long long* end) {
+  std::vector<WorldObstacle> obstacles;
+  *end = 0;
+  std::string line;
+  for (int number = 1; std::getline(input, line); number++) {
+    std::istringstream fields(line.substr(0, line.find('#')));
+    double tile;
+    std::string type;
+    int length;
+    if (!(fields >> tile)) {
+      continue;
+    }
+    if (!(fields >> type >> length) || (type != "high" && type != "low")) {
+      throw std::invalid_argument("Line " + std::to_string(number)
+                                  + " isn't a tile, high or low, and a "
+                                  "length");
+    }
+    const WorldObstacle obstacle = {
+        static_cast<long long>(tile * kSubTiles),
+        type == "high" ? ObstacleType::kHigh : ObstacleType::kLow, length };
+    obstacles.push_back(obstacle);
+    *end = std::max(*end, obstacle.x
+        + static_cast<long long>(obstacle.length) * kSubTiles);
+  }
+  return obstacles;
+}
+
+/**
+ * Counts the obstacles the game will play further along than they were
+ * placed. The engine plays one obstacle at a time, starting with a single
+ * spike at the right edge of the board, so the next one can't come on until
+ * the last has gone past the left edge, and then no sooner than the right
+ * edge. Once obstacles are fast, they're spread out further still, so that
+ * a whole jump fits between them, so this is the fewest that are moved.
+ * @param obstacles the level's obstacles, in any order.
+ * @param width the board's width, in tiles.
+ * @return the number of obstacles that are moved.
+ */
+size_t CountRespaced(std::vector<WorldObstacle> obstacles, int width) {
+  std::sort(obstacles.begin(), obstacles.end(),
+            [](const WorldObstacle& lhs, const WorldObstacle& rhs) {
+              return lhs.x < rhs.x; });
+  size_t respaced = 0;
+  long long earliest_x = static_cast<long long>(2 * width + 1) * kSubTiles;
+  for (const WorldObstacle& obstacle : obstacles) {
+    if (obstacle.x < earliest_x) {
+      respaced++;
+    }
+    const long long played_x = std::max(obstacle.x, earliest_x);
+    earliest_x = played_x + static_cast<long long>(obstacle.length + width)
+        * kSubTiles;
+  }
+  return respaced;
+}
+
+}  // namespace screamyball_level_builder
+
+int main(int argc, char** argv) {
+  using namespace screamyball_level_builder;
+
+  gflags::SetUsageMessage(
+      "Builds a level from a course, which the game streams in with "
+      "--level instead of generating random obstacles.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::ifstream input(FLAGS_input);
+  if (!input) {
+    std::cerr << "Couldn't open " << FLAGS_input << std::endl;
+    return 1;
+  }
+
+  try {
+    long long course_end;
+    const std::vector<WorldObstacle> course = ReadCourse(input, &course_end);
+    LevelWriter writer(FLAGS_chunk_tiles);
+    std::vector<WorldObstacle> level;
+    for (unsigned lap = 0; lap < FLAGS_repeat; lap++) {
+      for (WorldObstacle obstacle : course) {
+        if (obstacle.length > FLAGS_width) {
+          throw std::invalid_argument("An obstacle is longer than the "
+                                      "board");
+        }
+        obstacle.x += course_end * lap;
+        writer.Add(obstacle);
+        level.push_back(obstacle);
+      }
+    }
+
+    const size_t respaced = CountRespaced(level, FLAGS_width);
+    if (respaced > 0) {
+      std::cerr << FLAGS_input << ": warning: " << respaced << " of the "
+                << level.size() << " obstacles are too close to the one "
+                << "before to be played where they are, so the game will "
+                << "move them further along, and further still once "
+                << "obstacles are fast" << std::endl;
+    }
+
+    std::ofstream output(FLAGS_output, std::ios::binary);
+    writer.Write(output);
+    output.close();
+    if (!output) {
+      std::cerr << "Couldn't write " << FLAGS_output << std::endl;
+      return 1;
+    }
+  } catch (const std::invalid_argument& error) {
+    std::cerr << FLAGS_input << ": " << error.what() << std::endl;
+    return 1;
+  }
+
+  // the level is read back, so a broken level fails here instead of in the
+  // game
+  try {
+    const Level level(FLAGS_output);
+    std::cout << FLAGS_output << ": " << level.Size() << " obstacles in "
+              << level.Chunks() << " chunks of " << level.ChunkTiles()
+              << " tiles" << std::endl;
+  } catch (const std::exception& error) {
+    std::cerr << FLAGS_output << ": " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
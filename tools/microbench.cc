@@ -0,0 +1,420 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/collision.h>
+#include <screamy-ball/engine.h>
+#include <screamy-ball/leaderboard.h>
+#include <screamy-ball/location.h>
+#include <screamy-ball/particles.h>
+#include <screamy-ball/player.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using screamy_ball::BallState;
+using screamy_ball::Ellipse;
+using screamy_ball::Engine;
+using screamy_ball::Intersects;
+using screamy_ball::Leaderboard;
+using screamy_ball::Location;
+using screamy_ball::ParticleSystem;
+using screamy_ball::Player;
+using screamy_ball::TriangleBatch;
+
+DEFINE_string(filter, "", "only run the benchmarks whose names contain this");
+DEFINE_double(min_secs, 0.2, "the least time each benchmark is run for");
+DEFINE_uint32(repetitions, 3, "how many times each benchmark is run; the "
+                              "fastest run is reported");
+DEFINE_bool(leaderboard, true, "run the leaderboard benchmarks, which fill "
+                               "a scratch database first");
+DEFINE_string(leaderboard_rows, "1000,100000,10000000",
+              "the leaderboard sizes to benchmark the queries at");
+DEFINE_string(db_path, "microbench.db",
+              "the scratch database for the leaderboard benchmarks");
+DEFINE_string(json, "", "write the results to this JSON file");
+DEFINE_string(baseline, "", "compare the results with this JSON file");
+DEFINE_double(max_regression, 0.25, "fail if a benchmark is this fraction "
+                                    "slower than its baseline, once the "
+                                    "baseline is scaled to this machine");
+
+namespace screamyball_microbench {
+
+// results are written here, so the benchmarked work can't be optimized away
+volatile int sink;
+
+// the benchmark that measures how fast the machine is, rather than the game
+const char kCalibration[] = "calibration/xorshift";
+
+/**
+ * A benchmark's result.
+ */
+struct Result {
+  std::string name;
+  double ns_per_op;
+  size_t iterations;
+};
+
+/**
+ * Runs a benchmark, doubling its number of iterations until it runs for at
+ * least --min_secs, and keeps the fastest of --repetitions runs.
+ * @param name the benchmark's name.
+ * @param run runs the benchmarked operation the given number of times.
+ * @param results the results, which the benchmark's result is added to.
+ */
+template <typename Run>
+void Benchmark(const std::string& name, Run run,
+               std::vector<Result>* results) {
+  // the calibration is always run, since the comparison needs it
+  if (name.find(FLAGS_filter) == std::string::npos && name != kCalibration) {
+    return;
+  }
+  using Clock = std::chrono::steady_clock;
+
+  Result result = { name, 0, 0 };
+  for (unsigned repetition = 0; repetition < FLAGS_repetitions;
+       repetition++) {
+    size_t iterations = 1;
+    while (true) {
+      const auto start = Clock::now();
+      run(iterations);
+      const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+      if (elapsed.count() >= FLAGS_min_secs) {
+        const double ns_per_op =
+            elapsed.count() * 1e9 / static_cast<double>(iterations);
+        if (result.iterations == 0 || ns_per_op < result.ns_per_op) {
+          result.ns_per_op = ns_per_op;
+          result.iterations = iterations;
+        }
+        break;
+      }
+      iterations *= 2;
+    }
+  }
+
+  std::printf("%-40s %14.1f ns/op %12zu iterations\n", name.c_str(),
+              result.ns_per_op, result.iterations);
+  results->push_back(result);
+}
+
+/**
+ * Adds a benchmark of plain integer arithmetic, which doesn't touch any of
+ * the game's code. How long it takes, compared with the baseline, says how
+ * much faster or slower this machine is than the baseline's.
+ */
+void BenchmarkCalibration(std::vector<Result>* results) {
+  Benchmark(kCalibration, [&](size_t iterations) {
+    // every step depends on the last, so it can't be vectorized or skipped
+    uint32_t state = 1;
+    for (size_t step = 0; step < iterations; step++) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+    }
+    sink = static_cast<int>(state);
+  }, results);
+}
+
+/**
+ * Adds the benchmarks of the Engine's hot paths.
+ */
+void BenchmarkEngine(std::vector<Result>* results) {
+  const Location ball_loc = {2, 14};
+
+  Benchmark("engine/run", [&](size_t iterations) {
+    Engine engine(ball_loc, 16, 16, 0);
+    for (size_t tick = 0; tick < iterations; tick++) {
+      engine.Run();
+      if (engine.state_ == BallState::kCollided) {
+        engine.Reset();
+      }
+    }
+    sink = engine.obstacle_.location.Row();
+  }, results);
+
+  // the obstacle is moved to the edge of the board before every tick, so
+  // every tick spawns a new obstacle
+  Benchmark("engine/run_with_spawn", [&](size_t iterations) {
+    Engine engine(ball_loc, 16, 16, 0);
+    for (size_t tick = 0; tick < iterations; tick++) {
+      engine.obstacle_.location = { -engine.obstacle_.length,
+                                    engine.obstacle_.location.Col() };
+      engine.Run();
+    }
+    sink = engine.obstacle_.length;
+  }, results);
+
+  // the obstacle is kept on top of the ball, so every tick tests the spikes
+  Benchmark("engine/run_with_collision_test", [&](size_t iterations) {
+    Engine engine(ball_loc, 16, 16, 0);
+    for (size_t tick = 0; tick < iterations; tick++) {
+      engine.obstacle_.location = { ball_loc.Row() + 2, ball_loc.Col() };
+      engine.state_ = BallState::kJumping;
+      engine.Run();
+    }
+    sink = static_cast<int>(engine.state_);
+  }, results);
+
+  Benchmark("collision/intersects_4_spikes", [&](size_t iterations) {
+    TriangleBatch spikes;
+    for (int spike = 0; spike < 4; spike++) {
+      const float right = 3.0f + static_cast<float>(spike);
+      spikes.Add({ right, 14, right - 1, 14, right - 0.5f, 12 });
+    }
+    int hits = 0;
+    for (size_t test = 0; test < iterations; test++) {
+      const float y = 12.0f + static_cast<float>(test % 8) * 0.25f;
+      hits += Intersects(Ellipse{ 2.5f, y, 0.5f, 0.5f }, spikes);
+    }
+    sink = hits;
+  }, results);
+
+  // the rows are loaded from volatile memory, so the optimizer can't work
+  // out which locations are equal ahead of time and fold the loop away; the
+  // locations are really constructed and compared on every iteration
+  volatile int rows[16];
+  for (int row = 0; row < 16; row++) {
+    rows[row] = row & 7;
+  }
+  Benchmark("location/construct_and_compare", [&](size_t iterations) {
+    int equal = 0;
+    for (size_t index = 0; index < iterations; index++) {
+      const Location lhs(rows[index & 15], 14);
+      const Location rhs(rows[(index + 3) & 15], 14);
+      equal += lhs == rhs;
+    }
+    sink = equal;
+  }, results);
+
+  Benchmark("player/pretty_print_elapsed_time", [&](size_t iterations) {
+    size_t length = 0;
+    for (size_t index = 0; index < iterations; index++) {
+      length += screamy_ball::PrettyPrintElapsedTime(
+          static_cast<double>(index % 100000)).size();
+    }
+    sink = static_cast<int>(length);
+  }, results);
+}
+
+/**
+ * Adds the benchmarks of the particle system, at the 10,000 live particles
+ * it has to move and write out within a millisecond.
+ */
+void BenchmarkParticles(std::vector<Result>* results) {
+  const size_t kParticles = 10000;
+  // the particles live far longer than the benchmark runs for
+  const screamy_ball::Burst burst = { 2, 14, kParticles, 1, 4, 1.57f, 1.57f,
+                                      1e9f, 20, 0 };
+  ParticleSystem particles(kParticles, 0);
+  particles.Emit(burst);
+  std::vector<float> instances(kParticles * ParticleSystem::kInstanceFloats);
+
+  Benchmark("particles/update_10000", [&](size_t iterations) {
+    for (size_t frame = 0; frame < iterations; frame++) {
+      particles.Update(1e-6f);
+    }
+    sink = static_cast<int>(particles.Size());
+  }, results);
+
+  Benchmark("particles/write_instances_10000", [&](size_t iterations) {
+    size_t written = 0;
+    for (size_t frame = 0; frame < iterations; frame++) {
+      written += particles.WriteInstances(instances.data());
+    }
+    sink = static_cast<int>(written);
+  }, results);
+}
+
+/**
+ * Generates a player with a random name and time.
+ * @param rng the random number generator.
+ * @return the player.
+ */
+Player RandomPlayer(std::minstd_rand& rng) {
+  std::uniform_int_distribution<int> name(0, 99);
+  std::uniform_int_distribution<int> secs(0, 3 * 60 * 60);
+  return { "player " + std::to_string(name(rng)),
+           screamy_ball::PrettyPrintElapsedTime(secs(rng)) };
+}
+
+/**
+ * Adds the benchmarks of the Leaderboard's queries at every size in
+ * --leaderboard_rows. The rows are added in large batches, so even the
+ * largest leaderboards fill up quickly.
+ */
+void BenchmarkLeaderboard(std::vector<Result>* results) {
+  if (!FLAGS_leaderboard) {
+    return;
+  }
+  Leaderboard leaderboard(FLAGS_db_path);
+  leaderboard.Reset();
+  std::minstd_rand rng(0);
+
+  Benchmark("leaderboard/insert", [&](size_t iterations) {
+    for (size_t score = 0; score < iterations; score++) {
+      leaderboard.AddScoreToLeaderboard(RandomPlayer(rng));
+    }
+  }, results);
+  leaderboard.Reset();
+
+  size_t rows = 0;
+  std::stringstream sizes(FLAGS_leaderboard_rows);
+  std::string size;
+  while (std::getline(sizes, size, ',')) {
+    const size_t target_rows = std::stoul(size);
+
+    const size_t kBatchRows = 100000;
+    std::vector<Player> batch;
+    while (rows < target_rows) {
+      batch.clear();
+      for (; rows < target_rows && batch.size() < kBatchRows; rows++) {
+        batch.push_back(RandomPlayer(rng));
+      }
+      leaderboard.AddScoresToLeaderboard(batch);
+    }
+
+    Benchmark("leaderboard/top_3/" + size, [&](size_t iterations) {
+      size_t found = 0;
+      for (size_t query = 0; query < iterations; query++) {
+        found += leaderboard.RetrieveHighScores(3).size();
+      }
+      sink = static_cast<int>(found);
+    }, results);
+
+    Benchmark("leaderboard/player_top_3/" + size, [&](size_t iterations) {
+      size_t found = 0;
+      for (size_t query = 0; query < iterations; query++) {
+        found += leaderboard.RetrieveHighScores(RandomPlayer(rng), 3).size();
+      }
+      sink = static_cast<int>(found);
+    }, results);
+  }
+}
+
+/**
+ * Writes the results as JSON, with one benchmark per line.
+ * @param path the path of the file to write.
+ * @param results the results.
+ * @return true if the file was written, false otherwise.
+ */
+bool WriteJson(const std::string& path, const std::vector<Result>& results) {
+  std::ofstream file(path);
+  file << "{\"benchmarks\": [";
+  for (size_t index = 0; index < results.size(); index++) {
+    file << (index == 0 ? "\n" : ",\n")
+         << "  {\"name\": \"" << results[index].name << "\", \"ns_per_op\": "
+         << results[index].ns_per_op << ", \"iterations\": "
+         << results[index].iterations << "}";
+  }
+  file << "\n]}\n";
+  return static_cast<bool>(file);
+}
+
+/**
+ * Reads the results in a JSON file written by WriteJson.
+ * @param path the path of the file to read.
+ * @return the time of each benchmark, in ns/op, by name.
+ */
+std::map<std::string, double> ReadJson(const std::string& path) {
+  std::map<std::string, double> baseline;
+  std::ifstream file(path);
+  std::string line;
+  const std::string name_key = "\"name\": \"";
+  const std::string time_key = "\"ns_per_op\": ";
+
+  while (std::getline(file, line)) {
+    const size_t name_start = line.find(name_key);
+    const size_t time_start = line.find(time_key);
+    if (name_start == std::string::npos || time_start == std::string::npos) {
+      continue;
+    }
+    const size_t name_begin = name_start + name_key.size();
+    const std::string name = line.substr(name_begin,
+                                         line.find('"', name_begin)
+                                         - name_begin);
+    baseline[name] = std::stod(line.substr(time_start + time_key.size()));
+  }
+  return baseline;
+}
+
+/**
+ * Compares the results with a baseline, scaled by how long the calibration
+ * took here compared with on the baseline's machine.
+ * @param results the results.
+ * @param baseline the baseline's times, by name.
+ * @return true if no benchmark regressed by more than --max_regression.
+ */
+bool CompareWithBaseline(const std::vector<Result>& results,
+                         const std::map<std::string, double>& baseline) {
+  double scale = 1;
+  const auto calibration = std::find_if(results.begin(), results.end(),
+      [](const Result& result) { return result.name == kCalibration; });
+  const auto expected_calibration = baseline.find(kCalibration);
+  if (calibration != results.end()
+      && expected_calibration != baseline.end()) {
+    scale = calibration->ns_per_op / expected_calibration->second;
+  }
+  std::printf("%-40s %7.2fx the baseline's times\n", "scale", scale);
+
+  bool passed = true;
+  for (const Result& result : results) {
+    if (result.name == kCalibration) {
+      continue;
+    }
+    const auto expected = baseline.find(result.name);
+    if (expected == baseline.end()) {
+      std::printf("%-40s no baseline\n", result.name.c_str());
+      continue;
+    }
+
+    const double change = result.ns_per_op / (expected->second * scale) - 1;
+    const bool regressed = change > FLAGS_max_regression;
+    std::printf("%-40s %+7.1f%% %s\n", result.name.c_str(), change * 100,
+                regressed ? "REGRESSED" : "ok");
+    passed &= !regressed;
+  }
+  return passed;
+}
+
+}  // namespace screamyball_microbench
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Benchmarks the Engine's and the Leaderboard's hot paths.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::vector<screamyball_microbench::Result> results;
+  screamyball_microbench::BenchmarkCalibration(&results);
+  screamyball_microbench::BenchmarkEngine(&results);
+  screamyball_microbench::BenchmarkParticles(&results);
+  screamyball_microbench::BenchmarkLeaderboard(&results);
+
+  if (!FLAGS_json.empty()
+      && !screamyball_microbench::WriteJson(FLAGS_json, results)) {
+    std::cerr << "Couldn't write " << FLAGS_json << std::endl;
+    return 1;
+  }
+
+  if (!FLAGS_baseline.empty()) {
+    const auto baseline = screamyball_microbench::ReadJson(FLAGS_baseline);
+    if (baseline.empty()) {
+      std::cerr << "Couldn't read the baseline " << FLAGS_baseline
+                << std::endl;
+      return 1;
+    }
+    std::cout << "\nCompared with " << FLAGS_baseline << ":" << std::endl;
+    if (!screamyball_microbench::CompareWithBaseline(results, baseline)) {
+      return 1;
+    }
+  }
+  return 0;
+}
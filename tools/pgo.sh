@@ -0,0 +1,69 @@
+#!/bin/sh
+# Builds Screamy Ball with profile-guided optimization, and compares it with a
+# plain optimized build:
+#   1. builds an optimized (Release, LTO) build to compare against,
+#   2. builds an instrumented build, and trains it on headless seeded games,
+#      the leaderboard benchmark and, if xvfb-run is installed, the app's
+#      benchmark replay,
+#   3. rebuilds the library, the app and the tools from the profiles,
+#   4. runs the engine and leaderboard benchmarks on both builds.
+# The instrumented build and the rebuild share a build directory, since GCC
+# names each object's profile after the object's absolute path, and only
+# finds it again when the object is rebuilt in the same place.
+#
+# Usage: tools/pgo.sh [build directory]
+set -e
+
+SOURCE="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD="${1:-$SOURCE/build-pgo}"
+PROFILES="$BUILD/profiles"
+JOBS="$(nproc 2> /dev/null || echo 4)"
+BENCHMARKS="simulator leaderboard_bench"
+
+configure() {
+  cmake -S "$SOURCE" -B "$BUILD/$1" -DCMAKE_BUILD_TYPE=Release \
+      -DSCREAMY_BALL_PGO="$2" -DSCREAMY_BALL_PGO_DIR="$PROFILES"
+}
+
+build() {
+  for target in $2; do
+    cmake --build "$BUILD/$1" -j"$JOBS" --target "$target"
+  done
+}
+
+echo "== Building the optimized build to compare against"
+configure release ""
+build release "$BENCHMARKS"
+
+echo "== Training an instrumented build"
+rm -rf "$PROFILES"
+configure pgo GENERATE
+build pgo "$BENCHMARKS"
+"$BUILD/pgo/tools/simulator" --seeds=300 > /dev/null
+"$BUILD/pgo/tools/simulator" --seeds=100 --autoplay=false > /dev/null
+"$BUILD/pgo/tools/leaderboard_bench" \
+    --db_path="$BUILD/training.db" > /dev/null
+if command -v xvfb-run > /dev/null; then
+  build pgo cinder-screamy-ball
+  APP="$(find "$BUILD/pgo" -type f -name cinder-screamy-ball | head -n 1)"
+  "$SOURCE/tools/benchmark.sh" "$APP" "$BUILD/training.json" > /dev/null
+fi
+
+# clang writes raw profiles, which have to be merged before they're used
+if ls "$PROFILES"/*.profraw > /dev/null 2>&1; then
+  llvm-profdata merge -output="$PROFILES/merged.profdata" \
+      "$PROFILES"/*.profraw
+fi
+
+echo "== Rebuilding from the profiles"
+configure pgo USE
+cmake --build "$BUILD/pgo" -j"$JOBS"
+
+echo "== Comparing the builds"
+for variant in release pgo; do
+  echo "[$variant]"
+  "$BUILD/$variant/tools/simulator" --seeds=1000 --first_seed=1000 \
+      | grep -E "ticks/sec|decisions/sec"
+  "$BUILD/$variant/tools/leaderboard_bench" \
+      --db_path="$BUILD/$variant.db" | grep -E "inserts|queries"
+done
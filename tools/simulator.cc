@@ -0,0 +1,172 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/autoplayer.h>
+#include <screamy-ball/engine.h>
+#include <screamy-ball/level.h>
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using screamy_ball::Autoplayer;
+using screamy_ball::BallState;
+using screamy_ball::DefaultEngine;
+using screamy_ball::DefaultGeometry;
+using screamy_ball::Engine;
+using screamy_ball::Level;
+using screamy_ball::Location;
+
+DEFINE_uint32(width, 16, "the number of tiles in each row");
+DEFINE_uint32(height, 16, "the number of tiles in each column");
+DEFINE_uint32(seeds, 1000, "the number of seeded games to play");
+DEFINE_uint32(first_seed, 0, "the seed of the first game");
+DEFINE_uint32(max_ticks, 10000, "the tick at which a game is stopped");
+DEFINE_uint32(lookahead, 12, "the number of ticks the autoplayer searches");
+DEFINE_bool(autoplay, true, "let the autoplayer play; otherwise, the ball "
+                            "only rolls");
+DEFINE_bool(compare_engines, false, "play the same games on the runtime "
+                                    "Engine and on the DefaultEngine, which "
+                                    "is specialized for a 16x16 board");
+DEFINE_string(level, "", "play this level, made by level_builder, instead of "
+                         "random obstacles until it runs out");
+
+namespace screamyball_simulator {
+
+/**
+ * The outcome of playing a batch of seeded games.
+ */
+struct Stats {
+  size_t total_ticks = 0;
+  size_t longest_ticks = 0;
+  unsigned longest_seed = 0;
+  size_t decisions = 0;
+  double seconds = 0;
+};
+
+/**
+ * Plays a single game without any graphics.
+ * @param engine the engine to play on, freshly created from the game's seed.
+ * @param player the autoplayer, or nullptr if the ball should only roll.
+ * @return the number of ticks the ball survived for.
+ */
+template <typename E>
+size_t PlayGame(E engine, Autoplayer* player) {
+  size_t tick = 0;
+  for (; tick < FLAGS_max_ticks; tick++) {
+    if (player != nullptr) {
+      Autoplayer::Apply(&engine, player->Decide(engine));
+    }
+    engine.Run();
+    if (engine.state_ == BallState::kCollided) {
+      break;
+    }
+  }
+  return tick;
+}
+
+/**
+ * Plays every seeded game on engines made by `make_engine`.
+ * @param make_engine creates an engine from a seed.
+ * @return the outcome of the games.
+ */
+template <typename MakeEngine>
+Stats PlayGames(MakeEngine make_engine) {
+  Autoplayer autoplayer(FLAGS_lookahead);
+  Autoplayer* player = FLAGS_autoplay ? &autoplayer : nullptr;
+  Stats stats;
+  stats.longest_seed = FLAGS_first_seed;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned seed = FLAGS_first_seed;
+       seed < FLAGS_first_seed + FLAGS_seeds; seed++) {
+    const size_t ticks = PlayGame(make_engine(seed), player);
+    stats.total_ticks += ticks;
+    if (ticks > stats.longest_ticks) {
+      stats.longest_ticks = ticks;
+      stats.longest_seed = seed;
+    }
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  stats.seconds = elapsed.count();
+  stats.decisions = autoplayer.Decisions();
+  return stats;
+}
+
+/**
+ * Prints the outcome of a batch of games.
+ * @param name the name of the engine the games were played on.
+ * @param stats the outcome.
+ */
+void PrintStats(const std::string& name, const Stats& stats) {
+  const double games = FLAGS_seeds;
+  const double ticks = static_cast<double>(stats.total_ticks);
+  const double decisions = static_cast<double>(stats.decisions);
+
+  std::cout << "[" << name << "]\n"
+            << "games: " << FLAGS_seeds << "\n"
+            << "ticks: " << stats.total_ticks << "\n"
+            << "seconds: " << stats.seconds << "\n"
+            << "games/sec: " << games / stats.seconds << "\n"
+            << "ticks/sec: " << ticks / stats.seconds << "\n"
+            << "decisions/sec: " << decisions / stats.seconds << "\n"
+            << "longest survival: " << stats.longest_ticks << " ticks (seed "
+            << stats.longest_seed << ")" << std::endl;
+}
+
+}  // namespace screamyball_simulator
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Plays seeded games of Screamy Ball without any graphics.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::unique_ptr<Level> level;
+  if (!FLAGS_level.empty()) {
+    try {
+      level = std::make_unique<Level>(FLAGS_level);
+    } catch (const std::exception& error) {
+      std::cerr << FLAGS_level << ": " << error.what() << std::endl;
+      return 1;
+    }
+  }
+
+  const Location ball_loc = {2, static_cast<int>(FLAGS_height - 2)};
+  const screamyball_simulator::Stats runtime_stats =
+      screamyball_simulator::PlayGames([&](unsigned seed) {
+        Engine engine(ball_loc, static_cast<int>(FLAGS_width),
+                      static_cast<int>(FLAGS_height), seed);
+        engine.SetObstacleSource(level.get());
+        return engine;
+      });
+  screamyball_simulator::PrintStats("Engine", runtime_stats);
+
+  if (!FLAGS_compare_engines) {
+    return 0;
+  }
+  if (static_cast<int>(FLAGS_width) != DefaultGeometry::Width()
+      || static_cast<int>(FLAGS_height) != DefaultGeometry::Height()) {
+    std::cerr << "--compare_engines needs the default board size" << std::endl;
+    return 1;
+  }
+
+  const screamyball_simulator::Stats default_stats =
+      screamyball_simulator::PlayGames([&](unsigned seed) {
+        DefaultEngine engine(ball_loc, DefaultGeometry(), seed);
+        engine.SetObstacleSource(level.get());
+        return engine;
+      });
+  screamyball_simulator::PrintStats("DefaultEngine", default_stats);
+
+  // both engines play the same seeds, so they must play the same games
+  if (default_stats.total_ticks != runtime_stats.total_ticks) {
+    std::cerr << "the engines played different games" << std::endl;
+    return 1;
+  }
+  std::cout << "speed-up: " << runtime_stats.seconds / default_stats.seconds
+            << "x" << std::endl;
+  return 0;
+}
@@ -0,0 +1,451 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/resampler.h>
+#include <screamy-ball/speech_commands.h>
+#include <screamy-ball/speech_gate.h>
+#include <screamy-ball/wav.h>
+#include <gflags/gflags.h>
+#include <pocketsphinx.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using screamy_ball::CommandTrigger;
+using screamy_ball::CorpusEntry;
+using screamy_ball::SpeechCommand;
+
+DEFINE_string(corpus, "", "the corpus to recognize: one WAV file per line, "
+                          "relative to the corpus, followed by the words "
+                          "spoken in it");
+DEFINE_string(model_dir, "assets", "the directory with the recognizer's "
+                                   "models");
+DEFINE_string(hmm, "en-us", "the acoustic model, in the model directory");
+DEFINE_string(dict, "6247.dic", "the dictionary, in the model directory");
+DEFINE_string(lm, "6247.lm", "the language model, in the model directory");
+DEFINE_string(mode, "lm", "how the recognizer decodes: lm, for free speech "
+                          "with the language model; grammar, for only the "
+                          "game's phrases; or kws, to spot the phrases as "
+                          "keywords");
+DEFINE_bool(early, false, "trigger commands from partial hypotheses, before "
+                          "the utterance ends");
+DEFINE_string(ps_args, "", "more recognizer settings, as comma-separated "
+                           "-name=value pairs, like "
+                           "-vad_threshold=3.0,-beam=1e-40");
+DEFINE_uint32(threads, 0, "the number of recordings recognized at once; 0 "
+                          "uses every core");
+DEFINE_uint32(chunk_ms, 32, "the length of the chunks of audio the "
+                            "recognizer is given, as the microphone would "
+                            "deliver them");
+DEFINE_double(trailing_silence_secs, 1.0, "the silence added after each "
+                                          "recording, so the recognizer "
+                                          "hears the utterance end");
+DEFINE_bool(gate, false, "only decode the audio the game's voice-activity "
+                         "gate lets through");
+DEFINE_bool(verbose, false, "print every misrecognized recording");
+
+namespace screamyball_speech_bench {
+
+// the sample rate of the acoustic model
+const unsigned kSampleRate = 16000;
+
+/**
+ * What the recognizer made of one recording.
+ */
+struct Result {
+  SpeechCommand expected = SpeechCommand::kNone;
+  SpeechCommand recognized = SpeechCommand::kNone;
+  std::string hypothesis;
+  // from the end of the utterance to the command triggering, in seconds,
+  // which is negative if it triggered early
+  double latency_secs = 0;
+  double audio_secs = 0;
+  std::string error;
+};
+
+/**
+ * Recognizes recordings with the same models as the game's recognizer.
+ */
+class Decoder {
+ public:
+  explicit Decoder(std::vector<std::string> args);
+  ~Decoder();
+  Decoder(const Decoder&) = delete;
+  Decoder& operator=(const Decoder&) = delete;
+
+  Result Recognize(const CorpusEntry& entry, const std::string& directory);
+
+ private:
+  cmd_ln_t* config_;
+  ps_decoder_t* decoder_;
+  CommandTrigger trigger_;
+};
+
+/**
+ * Writes a file the recognizer loads, to the working directory.
+ * @param path the file's path.
+ * @param text the file's text.
+ * @return the path.
+ */
+std::string WriteModelFile(const std::string& path, const std::string& text) {
+  std::ofstream file(path);
+  if (!(file << text)) {
+    throw std::runtime_error("Couldn't write " + path);
+  }
+  return path;
+}
+
+/**
+ * Builds the recognizer's arguments from the flags, as they'd be given on
+ * the command line, and writes the grammar or keyword list the mode needs.
+ * @return the arguments, in name, value pairs.
+ * @throws std::invalid_argument if a flag is invalid.
+ */
+std::vector<std::string> DecoderArgs() {
+  const std::string directory = FLAGS_model_dir + "/";
+  std::vector<std::string> args = {
+      "-hmm", directory + FLAGS_hmm,
+      "-dict", directory + FLAGS_dict,
+      "-logfn", "/dev/null"
+  };
+  if (FLAGS_mode == "lm") {
+    args.insert(args.end(), { "-lm", directory + FLAGS_lm });
+  } else if (FLAGS_mode == "grammar") {
+    args.insert(args.end(), { "-jsgf", WriteModelFile(
+        "speech_bench.gram", screamy_ball::CommandGrammar()) });
+  } else if (FLAGS_mode == "kws") {
+    args.insert(args.end(), { "-kws", WriteModelFile(
+        "speech_bench.kws", screamy_ball::KeywordList()) });
+  } else {
+    throw std::invalid_argument("The mode must be lm, grammar or kws, not "
+                                + FLAGS_mode);
+  }
+
+  std::istringstream extra(FLAGS_ps_args);
+  std::string arg;
+  while (std::getline(extra, arg, ',')) {
+    const size_t equals = arg.find('=');
+    if (equals == std::string::npos) {
+      throw std::invalid_argument("Recognizer settings must be -name=value, "
+                                  "not " + arg);
+    }
+    args.push_back(arg.substr(0, equals));
+    args.push_back(arg.substr(equals + 1));
+  }
+  return args;
+}
+
+/**
+ * Loads the models.
+ * @param args the recognizer's arguments.
+ * @throws std::runtime_error if the models can't be loaded.
+ */
+Decoder::Decoder(std::vector<std::string> args) :
+    config_(nullptr), decoder_(nullptr) {
+  std::vector<char*> argv;
+  for (std::string& arg : args) {
+    argv.push_back(&arg[0]);
+  }
+
+  config_ = cmd_ln_parse_r(nullptr, ps_args(), static_cast<int32>(argv.size()),
+                           argv.data(), TRUE);
+  if (config_ != nullptr) {
+    decoder_ = ps_init(config_);
+  }
+  if (decoder_ == nullptr) {
+    cmd_ln_free_r(config_);
+    throw std::runtime_error("Couldn't load the recognizer's models from "
+                             + FLAGS_model_dir);
+  }
+}
+
+Decoder::~Decoder() {
+  ps_free(decoder_);
+  cmd_ln_free_r(config_);
+}
+
+/**
+ * Recognizes a recording the way the game's recognizer does: the audio is
+ * given to the recognizer a chunk at a time, and an utterance is decoded as
+ * soon as the recognizer stops hearing speech. The chunks are given as fast
+ * as they can be decoded, but the latency is measured as if they arrived in
+ * real time: each chunk can only be decoded once it has been recorded, and
+ * after the chunks before it have been decoded. With --early, a partial
+ * hypothesis is checked after every chunk, and with --gate, only the chunks
+ * the game's voice-activity gate lets through are decoded, and an utterance
+ * the gate cuts off is ended once it has been shut for a while, as the game
+ * does.
+ * @param entry the recording.
+ * @param directory the directory the recording's path is relative to.
+ * @return the recognized command, and how long it took.
+ */
+Result Decoder::Recognize(const CorpusEntry& entry,
+                          const std::string& directory) {
+  using Clock = std::chrono::steady_clock;
+
+  Result result;
+  result.expected = screamy_ball::ParseSpeechCommand(entry.transcript);
+
+  std::ifstream file(directory + entry.wav_path, std::ios::binary);
+  if (!file) {
+    result.error = "couldn't open the recording";
+    return result;
+  }
+  screamy_ball::WavData wav;
+  try {
+    wav = screamy_ball::ReadWav(file);
+  } catch (const std::invalid_argument& error) {
+    result.error = error.what();
+    return result;
+  }
+
+  // resampled the same way the game resamples the microphone
+  const std::vector<float> recorded = screamy_ball::MixToMono(wav);
+  screamy_ball::StreamResampler resampler(wav.sample_rate, kSampleRate,
+                                          recorded.size());
+  std::vector<float> mono(resampler.MaxOutput());
+  mono.resize(resampler.Process(recorded.data(), recorded.size(),
+                                mono.data()));
+  const double utterance_end = screamy_ball::UtteranceEndSecs(mono,
+                                                              kSampleRate);
+  std::vector<float> samples(mono);
+  samples.resize(mono.size() + static_cast<size_t>(
+      FLAGS_trailing_silence_secs * kSampleRate), 0);
+  result.audio_secs = static_cast<double>(mono.size()) / kSampleRate;
+
+  const size_t chunk = std::max<size_t>(1, kSampleRate * FLAGS_chunk_ms
+                                               / 1000);
+  screamy_ball::SpeechGate gate(kSampleRate, chunk);
+  std::vector<int16_t> decoded_chunk;
+  // when the recognizer would have finished with the audio so far, had it
+  // been listening in real time
+  double decoded_secs = 0;
+  bool in_utterance = false;
+  // how long the gate has been shut, which ends an utterance it cut off
+  double idle_secs = 0;
+  bool found = false;
+
+  ps_start_utt(decoder_);
+  for (size_t start = 0; start < samples.size() && !found; start += chunk) {
+    const size_t count = std::min(chunk, samples.size() - start);
+    const double recorded_secs = static_cast<double>(start + count)
+        / kSampleRate;
+
+    const auto decode_start = Clock::now();
+    const float* speech = &samples[start];
+    size_t speech_count = count;
+    if (FLAGS_gate) {
+      speech_count = gate.Process(speech, count);
+      speech = gate.Output();
+    }
+    decoded_chunk.resize(speech_count);
+    for (size_t index = 0; index < speech_count; index++) {
+      decoded_chunk[index] = static_cast<int16_t>(
+          std::min(1.0f, std::max(-1.0f, speech[index])) * 32767);
+    }
+    if (speech_count > 0) {
+      ps_process_raw(decoder_, decoded_chunk.data(), speech_count, FALSE,
+                     FALSE);
+      idle_secs = 0;
+    } else {
+      idle_secs += static_cast<double>(count) / kSampleRate;
+    }
+    const bool in_speech = ps_get_in_speech(decoder_) != 0;
+    const bool ended = in_utterance && (!in_speech || idle_secs
+        >= screamy_ball::GateParameters().end_utterance_secs);
+    int32 score;
+    const char* hypothesis = nullptr;
+    SpeechCommand command = SpeechCommand::kNone;
+    if (ended) {
+      ps_end_utt(decoder_);
+      hypothesis = ps_get_hyp(decoder_, &score);
+      command = trigger_.OnFinal(hypothesis != nullptr ? hypothesis : "");
+      ps_start_utt(decoder_);
+    } else if (FLAGS_early && in_speech) {
+      hypothesis = ps_get_hyp(decoder_, &score);
+      command = trigger_.OnPartial(hypothesis != nullptr ? hypothesis : "");
+    }
+    decoded_secs = std::max(decoded_secs, recorded_secs)
+        + std::chrono::duration<double>(Clock::now() - decode_start).count();
+
+    in_utterance = in_speech && !ended;
+    // the game acts on the first utterance it hears
+    if (command != SpeechCommand::kNone
+        || (ended && hypothesis != nullptr && *hypothesis != '\0')) {
+      result.hypothesis = hypothesis;
+      result.recognized = command;
+      result.latency_secs = decoded_secs - utterance_end;
+      found = true;
+    }
+  }
+  ps_end_utt(decoder_);
+  trigger_.OnFinal("");
+  return result;
+}
+
+/**
+ * Recognizes every recording in the corpus, spread over the threads. Each
+ * thread has its own recognizer, since they can't be shared.
+ * @param entries the corpus.
+ * @param directory the directory the recordings' paths are relative to.
+ * @param args the recognizer's arguments.
+ * @return every recording's result, in the corpus's order.
+ */
+std::vector<Result> RecognizeAll(const std::vector<CorpusEntry>& entries,
+                                 const std::string& directory,
+                                 const std::vector<std::string>& args) {
+  std::vector<Result> results(entries.size());
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+
+  unsigned threads = FLAGS_threads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::min(threads, static_cast<unsigned>(entries.size()));
+
+  std::vector<std::thread> workers;
+  for (unsigned thread = 0; thread < threads; thread++) {
+    workers.emplace_back([&]() {
+      try {
+        Decoder decoder(args);
+        for (size_t index = next++; index < entries.size(); index = next++) {
+          results[index] = decoder.Recognize(entries[index], directory);
+        }
+      } catch (const std::exception& error) {
+        if (!failed.exchange(true)) {
+          std::cerr << error.what() << std::endl;
+        }
+      }
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  if (failed) {
+    throw std::runtime_error("The recognizer failed");
+  }
+  return results;
+}
+
+/**
+ * Prints the accuracy and latency of each command's recordings.
+ * @param results the results of every recording.
+ */
+void PrintReport(const std::vector<Result>& results) {
+  std::map<SpeechCommand, std::vector<const Result*>> by_command;
+  for (const Result& result : results) {
+    if (result.error.empty()) {
+      by_command[result.expected].push_back(&result);
+    }
+  }
+
+  std::cout << std::left << std::setw(8) << "command" << std::right
+            << std::setw(7) << "files" << std::setw(10) << "accuracy"
+            << std::setw(14) << "latency p50" << std::setw(14)
+            << "latency p95" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+
+  for (const auto& command : by_command) {
+    size_t correct = 0;
+    std::vector<double> latencies;
+    for (const Result* result : command.second) {
+      if (result->recognized == result->expected) {
+        correct++;
+        if (result->recognized != SpeechCommand::kNone) {
+          latencies.push_back(result->latency_secs);
+        }
+      }
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::left << std::setw(8)
+              << screamy_ball::SpeechCommandName(command.first) << std::right
+              << std::setw(7) << command.second.size() << std::setw(10)
+              << static_cast<double>(correct)
+                 / static_cast<double>(command.second.size());
+    if (latencies.empty()) {
+      std::cout << std::setw(14) << "-" << std::setw(14) << "-";
+    } else {
+      // the nearest-rank percentiles, in seconds
+      std::cout << std::setw(14) << latencies[(latencies.size() - 1) / 2]
+                << std::setw(14)
+                << latencies[(latencies.size() - 1) * 95 / 100];
+    }
+    std::cout << std::endl;
+  }
+}
+
+}  // namespace screamyball_speech_bench
+
+int main(int argc, char** argv) {
+  using namespace screamyball_speech_bench;
+  using Clock = std::chrono::steady_clock;
+
+  gflags::SetUsageMessage(
+      "Recognizes a corpus of recorded commands with the game's speech "
+      "models, and reports each command's accuracy and latency.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::ifstream corpus(FLAGS_corpus);
+  if (!corpus) {
+    std::cerr << "Couldn't open the corpus " << FLAGS_corpus << std::endl;
+    return 1;
+  }
+  const std::vector<CorpusEntry> entries = screamy_ball::ParseCorpus(corpus);
+  if (entries.empty()) {
+    std::cerr << FLAGS_corpus << " has no recordings" << std::endl;
+    return 1;
+  }
+  const size_t slash = FLAGS_corpus.find_last_of('/');
+  const std::string directory = slash == std::string::npos
+      ? "" : FLAGS_corpus.substr(0, slash + 1);
+
+  const auto start = Clock::now();
+  const std::clock_t cpu_start = std::clock();
+  std::vector<Result> results;
+  try {
+    results = RecognizeAll(entries, directory, DecoderArgs());
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+  const double wall_secs = std::chrono::duration<double>(
+      Clock::now() - start).count();
+  // the CPU time of every thread, including loading the models
+  const double cpu_secs = static_cast<double>(std::clock() - cpu_start)
+      / CLOCKS_PER_SEC;
+
+  double audio_secs = 0;
+  for (size_t index = 0; index < results.size(); index++) {
+    const Result& result = results[index];
+    audio_secs += result.audio_secs;
+    if (!result.error.empty()) {
+      std::cerr << entries[index].wav_path << ": " << result.error
+                << std::endl;
+    } else if (FLAGS_verbose && result.recognized != result.expected) {
+      std::cout << entries[index].wav_path << ": expected \""
+                << entries[index].transcript << "\", heard \""
+                << result.hypothesis << "\"" << std::endl;
+    }
+  }
+
+  PrintReport(results);
+  std::cout << results.size() << " recordings, " << audio_secs
+            << " seconds of audio in " << wall_secs << " seconds ("
+            << audio_secs / wall_secs << "x real time)" << std::endl;
+  std::cout << "CPU: " << cpu_secs / audio_secs
+            << " core-seconds per second of audio" << std::endl;
+  return 0;
+}
@@ -0,0 +1,129 @@
+// Copyright (c) 2020 Ishita Rao. All rights reserved.
+
+#include <screamy-ball/voice_control.h>
+#include <screamy-ball/wav.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using screamy_ball::VoiceAnalyzer;
+using screamy_ball::VoiceCommand;
+using screamy_ball::VoiceEvent;
+using screamy_ball::WavData;
+
+DEFINE_string(wav, "", "the recording to analyze, as a 16-bit or float WAV "
+                       "file");
+DEFINE_uint32(block_ms, 10, "the length of each block of samples, as the "
+                            "microphone would deliver them");
+DEFINE_uint32(repeat, 20, "the number of times the recording is analyzed "
+                          "for the timings");
+
+namespace screamyball_voice_analyzer {
+
+/**
+ * Gets the name of a command, as it's printed.
+ * @param command the command.
+ * @return its name.
+ */
+std::string CommandName(VoiceCommand command) {
+  switch (command) {
+    case VoiceCommand::kJump:
+      return "jump";
+    case VoiceCommand::kDuck:
+      return "duck";
+    case VoiceCommand::kRelease:
+      return "release";
+    default:
+      return "none";
+  }
+}
+
+/**
+ * Analyzes the recording once, block by block.
+ * @param samples the recording's mono samples.
+ * @param sample_rate the recording's sample rate.
+ * @param block the number of samples in each block.
+ * @param print whether to print the commands as they're found.
+ * @param max_secs is set to the longest time a block took.
+ * @return how long the whole recording took, in seconds.
+ */
+double Analyze(const std::vector<float>& samples, unsigned sample_rate,
+               size_t block, bool print, double* max_secs) {
+  using Clock = std::chrono::steady_clock;
+  VoiceAnalyzer analyzer(sample_rate);
+  double total_secs = 0;
+
+  for (size_t start = 0; start + block <= samples.size(); start += block) {
+    const auto block_start = Clock::now();
+    const VoiceEvent event = analyzer.Process(&samples[start], block);
+    const double secs = std::chrono::duration<double>(
+        Clock::now() - block_start).count();
+    total_secs += secs;
+    *max_secs = std::max(*max_secs, secs);
+
+    if (print && event.command != VoiceCommand::kNone) {
+      std::cout << static_cast<double>(start + block) / sample_rate << "s: "
+                << CommandName(event.command);
+      if (event.command == VoiceCommand::kJump) {
+        std::cout << " at " << event.strength << "%";
+      }
+      std::cout << " (" << analyzer.LevelDb() << " dB, "
+                << analyzer.PitchHz() << " Hz)" << std::endl;
+    }
+  }
+  return total_secs;
+}
+
+}  // namespace screamyball_voice_analyzer
+
+int main(int argc, char** argv) {
+  using namespace screamyball_voice_analyzer;
+
+  gflags::SetUsageMessage(
+      "Prints the voice commands in a recording, and how long finding them "
+      "takes for each block of samples.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::ifstream file(FLAGS_wav, std::ios::binary);
+  if (!file) {
+    std::cerr << "Couldn't open " << FLAGS_wav << std::endl;
+    return 1;
+  }
+  WavData wav;
+  try {
+    wav = screamy_ball::ReadWav(file);
+  } catch (const std::invalid_argument& error) {
+    std::cerr << FLAGS_wav << ": " << error.what() << std::endl;
+    return 1;
+  }
+
+  const std::vector<float> samples = screamy_ball::MixToMono(wav);
+  const size_t block = std::max<size_t>(
+      1, wav.sample_rate * FLAGS_block_ms / 1000);
+  const size_t blocks = samples.size() / block;
+  if (blocks == 0) {
+    std::cerr << FLAGS_wav << " is shorter than a block" << std::endl;
+    return 1;
+  }
+
+  double max_secs = 0;
+  double total_secs = Analyze(samples, wav.sample_rate, block, true,
+                              &max_secs);
+  for (unsigned run = 1; run < FLAGS_repeat; run++) {
+    total_secs += Analyze(samples, wav.sample_rate, block, false, &max_secs);
+  }
+
+  const double mean_us = total_secs * 1e6
+      / static_cast<double>(blocks * std::max(1u, FLAGS_repeat));
+  std::cout << blocks << " blocks of " << FLAGS_block_ms << "ms: "
+            << mean_us << "us mean, " << max_secs * 1e6 << "us max, "
+            << 100 * mean_us / (FLAGS_block_ms * 1000.0)
+            << "% of the block's time" << std::endl;
+  return 0;
+}